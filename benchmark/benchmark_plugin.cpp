@@ -0,0 +1,41 @@
+/**
+ *
+ * @copyright Copyright (c) 2021, Southwest Research Institute
+ *
+ * @par License
+ * Software License Agreement (Apache License)
+ * @par
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * @par
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "benchmark_plugin.h"
+
+// This file is compiled once per benchmark plugin library, with BENCHMARK_PLUGIN_INDEX defined to the library index
+namespace boost_plugin_loader
+{
+class BOOST_PP_CAT(BenchmarkPluginImpl, BENCHMARK_PLUGIN_INDEX) : public BenchmarkPlugin
+{
+public:
+  int run(int x) const override
+  {
+    int result = BENCHMARK_PLUGIN_INDEX;
+#define BENCHMARK_CALL_SYMBOL(z, N, GROUP) result += BENCHMARK_SYMBOL_NAME(GROUP, N)(x);
+#define BENCHMARK_CALL_SYMBOL_GROUP(z, GROUP, _) BOOST_PP_REPEAT_##z(256, BENCHMARK_CALL_SYMBOL, GROUP)
+    BOOST_PP_REPEAT(BENCHMARK_SYMBOL_GROUPS, BENCHMARK_CALL_SYMBOL_GROUP, ~)
+    return result;
+  }
+};
+
+}  // namespace boost_plugin_loader
+
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+EXPORT_BENCHMARK_PLUGIN(boost_plugin_loader::BOOST_PP_CAT(BenchmarkPluginImpl, BENCHMARK_PLUGIN_INDEX),
+                        BOOST_PP_CAT(plugin_, BENCHMARK_PLUGIN_INDEX))
@@ -0,0 +1,62 @@
+/**
+ *
+ * @copyright Copyright (c) 2021, Southwest Research Institute
+ *
+ * @par License
+ * Software License Agreement (Apache License)
+ * @par
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * @par
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef BOOST_PLUGIN_LOADER_BENCHMARK_PLUGIN_H
+#define BOOST_PLUGIN_LOADER_BENCHMARK_PLUGIN_H
+
+// STD
+#include <string>
+#include <vector>
+
+// Benchmark
+#include "benchmark_symbols.h"
+
+namespace boost_plugin_loader
+{
+/** @brief Plugin interface used by the benchmarks */
+class BenchmarkPlugin
+{
+public:
+  virtual ~BenchmarkPlugin() = default;
+
+  /** @brief Call every benchmark symbol, forcing all of the plugin's lazy bindings to be resolved */
+  virtual int run(int x) const = 0;
+
+  static std::string getSection()
+  {
+    return "bench";
+  }
+};
+
+/** @brief The names of the benchmark plugin libraries, which each export one plugin named `plugin_<index>` */
+inline std::vector<std::string> getBenchmarkLibraryNames(int count)
+{
+  std::vector<std::string> names;
+  names.reserve(static_cast<std::size_t>(count));
+  for (int i = 0; i < count; ++i)
+    names.push_back(BENCHMARK_PLUGIN_PREFIX + std::to_string(i));
+  return names;
+}
+
+}  // namespace boost_plugin_loader
+
+#include <boost_plugin_loader/macros.h>
+#define EXPORT_BENCHMARK_PLUGIN(DERIVED_CLASS, ALIAS)                                                                  \
+  EXPORT_CLASS_SECTIONED_WITH_BASE(DERIVED_CLASS, boost_plugin_loader::BenchmarkPlugin, ALIAS, bench)
+
+#endif  // BOOST_PLUGIN_LOADER_BENCHMARK_PLUGIN_H
@@ -0,0 +1,33 @@
+/**
+ *
+ * @copyright Copyright (c) 2021, Southwest Research Institute
+ *
+ * @par License
+ * Software License Agreement (Apache License)
+ * @par
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * @par
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "benchmark_symbols.h"
+
+// Boost
+#include <boost/config.hpp>
+
+#define BENCHMARK_DEFINE_SYMBOL(z, N, GROUP)                                                                           \
+  BOOST_SYMBOL_EXPORT int BENCHMARK_SYMBOL_NAME(GROUP, N)(int x)                                                       \
+  {                                                                                                                    \
+    return x + (N);                                                                                                    \
+  }
+#define BENCHMARK_DEFINE_SYMBOL_GROUP(z, GROUP, _) BOOST_PP_REPEAT_##z(256, BENCHMARK_DEFINE_SYMBOL, GROUP)
+
+extern "C" {
+BOOST_PP_REPEAT(BENCHMARK_SYMBOL_GROUPS, BENCHMARK_DEFINE_SYMBOL_GROUP, ~)
+}
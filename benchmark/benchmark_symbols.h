@@ -0,0 +1,37 @@
+/**
+ *
+ * @copyright Copyright (c) 2021, Southwest Research Institute
+ *
+ * @par License
+ * Software License Agreement (Apache License)
+ * @par
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * @par
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef BOOST_PLUGIN_LOADER_BENCHMARK_SYMBOLS_H
+#define BOOST_PLUGIN_LOADER_BENCHMARK_SYMBOLS_H
+
+// Boost
+#include <boost/preprocessor/cat.hpp>
+#include <boost/preprocessor/repetition/repeat.hpp>
+
+// The benchmark symbols library exports BENCHMARK_SYMBOL_GROUPS * 256 functions which every benchmark plugin calls, so
+// that each plugin library carries a large number of relocations which must be bound by the dynamic loader
+#define BENCHMARK_SYMBOL_GROUPS 8
+#define BENCHMARK_SYMBOL_NAME(GROUP, N) BOOST_PP_CAT(benchmark_symbol_, BOOST_PP_CAT(GROUP, BOOST_PP_CAT(_, N)))
+#define BENCHMARK_DECLARE_SYMBOL(z, N, GROUP) int BENCHMARK_SYMBOL_NAME(GROUP, N)(int);
+#define BENCHMARK_DECLARE_SYMBOL_GROUP(z, GROUP, _) BOOST_PP_REPEAT_##z(256, BENCHMARK_DECLARE_SYMBOL, GROUP)
+
+extern "C" {
+BOOST_PP_REPEAT(BENCHMARK_SYMBOL_GROUPS, BENCHMARK_DECLARE_SYMBOL_GROUP, ~)
+}
+
+#endif  // BOOST_PLUGIN_LOADER_BENCHMARK_SYMBOLS_H
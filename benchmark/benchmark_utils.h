@@ -0,0 +1,102 @@
+/**
+ *
+ * @copyright Copyright (c) 2021, Southwest Research Institute
+ *
+ * @par License
+ * Software License Agreement (Apache License)
+ * @par
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * @par
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef BOOST_PLUGIN_LOADER_BENCHMARK_UTILS_H
+#define BOOST_PLUGIN_LOADER_BENCHMARK_UTILS_H
+
+// STD
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <string>
+#include <vector>
+
+namespace boost_plugin_loader
+{
+using BenchmarkClock = std::chrono::steady_clock;
+
+/** @brief Convert a duration to fractional milliseconds */
+inline double toMilliseconds(BenchmarkClock::duration duration)
+{
+  return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+/** @brief Summary statistics of a set of samples */
+struct BenchmarkStatistics
+{
+  std::size_t count{ 0 };
+  double min{ 0 };
+  double mean{ 0 };
+  double p50{ 0 };
+  double p99{ 0 };
+  double max{ 0 };
+};
+
+/** @brief Compute summary statistics of a set of samples */
+inline BenchmarkStatistics computeStatistics(std::vector<double> samples)
+{
+  BenchmarkStatistics stats;
+  if (samples.empty())
+    return stats;
+
+  std::sort(samples.begin(), samples.end());
+  const auto percentile = [&samples](double p) {
+    const auto index = static_cast<std::size_t>(p * static_cast<double>(samples.size() - 1) + 0.5);
+    return samples[std::min(index, samples.size() - 1)];
+  };
+
+  stats.count = samples.size();
+  stats.min = samples.front();
+  stats.max = samples.back();
+  stats.mean = std::accumulate(samples.begin(), samples.end(), 0.0) / static_cast<double>(samples.size());
+  stats.p50 = percentile(0.50);
+  stats.p99 = percentile(0.99);
+  return stats;
+}
+
+/** @brief Print a header for rows printed with printStatistics */
+inline void printStatisticsHeader(const std::string& label, const std::string& unit)
+{
+  std::cout << std::left << std::setw(44) << label << std::right << std::setw(8) << "runs" << std::setw(12)
+            << ("min " + unit) << std::setw(12) << ("mean " + unit) << std::setw(12) << ("p50 " + unit)
+            << std::setw(12) << ("p99 " + unit) << std::setw(12) << ("max " + unit) << "\n";
+}
+
+/** @brief Print a row of summary statistics */
+inline void printStatistics(const std::string& label, const BenchmarkStatistics& stats)
+{
+  std::cout << std::left << std::setw(44) << label << std::right << std::setw(8) << stats.count << std::fixed
+            << std::setprecision(3) << std::setw(12) << stats.min << std::setw(12) << stats.mean << std::setw(12)
+            << stats.p50 << std::setw(12) << stats.p99 << std::setw(12) << stats.max << "\n";
+}
+
+/** @brief Parse an integer command line argument, returning the default if it is absent */
+inline int getIntArgument(int argc, char** argv, int index, int default_value)
+{
+  if (argc <= index)
+    return default_value;
+
+  return std::atoi(argv[index]);  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+}
+
+}  // namespace boost_plugin_loader
+
+#endif  // BOOST_PLUGIN_LOADER_BENCHMARK_UTILS_H
@@ -0,0 +1,170 @@
+/**
+ *
+ * @copyright Copyright (c) 2021, Southwest Research Institute
+ *
+ * @par License
+ * Software License Agreement (Apache License)
+ * @par
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * @par
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "benchmark_plugin.h"
+#include "benchmark_utils.h"
+
+// STD
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Boost Plugin Loader
+#include <boost_plugin_loader/plugin_loader.h>
+#include <boost_plugin_loader/plugin_loader.hpp>  // NOLINT(misc-include-cleaner)
+
+using boost_plugin_loader::BenchmarkClock;
+using boost_plugin_loader::BenchmarkPlugin;
+using boost_plugin_loader::PluginLoader;
+
+namespace
+{
+/** @brief The results of running a number of threads against one plugin loader */
+struct RunResult
+{
+  /** @brief The latency of each operation in microseconds */
+  std::vector<double> latencies;
+  /** @brief The operations completed per second by all threads */
+  double throughput{ 0 };
+  boost_plugin_loader::LockWaitStatistics lock_wait;
+};
+
+/**
+ * @brief Run a mix of operations from a number of threads against one plugin loader
+ * @details Every eighth operation lists the available plugins, three in eight check if a plugin is available and the
+ * rest create a plugin instance. The threads start on different plugins.
+ */
+RunResult runThreads(const PluginLoader& loader, const std::vector<std::string>& plugin_names, int thread_count,
+                     int operations)
+{
+  std::vector<std::vector<double>> thread_latencies(static_cast<std::size_t>(thread_count));
+  std::atomic<int> ready{ 0 };
+  std::atomic<bool> go{ false };
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < thread_count; ++t)
+  {
+    threads.emplace_back([&, t]() {
+      std::vector<double>& latencies = thread_latencies[static_cast<std::size_t>(t)];
+      latencies.reserve(static_cast<std::size_t>(operations));
+
+      ready.fetch_add(1);
+      while (!go.load())
+        std::this_thread::yield();
+
+      for (int i = 0; i < operations; ++i)
+      {
+        const std::string& plugin_name = plugin_names[static_cast<std::size_t>(t + i) % plugin_names.size()];
+        const auto start = BenchmarkClock::now();
+        switch (i % 8)
+        {
+          case 0:
+            loader.getAvailablePlugins<BenchmarkPlugin>();
+            break;
+          case 1:
+          case 2:
+          case 3:
+            loader.isPluginAvailable(plugin_name);
+            break;
+          default:
+            loader.createInstance<BenchmarkPlugin>(plugin_name);
+            break;
+        }
+        latencies.push_back(std::chrono::duration<double, std::micro>(BenchmarkClock::now() - start).count());
+      }
+    });
+  }
+
+  while (ready.load() < thread_count)
+    std::this_thread::yield();
+
+  const auto start = BenchmarkClock::now();
+  go.store(true);
+  for (std::thread& thread : threads)
+    thread.join();
+  const double elapsed_s = std::chrono::duration<double>(BenchmarkClock::now() - start).count();
+
+  RunResult result;
+  for (const std::vector<double>& latencies : thread_latencies)
+    result.latencies.insert(result.latencies.end(), latencies.begin(), latencies.end());
+
+  result.throughput = static_cast<double>(result.latencies.size()) / elapsed_s;
+  result.lock_wait = loader.getLockWaitStatistics();
+  return result;
+}
+}  // namespace
+
+/**
+ * @brief Measures how one plugin loader shared by an increasing number of threads behaves under a mix of operations
+ * @details Each thread runs a mix of createInstance, isPluginAvailable and getAvailablePlugins calls. Cold runs start
+ * with no libraries loaded, so the first calls load them while other threads wait, and warm runs start with all
+ * libraries loaded. For each run the latencies of all operations (in microseconds), the throughput and the time spent
+ * waiting for the locks of the plugin loader are reported. Build with ENABLE_THREAD_SANITIZER to check the concurrent
+ * use for data races.
+ *
+ * Usage: boost_plugin_loader_contention_benchmark [operations per thread] [max threads] [library count]
+ */
+int main(int argc, char** argv)
+{
+  const int operations = boost_plugin_loader::getIntArgument(argc, argv, 1, 2000);
+  const int max_threads = boost_plugin_loader::getIntArgument(argc, argv, 2, 16);
+  const int library_count = boost_plugin_loader::getIntArgument(argc, argv, 3, BENCHMARK_PLUGIN_COUNT);
+
+  std::vector<std::string> plugin_names;
+  for (int i = 0; i < library_count; ++i)
+    plugin_names.push_back("plugin_" + std::to_string(i));
+
+  std::cout << "Mixed operations over " << library_count << " plugin libraries from threads sharing a plugin loader\n";
+  for (const bool warm : { false, true })
+  {
+    std::vector<std::string> labels;
+    std::vector<RunResult> results;
+
+    std::cout << "\n";
+    boost_plugin_loader::printStatisticsHeader(warm ? "warm cache" : "cold cache", "us");
+    for (int thread_count = 1; thread_count <= max_threads; thread_count *= 2)
+    {
+      PluginLoader loader;
+      loader.search_system_folders = false;
+      loader.search_paths.emplace_back(PLUGIN_DIR);
+      loader.search_libraries = boost_plugin_loader::getBenchmarkLibraryNames(library_count);
+      if (warm)
+        loader.getAvailablePlugins<BenchmarkPlugin>();
+
+      labels.push_back(std::to_string(thread_count) + " threads");
+      results.push_back(runThreads(loader, plugin_names, thread_count, operations));
+      boost_plugin_loader::printStatistics(labels.back(),
+                                           boost_plugin_loader::computeStatistics(results.back().latencies));
+    }
+
+    std::cout << std::left << std::setw(44) << "" << std::right << std::setw(16) << "ops/s" << std::setw(16)
+              << "contended locks" << std::setw(16) << "lock wait ms" << "\n";
+    for (std::size_t i = 0; i < results.size(); ++i)
+    {
+      std::cout << std::left << std::setw(44) << labels[i] << std::right << std::fixed << std::setprecision(0)
+                << std::setw(16) << results[i].throughput << std::setw(16)
+                << results[i].lock_wait.contended_acquisitions << std::setprecision(3) << std::setw(16)
+                << boost_plugin_loader::toMilliseconds(results[i].lock_wait.wait_time) << "\n";
+    }
+  }
+
+  return 0;
+}
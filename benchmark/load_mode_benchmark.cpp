@@ -0,0 +1,87 @@
+/**
+ *
+ * @copyright Copyright (c) 2021, Southwest Research Institute
+ *
+ * @par License
+ * Software License Agreement (Apache License)
+ * @par
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * @par
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "benchmark_plugin.h"
+#include "benchmark_utils.h"
+
+// STD
+#include <string>
+#include <utility>
+#include <vector>
+
+// Boost
+#include <boost/dll/shared_library_load_mode.hpp>
+
+// Boost Plugin Loader
+#include <boost_plugin_loader/plugin_loader.h>
+#include <boost_plugin_loader/plugin_loader.hpp>  // NOLINT(misc-include-cleaner)
+#include <boost_plugin_loader/utils.h>
+
+using boost_plugin_loader::BenchmarkClock;
+using boost_plugin_loader::PluginLoader;
+namespace load_mode = boost::dll::load_mode;
+
+/**
+ * @brief Measures the time taken to load all benchmark plugin libraries with different load modes
+ * @details Each run constructs a new plugin loader, loads every library and destroys the loader again, which unloads
+ * the libraries unless they were loaded with RTLD_NODELETE. The RTLD_NODELETE mode is measured last because libraries
+ * loaded with it stay mapped for the remainder of the process, so all of its runs after the first only pay for the
+ * reference count increment.
+ *
+ * Usage: boost_plugin_loader_load_mode_benchmark [runs] [library count]
+ */
+int main(int argc, char** argv)
+{
+  const int runs = boost_plugin_loader::getIntArgument(argc, argv, 1, 50);
+  const int library_count = boost_plugin_loader::getIntArgument(argc, argv, 2, BENCHMARK_PLUGIN_COUNT);
+
+  const std::vector<std::pair<std::string, load_mode::type>> modes = {
+    { "lazy (default)", load_mode::default_mode },
+    { "now", load_mode::rtld_now },
+    { "now | global", load_mode::rtld_now | load_mode::rtld_global },
+    { "lazy | nodelete", boost_plugin_loader::load_mode::rtld_nodelete },
+  };
+
+  std::cout << "Loading " << library_count << " plugin libraries per run\n";
+  boost_plugin_loader::printStatisticsHeader("load mode", "ms");
+  for (const auto& mode : modes)
+  {
+    std::vector<double> samples;
+    samples.reserve(static_cast<std::size_t>(runs));
+    for (int i = 0; i < runs; ++i)
+    {
+      PluginLoader loader;
+      loader.search_system_folders = false;
+      loader.search_paths.emplace_back(PLUGIN_DIR);
+      loader.search_libraries = boost_plugin_loader::getBenchmarkLibraryNames(library_count);
+      loader.load_mode = mode.second;
+
+      const auto start = BenchmarkClock::now();
+      if (!loader.isPluginAvailable("plugin_0"))
+      {
+        std::cerr << "Failed to load the benchmark plugin libraries from '" << PLUGIN_DIR << "'\n";
+        return 1;
+      }
+      samples.push_back(boost_plugin_loader::toMilliseconds(BenchmarkClock::now() - start));
+    }
+
+    boost_plugin_loader::printStatistics(mode.first, boost_plugin_loader::computeStatistics(samples));
+  }
+
+  return 0;
+}
@@ -0,0 +1,173 @@
+/**
+ *
+ * @copyright Copyright (c) 2021, Southwest Research Institute
+ *
+ * @par License
+ * Software License Agreement (Apache License)
+ * @par
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * @par
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "benchmark_plugin.h"
+#include "benchmark_utils.h"
+
+// STD
+#include <array>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Boost
+#include <boost/dll/runtime_symbol_info.hpp>
+#include <boost/filesystem/path.hpp>
+
+// Boost Plugin Loader
+#include <boost_plugin_loader/plugin_loader.h>
+#include <boost_plugin_loader/plugin_loader.hpp>  // NOLINT(misc-include-cleaner)
+#include <boost_plugin_loader/utils.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using boost_plugin_loader::BenchmarkClock;
+using boost_plugin_loader::BenchmarkPlugin;
+using boost_plugin_loader::PluginLoader;
+
+namespace
+{
+/** @brief Measure the time to create the first plugin instance in this (fresh) process and print it in milliseconds */
+int runChild(bool warm_page_cache, int library_count)
+{
+  const auto start = BenchmarkClock::now();
+
+  PluginLoader loader;
+  loader.search_system_folders = false;
+  loader.search_paths.emplace_back(PLUGIN_DIR);
+  loader.search_libraries = boost_plugin_loader::getBenchmarkLibraryNames(library_count);
+  loader.warm_page_cache = warm_page_cache;
+
+  const std::shared_ptr<BenchmarkPlugin> plugin = loader.createInstance<BenchmarkPlugin>("plugin_0");
+  const double elapsed = boost_plugin_loader::toMilliseconds(BenchmarkClock::now() - start);
+
+  std::printf("%f\n", elapsed);  // NOLINT(cppcoreguidelines-pro-type-vararg)
+  return plugin != nullptr ? 0 : 1;
+}
+
+#ifndef _WIN32
+/** @brief Drop the plugin library files from the page cache */
+void evictFromPageCache(const std::vector<std::string>& files)
+{
+  for (const std::string& file : files)
+  {
+    const int fd = ::open(file.c_str(), O_RDONLY | O_CLOEXEC);  // NOLINT(cppcoreguidelines-pro-type-vararg)
+    if (fd < 0)
+      continue;
+
+    ::fdatasync(fd);
+    ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    ::close(fd);
+  }
+}
+
+/** @brief Run this executable as a child process and return the time to first instance it reports */
+double spawnChild(const std::string& command)
+{
+  FILE* pipe = ::popen(command.c_str(), "r");
+  if (pipe == nullptr)
+    return -1;
+
+  std::array<char, 64> buffer{};
+  const bool ok = (std::fgets(buffer.data(), buffer.size(), pipe) != nullptr);
+  const int status = ::pclose(pipe);
+  if (!ok || status != 0)
+    return -1;
+
+  return std::atof(buffer.data());
+}
+#endif
+}  // namespace
+
+/**
+ * @brief Measures the time to the first plugin instance in a fresh process with cold and warm page caches
+ * @details Each run spawns a new process. For the cold runs the benchmark plugin libraries are first dropped from the
+ * page cache with posix_fadvise(POSIX_FADV_DONTNEED), which does not require elevated privileges, so that loading them
+ * has to read them from disk again. The cold runs are measured with and without PluginLoader::warm_page_cache.
+ *
+ * Usage: boost_plugin_loader_page_cache_benchmark [runs] [library count]
+ */
+int main(int argc, char** argv)
+{
+  if (argc == 4 && std::string(argv[1]) == "--child")  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    return runChild(std::atoi(argv[2]) != 0, std::atoi(argv[3]));  // NOLINT
+
+#ifdef _WIN32
+  std::cout << "The page cache benchmark is not supported on Windows\n";
+  return 0;
+#else
+  const int runs = boost_plugin_loader::getIntArgument(argc, argv, 1, 20);
+  const int library_count = boost_plugin_loader::getIntArgument(argc, argv, 2, BENCHMARK_PLUGIN_COUNT);
+
+  std::vector<std::string> files;
+  for (const std::string& name : boost_plugin_loader::getBenchmarkLibraryNames(library_count))
+    files.push_back(boost::dll::shared_library::decorate(boost::filesystem::path(PLUGIN_DIR) / name).string());
+
+  const std::string self = boost::dll::program_location().string();
+
+  struct Variant
+  {
+    std::string label;
+    bool cold;
+    bool warm_page_cache;
+  };
+  const std::vector<Variant> variants = {
+    { "cold page cache", true, false },
+    { "cold page cache + warming", true, true },
+    { "hot page cache", false, false },
+  };
+
+  std::cout << "Time to first instance over " << library_count << " plugin libraries in a fresh process\n";
+  boost_plugin_loader::printStatisticsHeader("page cache", "ms");
+  for (const Variant& variant : variants)
+  {
+    std::vector<double> child_samples;
+    std::vector<double> process_samples;
+    const std::string command =
+        "\"" + self + "\" --child " + (variant.warm_page_cache ? "1 " : "0 ") + std::to_string(library_count);
+
+    for (int i = 0; i < runs; ++i)
+    {
+      if (variant.cold)
+        evictFromPageCache(files);
+
+      const auto start = BenchmarkClock::now();
+      const double child_ms = spawnChild(command);
+      const double process_ms = boost_plugin_loader::toMilliseconds(BenchmarkClock::now() - start);
+      if (child_ms < 0)
+      {
+        std::cerr << "Child process failed: " << command << "\n";
+        return 1;
+      }
+
+      child_samples.push_back(child_ms);
+      process_samples.push_back(process_ms);
+    }
+
+    boost_plugin_loader::printStatistics(variant.label + " (first instance)",
+                                         boost_plugin_loader::computeStatistics(child_samples));
+    boost_plugin_loader::printStatistics(variant.label + " (whole process)",
+                                         boost_plugin_loader::computeStatistics(process_samples));
+  }
+
+  return 0;
+#endif
+}
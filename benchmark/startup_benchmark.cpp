@@ -0,0 +1,264 @@
+/**
+ *
+ * @copyright Copyright (c) 2021, Southwest Research Institute
+ *
+ * @par License
+ * Software License Agreement (Apache License)
+ * @par
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * @par
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "benchmark_plugin.h"
+#include "benchmark_utils.h"
+
+// STD
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Boost
+#include <boost/dll/runtime_symbol_info.hpp>
+#include <boost/filesystem/operations.hpp>
+#include <boost/filesystem/path.hpp>
+#include <boost/system/error_code.hpp>
+
+// Boost Plugin Loader
+#include <boost_plugin_loader/plugin_loader.h>
+#include <boost_plugin_loader/plugin_loader.hpp>  // NOLINT(misc-include-cleaner)
+#include <boost_plugin_loader/plugin_loader_listener.h>
+
+#ifndef _WIN32
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char** environ;  // NOLINT(readability-redundant-declaration)
+#endif
+
+using boost_plugin_loader::BenchmarkClock;
+using boost_plugin_loader::BenchmarkPlugin;
+using boost_plugin_loader::PluginLoader;
+
+namespace
+{
+/** @brief The phases of the startup of a child process, in milliseconds */
+struct StartupSample
+{
+  /** @brief From spawning the process to entering main */
+  double process_start{ 0 };
+  /** @brief Loading the plugin libraries (dlopen), up to the first instance */
+  double library_load{ 0 };
+  /** @brief The rest of the time to the first instance, mostly scanning the sections and symbols of the libraries */
+  double elf_scan{ 0 };
+  /** @brief The call to getAvailablePlugins, if it was made */
+  double available_plugins{ 0 };
+  /** @brief From entering main to the first plugin instance */
+  double first_instance{ 0 };
+};
+
+/** @brief Sums the time spent loading libraries */
+class LoadTimeListener : public boost_plugin_loader::PluginLoaderListener
+{
+public:
+  void onLibraryLoadEnd(const boost_plugin_loader::PluginLoaderEvent& event) override { load_time += event.duration; }
+
+  BenchmarkClock::duration load_time{ 0 };
+};
+
+/** @brief The current time of the monotonic clock, which is shared by all processes, in nanoseconds */
+long long nowNanoseconds()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(BenchmarkClock::now().time_since_epoch()).count();
+}
+
+/** @brief The manifest shared by the child processes which use one */
+std::string getManifestFile()
+{
+  return (boost::filesystem::temp_directory_path() / "boost_plugin_loader_startup_benchmark.manifest").string();
+}
+
+/**
+ * @brief Measure the startup of this (fresh) process and print it as a StartupSample
+ * @param mode "create" to create the first instance directly, "list" to list the available plugins first, or
+ * "manifest" to also load the shared manifest before listing them
+ */
+int runChild(const std::string& mode, int library_count, long long spawn_time)
+{
+  const auto start = BenchmarkClock::now();
+  StartupSample sample;
+  sample.process_start = static_cast<double>(nowNanoseconds() - spawn_time) / 1e6;
+
+  auto listener = std::make_shared<LoadTimeListener>();
+  PluginLoader loader;
+  loader.search_system_folders = false;
+  loader.search_paths.emplace_back(PLUGIN_DIR);
+  loader.search_libraries = boost_plugin_loader::getBenchmarkLibraryNames(library_count);
+  loader.listeners.push_back(listener);
+
+  if (mode == "manifest")
+    loader.loadManifest(getManifestFile());
+
+  if (mode != "create")
+  {
+    const auto available_start = BenchmarkClock::now();
+    if (loader.getAvailablePlugins<BenchmarkPlugin>().empty())
+      return 1;
+
+    sample.available_plugins = boost_plugin_loader::toMilliseconds(BenchmarkClock::now() - available_start);
+  }
+
+  const std::shared_ptr<BenchmarkPlugin> plugin = loader.createInstance<BenchmarkPlugin>("plugin_0");
+  sample.first_instance = boost_plugin_loader::toMilliseconds(BenchmarkClock::now() - start);
+  sample.library_load = boost_plugin_loader::toMilliseconds(listener->load_time);
+  sample.elf_scan = sample.first_instance - sample.library_load;
+
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg)
+  std::printf("%f %f %f %f %f\n", sample.process_start, sample.library_load, sample.elf_scan, sample.available_plugins,
+              sample.first_instance);
+  return plugin != nullptr ? 0 : 1;
+}
+
+#ifndef _WIN32
+/** @brief Spawn this executable as a child process and read the StartupSample it reports */
+bool spawnChild(const std::vector<std::string>& arguments, StartupSample& sample)
+{
+  std::array<int, 2> fds{};
+  if (::pipe(fds.data()) != 0)
+    return false;
+
+  posix_spawn_file_actions_t actions;
+  ::posix_spawn_file_actions_init(&actions);
+  ::posix_spawn_file_actions_adddup2(&actions, fds[1], STDOUT_FILENO);
+  ::posix_spawn_file_actions_addclose(&actions, fds[0]);
+  ::posix_spawn_file_actions_addclose(&actions, fds[1]);
+
+  // The spawn time is passed last, taken as late as possible
+  std::vector<std::string> args = arguments;
+  args.push_back(std::to_string(nowNanoseconds()));
+  std::vector<char*> argv;
+  for (std::string& arg : args)
+    argv.push_back(arg.data());
+  argv.push_back(nullptr);
+
+  pid_t pid{ 0 };
+  const int error = ::posix_spawn(&pid, argv.front(), &actions, nullptr, argv.data(), environ);
+  ::posix_spawn_file_actions_destroy(&actions);
+  ::close(fds[1]);
+  if (error != 0)
+  {
+    ::close(fds[0]);
+    return false;
+  }
+
+  std::string output;
+  std::array<char, 256> buffer{};
+  for (ssize_t length = 0; (length = ::read(fds[0], buffer.data(), buffer.size())) > 0;)
+    output.append(buffer.data(), static_cast<std::size_t>(length));
+  ::close(fds[0]);
+
+  int status{ 0 };
+  if (::waitpid(pid, &status, 0) != pid || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+    return false;
+
+  std::istringstream stream(output);
+  stream >> sample.process_start >> sample.library_load >> sample.elf_scan >> sample.available_plugins >>
+      sample.first_instance;
+  return !stream.fail();
+}
+#endif
+}  // namespace
+
+/**
+ * @brief Measures the startup of fresh processes which create a plugin loader and their first plugin instance
+ * @details Each run spawns this executable again as a small driver process, which creates a plugin loader for the
+ * benchmark libraries and either lists the available plugins and then creates the first instance, does the same
+ * after loading a manifest of the libraries shared by all runs (see PluginLoader::loadManifest), or creates the first
+ * instance directly. The driver reports the time from spawning it to entering main, the time spent loading the
+ * libraries, the rest of the time to the first instance (mostly scanning the ELF sections and symbols of the
+ * libraries) and the time to getAvailablePlugins. The results of all runs are aggregated.
+ *
+ * Usage: boost_plugin_loader_startup_benchmark [runs] [library count]
+ */
+int main(int argc, char** argv)
+{
+  // NOLINTBEGIN(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+  if (argc == 5 && std::string(argv[1]) == "--child")
+    return runChild(argv[2], std::atoi(argv[3]), std::atoll(argv[4]));
+  // NOLINTEND(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+
+#ifdef _WIN32
+  std::cout << "The startup benchmark is not supported on Windows\n";
+  return 0;
+#else
+  const int runs = boost_plugin_loader::getIntArgument(argc, argv, 1, 50);
+  const int library_count = boost_plugin_loader::getIntArgument(argc, argv, 2, BENCHMARK_PLUGIN_COUNT);
+  const std::string self = boost::dll::program_location().string();
+
+  // The manifest is built by a first child process, so that the measured ones only map it
+  boost::system::error_code ec;
+  boost::filesystem::remove(getManifestFile(), ec);
+  StartupSample manifest_sample;
+  if (!spawnChild({ self, "--child", "manifest", std::to_string(library_count) }, manifest_sample))
+  {
+    std::cerr << "Child process failed: " << self << "\n";
+    return 1;
+  }
+
+  std::cout << "Startup of fresh processes with " << library_count << " plugin libraries\n";
+  boost_plugin_loader::printStatisticsHeader("phase", "ms");
+  const std::vector<std::string> modes = { "list", "manifest", "create" };
+  for (const std::string& mode : modes)
+  {
+    std::vector<StartupSample> samples;
+    std::vector<double> process_samples;
+    const std::vector<std::string> arguments = { self, "--child", mode, std::to_string(library_count) };
+    for (int i = 0; i < runs; ++i)
+    {
+      StartupSample sample;
+      const auto start = BenchmarkClock::now();
+      if (!spawnChild(arguments, sample))
+      {
+        std::cerr << "Child process failed: " << self << "\n";
+        return 1;
+      }
+
+      process_samples.push_back(boost_plugin_loader::toMilliseconds(BenchmarkClock::now() - start));
+      samples.push_back(sample);
+    }
+
+    auto print = [&samples](const std::string& label, double StartupSample::*field) {
+      std::vector<double> values;
+      for (const StartupSample& sample : samples)
+        values.push_back(sample.*field);
+      boost_plugin_loader::printStatistics(label, boost_plugin_loader::computeStatistics(values));
+    };
+
+    const bool list_plugins = (mode != "create");
+    const std::string prefix = (mode == "create") ? "create: " : (mode == "list") ? "list + create: " : "manifest: ";
+    print(prefix + "process start", &StartupSample::process_start);
+    print(prefix + "library load", &StartupSample::library_load);
+    print(prefix + "ELF scan", &StartupSample::elf_scan);
+    if (list_plugins)
+      print(prefix + "getAvailablePlugins", &StartupSample::available_plugins);
+    print(prefix + "first instance", &StartupSample::first_instance);
+    boost_plugin_loader::printStatistics(prefix + "whole process",
+                                         boost_plugin_loader::computeStatistics(process_samples));
+  }
+
+  boost::filesystem::remove(getManifestFile(), ec);
+  boost::filesystem::remove(getManifestFile() + ".lock", ec);
+  return 0;
+#endif
+}
@@ -0,0 +1,119 @@
+/**
+ *
+ * @copyright Copyright (c) 2021, Southwest Research Institute
+ *
+ * @par License
+ * Software License Agreement (Apache License)
+ * @par
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * @par
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "benchmark_plugin.h"
+#include "benchmark_utils.h"
+
+// STD
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Boost Plugin Loader
+#include <boost_plugin_loader/plugin_loader.h>
+#include <boost_plugin_loader/plugin_loader.hpp>  // NOLINT(misc-include-cleaner)
+
+using boost_plugin_loader::BenchmarkClock;
+using boost_plugin_loader::BenchmarkPlugin;
+using boost_plugin_loader::PluginLoader;
+
+namespace
+{
+/**
+ * @brief Look up plugins from a number of threads at once
+ * @return The time per lookup seen by each thread, in nanoseconds
+ */
+std::vector<double> runThreads(const PluginLoader& loader, const std::vector<std::string>& plugin_names,
+                               int thread_count, int lookups)
+{
+  std::vector<double> samples(static_cast<std::size_t>(thread_count));
+  std::atomic<int> ready{ 0 };
+  std::atomic<bool> go{ false };
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < thread_count; ++t)
+  {
+    threads.emplace_back([&, t]() {
+      // Resolve every plugin once, so that only repeated lookups are measured
+      for (const std::string& plugin_name : plugin_names)
+        loader.createInstance<BenchmarkPlugin>(plugin_name);
+
+      ready.fetch_add(1);
+      while (!go.load())
+        std::this_thread::yield();
+
+      const auto start = BenchmarkClock::now();
+      for (int i = 0; i < lookups; ++i)
+        loader.createInstance<BenchmarkPlugin>(plugin_names[static_cast<std::size_t>(i) % plugin_names.size()]);
+
+      const auto elapsed = std::chrono::duration<double, std::nano>(BenchmarkClock::now() - start).count();
+      samples[static_cast<std::size_t>(t)] = elapsed / lookups;
+    });
+  }
+
+  while (ready.load() < thread_count)
+    std::this_thread::yield();
+  go.store(true);
+
+  for (std::thread& thread : threads)
+    thread.join();
+
+  return samples;
+}
+}  // namespace
+
+/**
+ * @brief Measures how repeated plugin lookups scale with the number of threads, with and without the per-thread cache
+ * @details All threads share one plugin loader and look up the plugins of the benchmark libraries round-robin after
+ * resolving each of them once. Each sample is the time per lookup seen by one thread, in nanoseconds.
+ *
+ * Usage: boost_plugin_loader_thread_cache_benchmark [lookups per thread] [max threads] [library count]
+ */
+int main(int argc, char** argv)
+{
+  const int lookups = boost_plugin_loader::getIntArgument(argc, argv, 1, 100000);
+  const int max_threads = boost_plugin_loader::getIntArgument(argc, argv, 2, 32);
+  const int library_count = boost_plugin_loader::getIntArgument(argc, argv, 3, BENCHMARK_PLUGIN_COUNT);
+
+  std::vector<std::string> plugin_names;
+  for (int i = 0; i < library_count; ++i)
+    plugin_names.push_back("plugin_" + std::to_string(i));
+
+  std::cout << "Repeated lookups of " << library_count << " plugins from many threads sharing a plugin loader\n";
+  boost_plugin_loader::printStatisticsHeader("threads", "ns");
+  for (int thread_count = 1; thread_count <= max_threads; thread_count *= 2)
+  {
+    for (const bool thread_local_cache : { false, true })
+    {
+      PluginLoader loader;
+      loader.search_system_folders = false;
+      loader.search_paths.emplace_back(PLUGIN_DIR);
+      loader.search_libraries = boost_plugin_loader::getBenchmarkLibraryNames(library_count);
+      loader.thread_local_cache = thread_local_cache;
+
+      const std::string label =
+          std::to_string(thread_count) + (thread_local_cache ? " threads, thread-local cache" : " threads");
+      boost_plugin_loader::printStatistics(
+          label, boost_plugin_loader::computeStatistics(runThreads(loader, plugin_names, thread_count, lookups)));
+    }
+  }
+
+  return 0;
+}
@@ -21,6 +21,7 @@
 #include "shape/shape.h"
 
 // STD
+#include <map>
 #include <string>
 #include <vector>
 #include <iomanip>
@@ -39,17 +40,17 @@ void demoPrinterPlugins(const PluginLoader& loader)
 {
   std::cout << "Loading printer plugins" << std::endl;
 
-  const std::vector<std::string> printer_plugins = loader.getAvailablePlugins<Printer>();
+  // Create all printer plugins at once, rather than looking each of them up by name
+  const std::map<std::string, Printer::Ptr> printer_plugins = loader.createAllInstances<Printer>();
   assert(printer_plugins.size() == 2);
 
-  for (const std::string& plugin_name : printer_plugins)
+  for (const auto& [plugin_name, plugin] : printer_plugins)
   {
-    std::cout << "Loading plugin '" << plugin_name << "'\n";
-    const Printer::Ptr plugin = loader.createInstance<Printer>(plugin_name);
+    std::cout << "Loaded plugin '" << plugin_name << "'\n";
     assert(plugin != nullptr);
     plugin->operator()();
-    // Note: `plugin` goes out of scope here, and the library providing its definition will be unloaded
   }
+  // Note: the plugins go out of scope here, and the library providing their definitions will be unloaded
 }
 
 void demoShapePlugins(const PluginLoader& loader)
@@ -68,4 +68,5 @@ private:
 
 #include <boost_plugin_loader/macros.h>
 // NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
-#define EXPORT_SHAPE_PLUGIN(DERIVED_CLASS, ALIAS) EXPORT_CLASS_SECTIONED(DERIVED_CLASS, ALIAS, shape)
+#define EXPORT_SHAPE_PLUGIN(DERIVED_CLASS, ALIAS)                                                                      \
+  EXPORT_CLASS_SECTIONED_WITH_BASE(DERIVED_CLASS, boost_plugin_loader::ShapeFactory, ALIAS, shape)
@@ -0,0 +1,99 @@
+/**
+ *
+ * @copyright Copyright (c) 2021, Southwest Research Institute
+ *
+ * @par License
+ * Software License Agreement (Apache License)
+ * @par
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * @par
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef BOOST_PLUGIN_LOADER_CHROME_TRACE_LISTENER_H
+#define BOOST_PLUGIN_LOADER_CHROME_TRACE_LISTENER_H
+
+// STD
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Boost Plugin Loader
+#include <boost_plugin_loader/plugin_loader_listener.h>
+
+namespace boost_plugin_loader
+{
+/**
+ * @brief A plugin loader listener which records events in the Chrome trace-event JSON format
+ * @details The output can be opened with chrome://tracing or https://ui.perfetto.dev. Library loads are recorded as
+ * duration events, instance creation and load waves as complete events, and symbol resolution, evictions and failures
+ * as instant events. Each thread that emitted an event is shown as its own track.
+ *
+ *   auto trace = std::make_shared<ChromeTraceListener>();
+ *   loader.listeners.push_back(trace);
+ *   ...
+ *   trace->save("plugin_loader_trace.json");
+ */
+class ChromeTraceListener : public PluginLoaderListener
+{
+public:
+  using Ptr = std::shared_ptr<ChromeTraceListener>;
+
+  ChromeTraceListener();
+
+  void onLibraryLoadStart(const PluginLoaderEvent& event) override;
+  void onLibraryLoadEnd(const PluginLoaderEvent& event) override;
+  void onSymbolResolved(const PluginLoaderEvent& event) override;
+  void onInstanceCreated(const PluginLoaderEvent& event) override;
+  void onFailure(const PluginLoaderEvent& event) override;
+  void onLibraryEvicted(const PluginLoaderEvent& event) override;
+  void onLoadWave(const PluginLoaderEvent& event) override;
+
+  /** @brief Write the recorded events as a Chrome trace-event JSON document */
+  void write(std::ostream& os) const;
+
+  /**
+   * @brief Write the recorded events as a Chrome trace-event JSON document to a file
+   * @throws PluginLoaderException if the file cannot be written
+   */
+  void save(const std::string& file_path) const;
+
+  /** @brief The number of recorded trace events */
+  std::size_t size() const;
+
+  /** @brief Remove all recorded events */
+  void clear();
+
+private:
+  struct Record
+  {
+    char phase{ 'i' };
+    std::string name;
+    std::string category;
+    PluginLoaderEvent::Clock::time_point timestamp;
+    PluginLoaderEvent::Clock::duration duration{ PluginLoaderEvent::Clock::duration::zero() };
+    int thread{ 0 };
+    std::vector<std::pair<std::string, std::string>> args;
+  };
+
+  mutable std::mutex mutex_;
+  PluginLoaderEvent::Clock::time_point origin_;
+  std::vector<Record> records_;
+  std::unordered_map<std::thread::id, int> threads_;
+
+  void add(char phase, std::string name, std::string category, const PluginLoaderEvent& event,
+           std::vector<std::pair<std::string, std::string>> args);
+};
+
+}  // namespace boost_plugin_loader
+
+#endif  // BOOST_PLUGIN_LOADER_CHROME_TRACE_LISTENER_H
@@ -0,0 +1,122 @@
+/**
+ *
+ * @copyright Copyright (c) 2021, Southwest Research Institute
+ *
+ * @par License
+ * Software License Agreement (Apache License)
+ * @par
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * @par
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef BOOST_PLUGIN_LOADER_FROZEN_PLUGIN_TABLE_H
+#define BOOST_PLUGIN_LOADER_FROZEN_PLUGIN_TABLE_H
+
+// STD
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace boost_plugin_loader
+{
+/**
+ * @brief An immutable table of the plugins of a set of libraries, looked up by section and name with a minimal perfect
+ * hash
+ * @details The keys are hashed once, and each bucket of keys is assigned a seed which maps its keys to distinct slots,
+ * so a lookup hashes the key, reads the seed of its bucket and compares the key of a single slot. Lookups take no lock,
+ * do not allocate and take the same steps for every key. Each plugin is keyed by its section and name, and by its name
+ * alone (under the empty section) for plugins looked up without a section. A key provided by several libraries maps to
+ * the entry of the first of them in search order.
+ */
+class FrozenPluginTable
+{
+public:
+  /** @brief A plugin of a library */
+  struct Entry
+  {
+    /** @brief The section of the plugin */
+    std::string section;
+
+    /** @brief The plugin name */
+    std::string name;
+
+    /** @brief The index of the library which provides the plugin, in search order */
+    std::size_t library{ 0 };
+
+    /** @brief The plugin object in the library */
+    void* plugin{ nullptr };
+
+    /** @brief The type hash of the base class of the plugin, or zero if it is unknown (see PluginRecord::base_type) */
+    std::uint64_t base_type{ 0 };
+  };
+
+  /** @brief The entries under a section */
+  struct Range
+  {
+    const Entry* first{ nullptr };
+    const Entry* last{ nullptr };
+
+    const Entry* begin() const { return first; }
+    const Entry* end() const { return last; }
+    bool empty() const { return first == last; }
+  };
+
+  FrozenPluginTable() = default;
+
+  /**
+   * @brief Build the table
+   * @param entries The plugins of the libraries, in search order
+   * @throws PluginLoaderException if no perfect hash could be found for the keys
+   */
+  explicit FrozenPluginTable(std::vector<Entry> entries);
+
+  /**
+   * @brief Find a plugin
+   * @param section The section of the plugin, or an empty section to find the plugin under any section
+   * @param name The plugin name
+   * @return The entry of the first library in search order which provides the plugin, or nullptr if none does
+   */
+  const Entry* find(std::string_view section, std::string_view name) const noexcept;
+
+  /**
+   * @brief Find the plugins under a section
+   * @param section The section
+   * @return The entries under the section in search order, including plugins provided by several libraries
+   */
+  Range findSection(std::string_view section) const noexcept;
+
+  /** @brief The entries of all plugins, grouped by section */
+  const std::vector<Entry>& entries() const { return entries_; }
+
+private:
+  /** @brief The entries, grouped by section and otherwise in search order */
+  std::vector<Entry> entries_;
+
+  /** @brief The ranges of entries_ holding each section, ordered by section */
+  std::vector<std::pair<std::size_t, std::size_t>> sections_;
+
+  /** @brief The seed of the key hash */
+  std::uint64_t seed_{ 0 };
+
+  /** @brief The seed of each bucket, which maps the keys of the bucket to their slots */
+  std::vector<std::uint32_t> bucket_seeds_;
+
+  /** @brief The index in entries_ of the key in each slot, with NAME_KEY set for keys without a section */
+  std::vector<std::uint32_t> slots_;
+
+  static constexpr std::uint32_t NAME_KEY{ 0x80000000U };
+};
+
+}  // namespace boost_plugin_loader
+
+#endif  // BOOST_PLUGIN_LOADER_FROZEN_PLUGIN_TABLE_H
@@ -22,6 +22,13 @@
 namespace boost_plugin_loader
 {
 class PluginLoader;
+class PluginLoaderListener;
+class PluginLoadProfile;
+class ChromeTraceListener;
+class FrozenPluginTable;
+class LibraryManifest;
+class LibraryRegistry;
+class LibraryWatcher;
 }  // namespace boost_plugin_loader
 
 #endif  // BOOST_PLUGIN_LOADER_FWD_H
@@ -0,0 +1,180 @@
+/**
+ *
+ * @copyright Copyright (c) 2021, Southwest Research Institute
+ *
+ * @par License
+ * Software License Agreement (Apache License)
+ * @par
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * @par
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef BOOST_PLUGIN_LOADER_LIBRARY_MANIFEST_H
+#define BOOST_PLUGIN_LOADER_LIBRARY_MANIFEST_H
+
+// STD
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Boost Plugin Loader
+#include <boost_plugin_loader/utils.h>
+
+namespace boost_plugin_loader
+{
+/**
+ * @brief A read-only manifest of the sections and symbols of plugin libraries, shared by processes through a file
+ * @details Processes which start together with the same plugin configuration can share the work of parsing the plugin
+ * libraries: the first of them parses the libraries and publishes the manifest, and the others map the manifest and
+ * read the index of each library from it instead of parsing the library file (see PluginLoader::loadManifest).
+ *
+ * A manifest is written under a temporary name and renamed into place, and is never modified afterwards, so readers
+ * never see a partially written manifest and need no locks. Publishing a new manifest does not affect the processes
+ * which mapped the previous one. The file starts with a fixed header (a magic number, the layout version, a byte order
+ * mark, the hash of the plugin configuration it was built for and the total size), followed by a record for each
+ * library in search order: its library name, the canonical path, size and modification time of its file, then its
+ * sections, each with a flag for hidden
+ * sections and, for the others, the symbols under the section, each with the type hash of its base class (zero if it is
+ * unknown, see PluginRecord). Strings are stored with their length. Manifests with another layout version, byte order
+ * or configuration hash are ignored.
+ */
+class LibraryManifest
+{
+public:
+  using ConstPtr = std::shared_ptr<const LibraryManifest>;
+
+  /** @brief The version of the layout, which changes whenever the layout changes */
+  static constexpr std::uint32_t VERSION{ 3 };
+
+  /** @brief A library described by the manifest */
+  struct Entry
+  {
+    /** @brief The library name (as listed in search_libraries) for which the library was loaded */
+    std::string name;
+
+    /** @brief The canonical path of the library file */
+    std::string file;
+
+    /** @brief The size of the library file in bytes */
+    std::uintmax_t size{ 0 };
+
+    /** @brief The modification time of the library file (see getModificationTime) */
+    std::int64_t modified{ -1 };
+
+    /** @brief The sections and symbols of the library */
+    LibraryIndex index;
+  };
+
+  /**
+   * @brief Holds the lock under which a manifest is built, so that only one of the processes starting together does
+   * @details The lock is an exclusive lock (flock) on a lock file next to the manifest, which is held until this object
+   * is destroyed or the process exits. Constructing this object blocks until the lock is acquired. The lock is not
+   * taken on platforms without flock.
+   */
+  class BuildLock
+  {
+  public:
+    explicit BuildLock(const std::string& file_path);
+    ~BuildLock();
+    BuildLock(const BuildLock&) = delete;
+    BuildLock& operator=(const BuildLock&) = delete;
+    BuildLock(BuildLock&&) = delete;
+    BuildLock& operator=(BuildLock&&) = delete;
+
+  private:
+    int fd_{ -1 };
+  };
+
+  ~LibraryManifest();
+  LibraryManifest(const LibraryManifest&) = delete;
+  LibraryManifest& operator=(const LibraryManifest&) = delete;
+  LibraryManifest(LibraryManifest&&) = delete;
+  LibraryManifest& operator=(LibraryManifest&&) = delete;
+
+  /**
+   * @brief Map a manifest file read-only
+   * @param file_path The path of the manifest file
+   * @param configuration_hash The hash of the plugin configuration the manifest must have been built for
+   * @return The manifest, or nullptr if the file does not exist, is not a valid manifest of this layout version or was
+   * built for another configuration
+   */
+  static ConstPtr map(const std::string& file_path, std::uint64_t configuration_hash);
+
+  /**
+   * @brief Write a manifest and atomically replace the manifest file with it
+   * @param file_path The path of the manifest file
+   * @param configuration_hash The hash of the plugin configuration the manifest is built for
+   * @param entries The libraries described by the manifest
+   * @throws PluginLoaderException if the manifest cannot be written
+   */
+  static void publish(const std::string& file_path, std::uint64_t configuration_hash,
+                      const std::vector<Entry>& entries);
+
+  /**
+   * @brief Hash the values which make up a plugin configuration (FNV-1a), which is stable across processes and builds
+   * @param values The values, e.g. the library names and search paths
+   * @return The hash
+   */
+  static std::uint64_t hashConfiguration(const std::vector<std::string>& values);
+
+  /**
+   * @brief Read the index of a library from the manifest
+   * @param file The canonical path of the library file
+   * @param size The current size of the library file
+   * @param modified The current modification time of the library file
+   * @return The index, or nothing if the manifest does not describe the file or the file changed since it was built
+   */
+  std::optional<LibraryIndex> findIndex(const std::string& file, std::uintmax_t size, std::int64_t modified) const;
+
+  /**
+   * @brief Get the libraries described by the manifest
+   * @return The libraries, in the order in which they were published
+   */
+  std::vector<Entry> getEntries() const;
+
+  /** @brief Check if the library files described by the manifest are unchanged since it was built */
+  bool isCurrent() const;
+
+  /** @brief The hash of the plugin configuration the manifest was built for */
+  std::uint64_t getConfigurationHash() const;
+
+  /** @brief The number of libraries described by the manifest */
+  std::size_t size() const;
+
+private:
+  LibraryManifest() = default;
+
+  /** @brief The contents of the manifest file, mapped or (on platforms without mmap) read into buffer_ */
+  const char* data_{ nullptr };
+  std::size_t size_{ 0 };
+  bool mapped_{ false };
+  std::string buffer_;
+
+  /** @brief The hash of the plugin configuration the manifest was built for */
+  std::uint64_t configuration_hash_{ 0 };
+
+  /** @brief The offsets of the records of the libraries, keyed by the canonical path of the library file */
+  std::unordered_map<std::string_view, std::size_t> records_;
+
+  /** @brief The offsets of the records of the libraries, in the order in which they were published */
+  std::vector<std::size_t> record_offsets_;
+
+  /** @brief Check the records of the manifest and index them, returning false if the manifest is malformed */
+  bool indexRecords(std::uint64_t library_count);
+};
+
+}  // namespace boost_plugin_loader
+
+#endif  // BOOST_PLUGIN_LOADER_LIBRARY_MANIFEST_H
@@ -0,0 +1,77 @@
+/**
+ *
+ * @copyright Copyright (c) 2021, Southwest Research Institute
+ *
+ * @par License
+ * Software License Agreement (Apache License)
+ * @par
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * @par
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef BOOST_PLUGIN_LOADER_LIBRARY_REGISTRY_H
+#define BOOST_PLUGIN_LOADER_LIBRARY_REGISTRY_H
+
+// STD
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace boost_plugin_loader
+{
+struct LoadedLibrary;
+
+/**
+ * @brief A process-wide registry of the plugin libraries loaded by plugin loaders which opt in to sharing them
+ * @details Libraries are keyed by the canonical path of the library file. The registry does not own the libraries: an
+ * entry is dropped once no plugin loader cache (or frozen plugin loader) refers to its library any more. Plugin
+ * instances only hold the library handle, not the registered library, so a library whose instances outlive every cache
+ * which held it stays mapped but is no longer registered, and the next plugin loader which needs it loads (i.e. reopens
+ * the mapped handle) and parses it again. Plugin loaders which find a library in the registry share its handle and
+ * parsed index instead of loading and parsing it again.
+ */
+class LibraryRegistry
+{
+public:
+  /** @brief Get the registry of the process */
+  static LibraryRegistry& instance();
+
+  /**
+   * @brief Find a registered library
+   * @param file The canonical path of the library file
+   * @return The library, or nullptr if it is not registered
+   */
+  std::shared_ptr<LoadedLibrary> find(const std::string& file) const;
+
+  /**
+   * @brief Register a library, unless a library is already registered for the same file
+   * @param file The canonical path of the library file
+   * @param library The library to register
+   * @return The registered library, which is the library already registered for the file if there is one
+   */
+  std::shared_ptr<LoadedLibrary> insert(const std::string& file, const std::shared_ptr<LoadedLibrary>& library);
+
+  /** @brief The number of registered libraries which are still alive */
+  std::size_t size() const;
+
+private:
+  LibraryRegistry() = default;
+
+  mutable std::mutex mutex_;
+  std::unordered_map<std::string, std::weak_ptr<LoadedLibrary>> libraries_;
+  /** @brief The number of entries at which expired entries are next removed */
+  std::size_t prune_threshold_{ 16 };
+};
+
+}  // namespace boost_plugin_loader
+
+#endif  // BOOST_PLUGIN_LOADER_LIBRARY_REGISTRY_H
@@ -0,0 +1,97 @@
+/**
+ *
+ * @copyright Copyright (c) 2021, Southwest Research Institute
+ *
+ * @par License
+ * Software License Agreement (Apache License)
+ * @par
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * @par
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef BOOST_PLUGIN_LOADER_LIBRARY_WATCHER_H
+#define BOOST_PLUGIN_LOADER_LIBRARY_WATCHER_H
+
+// STD
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace boost_plugin_loader
+{
+/** @brief The library files which changed since the last poll of a LibraryWatcher */
+struct LibraryChanges
+{
+  /** @brief The canonical paths of the files which were written, moved or removed */
+  std::vector<std::string> files;
+
+  /**
+   * @brief The watched directories which were removed or moved away, all of whose files are considered changed
+   * @details They are no longer watched, and are watched again once they are passed to watchDirectory after being
+   * recreated.
+   */
+  std::vector<std::string> directories;
+
+  /** @brief Set if events were lost because the event queue overflowed, so that every file is considered changed */
+  bool overflow{ false };
+
+  /** @brief Check if nothing changed */
+  bool empty() const { return files.empty() && directories.empty() && !overflow; }
+
+  /**
+   * @brief Check if a file is considered changed
+   * @param file The canonical path of the file
+   */
+  bool isChanged(const std::string& file) const;
+};
+
+/**
+ * @brief Watches directories for plugin library files which are written, replaced or removed
+ * @details This uses inotify and is only supported on Linux. On other platforms no changes are ever reported.
+ */
+class LibraryWatcher
+{
+public:
+  using Ptr = std::shared_ptr<LibraryWatcher>;
+
+  /** @throws PluginLoaderException if the watcher could not be created on a supported platform */
+  LibraryWatcher();
+  ~LibraryWatcher();
+  LibraryWatcher(const LibraryWatcher&) = delete;
+  LibraryWatcher& operator=(const LibraryWatcher&) = delete;
+  LibraryWatcher(LibraryWatcher&&) = delete;
+  LibraryWatcher& operator=(LibraryWatcher&&) = delete;
+
+  /** @brief Check if watching for library changes is supported on this platform */
+  static bool isSupported();
+
+  /**
+   * @brief Watch a directory for files which are written, moved or removed
+   * @param directory The directory to watch. Watching the same directory again has no effect.
+   * @return True if the directory is being watched
+   */
+  bool watchDirectory(const std::string& directory);
+
+  /**
+   * @brief Get the files which changed since the last call, without blocking
+   * @return The changed files, the watched directories which were removed or moved, and whether events were lost
+   */
+  LibraryChanges poll();
+
+private:
+  int fd_{ -1 };
+  /** @brief The canonical paths of the watched directories, keyed by watch descriptor */
+  std::unordered_map<int, std::string> directories_;
+};
+
+}  // namespace boost_plugin_loader
+
+#endif  // BOOST_PLUGIN_LOADER_LIBRARY_WATCHER_H
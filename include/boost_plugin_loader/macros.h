@@ -19,12 +19,64 @@
 #ifndef BOOST_PLUGIN_LOADER_MACROS_H
 #define BOOST_PLUGIN_LOADER_MACROS_H
 
+// STD
+#include <type_traits>
+
+// Boost
 #include <boost/dll/alias.hpp>
+#include <boost/preprocessor/cat.hpp>
+#include <boost/preprocessor/stringize.hpp>
+
+// Boost Plugin Loader
+#include <boost_plugin_loader/plugin_record.h>
+
+/**
+ * @brief The name of the plugin record of a class exported with an alias name under the "section" namespace
+ * @details The section and alias are joined with a separator which plugin names do not contain, so that the records of
+ * different plugins do not share a name (e.g. alias `b_c` under section `a` and alias `c` under section `a_b`). The
+ * separator has no double underscore, which would make the name a reserved identifier.
+ */
+#define BOOST_PLUGIN_LOADER_RECORD_NAME(ALIAS, SECTION)                                                                \
+  BOOST_PP_CAT(boost_plugin_loader_record_, BOOST_PP_CAT(SECTION, BOOST_PP_CAT(_bplsep_, ALIAS)))
+
+/**
+ * @brief Exports the plugin record of a class exported with an alias name under the "section" namespace
+ * @details The record is placed in the section `__bplrec` (see PLUGIN_RECORD_SECTION), which is hidden.
+ */
+#define BOOST_PLUGIN_LOADER_EXPORT_RECORD(ALIAS, SECTION, BASE_TYPE)                                                   \
+  static_assert(sizeof(BOOST_PP_STRINGIZE(SECTION)) <= sizeof(boost_plugin_loader::PluginRecord::section),             \
+                "The plugin section name is too long for its plugin record (at most 63 characters)");                  \
+  static_assert(sizeof(BOOST_PP_STRINGIZE(ALIAS)) <= sizeof(boost_plugin_loader::PluginRecord::alias),                 \
+                "The plugin name is too long for its plugin record (at most 127 characters)");                         \
+  extern "C" BOOST_SYMBOL_EXPORT const boost_plugin_loader::PluginRecord                                               \
+      BOOST_PLUGIN_LOADER_RECORD_NAME(ALIAS, SECTION);                                                                 \
+  BOOST_DLL_SECTION(__bplrec, read)                                                                                    \
+  BOOST_DLL_SELECTANY extern const boost_plugin_loader::PluginRecord                                                   \
+      BOOST_PLUGIN_LOADER_RECORD_NAME(ALIAS, SECTION) = {                                                              \
+    boost_plugin_loader::PLUGIN_RECORD_MAGIC, boost_plugin_loader::PLUGIN_RECORD_ABI_VERSION, BASE_TYPE,               \
+    BOOST_PP_STRINGIZE(SECTION), BOOST_PP_STRINGIZE(ALIAS)                                                             \
+  };
 
-/** @brief Exports a class with an alias name under the "section" namespace */
+/**
+ * @brief Exports a class with an alias name under the "section" namespace
+ * @details The plugin record of the class does not identify its base class, so the plugin loader cannot check it (see
+ * EXPORT_CLASS_SECTIONED_WITH_BASE).
+ */
 #define EXPORT_CLASS_SECTIONED(DERIVED_CLASS, ALIAS, SECTION)                                                          \
   extern "C" BOOST_SYMBOL_EXPORT DERIVED_CLASS ALIAS;                                                                  \
-  BOOST_DLL_SECTION(SECTION, read) BOOST_DLL_SELECTANY DERIVED_CLASS ALIAS;
+  BOOST_DLL_SECTION(SECTION, read) BOOST_DLL_SELECTANY DERIVED_CLASS ALIAS;                                            \
+  BOOST_PLUGIN_LOADER_EXPORT_RECORD(ALIAS, SECTION, 0)
+
+/**
+ * @brief Exports a class derived from a plugin base class with an alias name under the "section" namespace
+ * @details The plugin record of the class identifies the base class, so the plugin loader refuses to create the plugin
+ * as another base class. The export macros of plugin base classes should use this macro.
+ */
+#define EXPORT_CLASS_SECTIONED_WITH_BASE(DERIVED_CLASS, BASE_CLASS, ALIAS, SECTION)                                    \
+  static_assert(std::is_base_of<BASE_CLASS, DERIVED_CLASS>::value, "The plugin must derive from its base class");      \
+  extern "C" BOOST_SYMBOL_EXPORT DERIVED_CLASS ALIAS;                                                                  \
+  BOOST_DLL_SECTION(SECTION, read) BOOST_DLL_SELECTANY DERIVED_CLASS ALIAS;                                            \
+  BOOST_PLUGIN_LOADER_EXPORT_RECORD(ALIAS, SECTION, boost_plugin_loader::getTypeHash<BASE_CLASS>())
 
 #define PLUGIN_ANCHOR_DECL(ANCHOR_NAME) const void* ANCHOR_NAME();  // NOLINT
 
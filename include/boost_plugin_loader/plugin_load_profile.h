@@ -0,0 +1,101 @@
+/**
+ *
+ * @copyright Copyright (c) 2021, Southwest Research Institute
+ *
+ * @par License
+ * Software License Agreement (Apache License)
+ * @par
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * @par
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef BOOST_PLUGIN_LOADER_PLUGIN_LOAD_PROFILE_H
+#define BOOST_PLUGIN_LOADER_PLUGIN_LOAD_PROFILE_H
+
+// STD
+#include <istream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Boost Plugin Loader
+#include <boost_plugin_loader/plugin_loader_listener.h>
+
+namespace boost_plugin_loader
+{
+/**
+ * @brief A plugin loader listener which records the libraries and plugins resolved during a run
+ * @details The profile can be saved at the end of a run and loaded at the start of the next one, so that
+ * PluginLoader::preload can load exactly the libraries which are likely to be needed before the first plugin is
+ * requested, while the remaining libraries are still loaded lazily.
+ *
+ *   auto profile = std::make_shared<PluginLoadProfile>();
+ *   profile->load("plugin_load_profile.txt");
+ *   loader.preload(*profile);
+ *   loader.listeners.push_back(profile);
+ *   ...
+ *   profile->save("plugin_load_profile.txt");
+ */
+class PluginLoadProfile : public PluginLoaderListener
+{
+public:
+  using Ptr = std::shared_ptr<PluginLoadProfile>;
+
+  /** @brief A plugin resolved from a library, which is named as in PluginLoader::search_libraries */
+  struct Entry
+  {
+    std::string library;
+    std::string plugin;
+  };
+
+  void onSymbolResolved(const PluginLoaderEvent& event) override;
+
+  /** @brief Get the names of the recorded libraries, in the order in which they were first used */
+  std::vector<std::string> getLibraries() const;
+
+  /** @brief Get the recorded plugins, in the order in which they were first resolved */
+  std::vector<Entry> getEntries() const;
+
+  /** @brief Write the recorded entries, one per line */
+  void write(std::ostream& os) const;
+
+  /**
+   * @brief Write the recorded entries to a file
+   * @throws PluginLoaderException if the file cannot be written
+   */
+  void save(const std::string& file_path) const;
+
+  /** @brief Add the entries read from a stream written by write to the recorded entries */
+  void read(std::istream& is);
+
+  /**
+   * @brief Add the entries read from a file written by save to the recorded entries
+   * @return False if the file could not be opened, which is expected on the first run
+   */
+  bool load(const std::string& file_path);
+
+  /** @brief Check if no entries are recorded */
+  bool empty() const;
+
+  /** @brief Remove all recorded entries */
+  void clear();
+
+private:
+  mutable std::mutex mutex_;
+  std::vector<Entry> entries_;
+
+  void addLocked(std::string library, std::string plugin);
+};
+
+}  // namespace boost_plugin_loader
+
+#endif  // BOOST_PLUGIN_LOADER_PLUGIN_LOAD_PROFILE_H
@@ -20,19 +20,43 @@
 #define BOOST_PLUGIN_LOADER_PLUGIN_LOADER_H
 
 // STD
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
 #include <string>
 #include <memory>
+#include <typeinfo>
 #include <vector>
 #include <mutex>
+#include <optional>
 #include <unordered_map>
+#include <unordered_set>
 
 // Boost
 #include <boost/dll/shared_library.hpp>
+#include <boost/dll/shared_library_load_mode.hpp>
+#include <boost/filesystem/path.hpp>
+
+// Boost Plugin Loader
+#include <boost_plugin_loader/frozen_plugin_table.h>
+#include <boost_plugin_loader/library_manifest.h>
+#include <boost_plugin_loader/library_registry.h>
+#include <boost_plugin_loader/library_watcher.h>
+#include <boost_plugin_loader/plugin_load_profile.h>
+#include <boost_plugin_loader/plugin_loader_listener.h>
+#include <boost_plugin_loader/utils.h>
 
 /** @brief Macro for explicitly template instantiating a plugin loader for a given base class */
 #define INSTANTIATE_PLUGIN_LOADER(PluginBase)                                                                          \
   template std::vector<std::string> boost_plugin_loader::PluginLoader::getAvailablePlugins<PluginBase>() const;        \
-  template std::shared_ptr<PluginBase> boost_plugin_loader::PluginLoader::createInstance(const std::string&) const;
+  template std::shared_ptr<PluginBase> boost_plugin_loader::PluginLoader::createInstance(const std::string&) const;    \
+  template std::shared_ptr<PluginBase> boost_plugin_loader::PluginLoader::tryCreateInstance(                           \
+      const std::string&, boost_plugin_loader::PluginLoaderErrorCode*) const;                                          \
+  template std::map<std::string, std::shared_ptr<PluginBase>>                                                          \
+  boost_plugin_loader::PluginLoader::createAllInstances<PluginBase>() const;
 
 namespace boost_plugin_loader
 {
@@ -56,6 +80,322 @@ struct has_getSection
   static constexpr bool value = test_getSection<T>(int());
 };
 
+/** @brief A plugin library held in the plugin loader's cache */
+struct LoadedLibrary
+{
+  using Ptr = std::shared_ptr<LoadedLibrary>;
+
+  LoadedLibrary() = default;
+  inline ~LoadedLibrary();
+  LoadedLibrary(const LoadedLibrary&) = delete;
+  LoadedLibrary& operator=(const LoadedLibrary&) = delete;
+  LoadedLibrary(LoadedLibrary&&) = delete;
+  LoadedLibrary& operator=(LoadedLibrary&&) = delete;
+
+  /**
+   * @brief The library handle
+   * @details Every plugin instance created from the library shares ownership of this handle, so the library remains
+   * mapped for as long as any of its plugin instances are alive, even after it is removed from the cache. This is null
+   * for the libraries described by a manifest which are visited without loading them (see PluginLoader::loadManifest).
+   */
+  std::shared_ptr<boost::dll::shared_library> library;
+
+  /** @brief The size of the library file in bytes, used as an estimate of the memory occupied by the library */
+  std::uintmax_t size{ 0 };
+
+  /** @brief The number of plugin lookups this library satisfied, only counted with adaptive_search_order */
+  std::atomic<std::uint64_t> hits{ 0 };
+
+  /** @brief The library name (as listed in search_libraries) for which the library was loaded */
+  std::string name;
+
+  /** @brief The canonical path of the library file, if it could be determined */
+  std::string file;
+
+  /**
+   * @brief The temporary directory holding the copy of the library file which was actually loaded, if any
+   * @details A library which changed on disk while an older version was loaded is loaded from a copy, because the
+   * dynamic loader would otherwise return the already loaded version. The directory is removed with this object.
+   */
+  boost::filesystem::path shadow_directory;
+
+  /** @brief The manifest from which the index of the library is read if it describes the library file, if any */
+  LibraryManifest::ConstPtr manifest;
+
+  /** @brief The number of plugin instances created from this library which are still alive */
+  std::size_t liveInstances() const
+  {
+    const long count = library.use_count();
+    return count > 1 ? static_cast<std::size_t>(count - 1) : 0;
+  }
+
+  /**
+   * @brief Get the sections and symbols of the library
+   * @details The library file is parsed the first time this is called, unless the manifest describes it, and the result
+   * is kept for the lifetime of this object.
+   */
+  inline const LibraryIndex& getIndex() const;
+
+private:
+  mutable std::once_flag index_flag_;
+  mutable LibraryIndex index_;
+};
+
+/** @brief The cache entry to which a library name was resolved */
+struct LibraryResolution
+{
+  /** @brief The key of the library in the plugin loader's cache */
+  std::string key;
+
+  /**
+   * @brief The index of the search path in which the library was found
+   * @details This is `absolute` for libraries named by absolute paths and `system` for libraries found in system
+   * folders
+   */
+  std::size_t search_path_index{ 0 };
+
+  static constexpr std::size_t absolute = static_cast<std::size_t>(-1);
+  static constexpr std::size_t system = static_cast<std::size_t>(-2);
+};
+
+/**
+ * @brief The order in which libraries are probed for plugins when adaptive_search_order is enabled
+ * @details This is computed for a list of libraries in search order, and replaced when the libraries change or once
+ * as many lookups as there are libraries were made with it.
+ */
+struct AdaptiveSearchOrder
+{
+  using ConstPtr = std::shared_ptr<const AdaptiveSearchOrder>;
+
+  /** @brief The libraries in search order */
+  std::vector<std::weak_ptr<LoadedLibrary>> libraries;
+
+  /** @brief The indexes of the libraries in descending order of hits, ties in search order */
+  std::vector<std::size_t> order;
+
+  /** @brief The plugin names provided by more than one of the libraries, keyed by section */
+  std::unordered_map<std::string, std::unordered_set<std::string>> ambiguous_plugins;
+
+  /** @brief The hidden sections of the libraries, whose plugins are not indexed */
+  std::unordered_set<std::string> hidden_sections;
+
+  /**
+   * @brief Check if a plugin must be searched for in search order, because more than one library may provide it
+   * @param section The section of the plugin
+   * @param plugin_name The plugin name
+   */
+  bool isAmbiguous(const std::string& section, const std::string& plugin_name) const
+  {
+    if (hidden_sections.count(section) > 0)
+      return true;
+
+    const auto it = ambiguous_plugins.find(section);
+    return (it != ambiguous_plugins.end()) && (it->second.count(plugin_name) > 0);
+  }
+};
+
+/**
+ * @brief An entry of a per-thread cache of plugin resolutions, used when thread_local_cache is enabled
+ * @details An entry is only valid while its generation is the current library cache generation (see
+ * getLibraryCacheGeneration), the search configuration of its plugin loader was unchanged at its last search, and its
+ * library is still alive.
+ */
+struct ThreadCacheEntry
+{
+  /** @brief The library cache generation the entry was filled in, or zero if it is empty */
+  std::uint64_t generation{ 0 };
+
+  /** @brief The hash of the search configuration of the plugin loader when the entry was filled */
+  std::size_t configuration{ 0 };
+
+  /** @brief The plugin loader which resolved the plugin */
+  const void* loader{ nullptr };
+
+  /** @brief The plugin base type */
+  const std::type_info* type{ nullptr };
+
+  /** @brief The plugin name */
+  std::string plugin_name;
+
+  /** @brief The library which provides the plugin */
+  std::weak_ptr<LoadedLibrary> library;
+
+  /** @brief The plugin object in the library */
+  void* plugin{ nullptr };
+
+  /** @brief Check if the entry holds a plugin, regardless of its generation */
+  bool matches(const void* plugin_loader, const std::type_info& plugin_type, const std::string& name) const
+  {
+    return (loader == plugin_loader) && (type != nullptr) && (*type == plugin_type) && (plugin_name == name);
+  }
+};
+
+/** @brief A set of a per-thread cache of plugin resolutions, holding the most recent resolution first */
+using ThreadCacheSet = std::array<ThreadCacheEntry, 2>;
+
+/** @brief The libraries and plugins of a frozen plugin loader, see PluginLoader::freeze */
+struct FrozenPlugins
+{
+  using ConstPtr = std::shared_ptr<const FrozenPlugins>;
+
+  /** @brief The library names and search paths the plugin loader was frozen with */
+  std::vector<std::string> library_names;
+  std::vector<std::string> search_paths;
+
+  /** @brief The library files discovered with discovery_patterns */
+  std::vector<std::string> discovered_libraries;
+
+  /** @brief The libraries in search order */
+  std::vector<LoadedLibrary::Ptr> libraries;
+
+  /** @brief The plugins of the libraries, including those under hidden sections */
+  FrozenPluginTable plugins;
+};
+
+/** @brief The listing of a search path kept by the library cache, see PluginLoader::cache_directory_listings */
+struct CachedDirectoryListing
+{
+  DirectoryListing listing;
+
+  /** @brief The use counter of the library cache when the listing was last checked to be current */
+  std::uint64_t checked{ 0 };
+};
+
+/** @brief The libraries discovered in the search paths, see PluginLoader::discovery_patterns */
+struct CachedLibraryDiscovery
+{
+  /** @brief The search paths which were scanned */
+  std::vector<std::string> search_paths;
+
+  /** @brief The patterns and depth of the scan */
+  std::vector<std::string> patterns;
+  std::size_t depth{ 0 };
+
+  /** @brief The library files found and the directories which were scanned */
+  DiscoveredLibraries result;
+};
+
+/** @brief The result of checking the manifest of a library cache for a search configuration, see loadManifest */
+struct ManifestCheck
+{
+  /** @brief The library cache generation when the manifest was checked, or zero if it was not checked */
+  std::uint64_t generation{ 0 };
+
+  /** @brief The search configuration which was checked, with the values of its environment variables */
+  bool search_system_folders{ true };
+  std::vector<std::string> search_paths;
+  std::vector<std::string> search_libraries;
+  std::string search_paths_env;
+  std::string search_libraries_env;
+  std::optional<std::string> search_paths_env_value;
+  std::optional<std::string> search_libraries_env_value;
+  std::vector<std::string> discovery_patterns;
+  std::size_t discovery_depth{ 0 };
+
+  /** @brief Whether the manifest was built for the configuration and describes the current library files */
+  bool current{ false };
+};
+
+/**
+ * @brief The libraries loaded by a plugin loader and the resolutions of library names to them
+ * @details Copies of a plugin loader share its cache, so copying a plugin loader does not copy its cached libraries. A
+ * copy switches to its own cache when its search configuration diverges from the one the shared cache was resolved
+ * against, when it is cleared, or when it evicts libraries.
+ */
+struct LibraryCache
+{
+  using Ptr = std::shared_ptr<LibraryCache>;
+
+  std::mutex mutex;
+
+  /** @brief Loaded plugin libraries, stored by the path from which the library was loaded */
+  std::unordered_map<std::string, LoadedLibrary::Ptr> libraries;
+
+  /**
+   * @brief The cache keys of the loaded libraries, keyed by the canonical paths of their files
+   * @details A library reached through another path (a symlink, a relative path or another search path) resolves to the
+   * existing cache entry, so each library file is loaded, indexed and listed once. Entries whose cache entry was
+   * removed are dropped when they are next looked up.
+   */
+  std::unordered_map<std::string, std::string> library_files;
+
+  /** @brief Counter incremented each time libraries are loaded, used to track the recency of library use */
+  std::uint64_t use_counter{ 0 };
+
+  /**
+   * @brief The value of use_counter the last time each library was used, keyed like libraries (for LRU eviction)
+   * @details This is kept by the cache rather than the library, since a library shared with other plugin loaders
+   * through the registry is used at the pace of their own counters.
+   */
+  std::unordered_map<std::string, std::uint64_t> last_used;
+
+  /**
+   * @brief The cache entries to which library names were last resolved, keyed by library name
+   * @details Resolutions are kept while the search paths they depend on are unchanged and their cache entries exist, so
+   * only new library names, and names whose resolution was invalidated, are searched for.
+   */
+  std::unordered_map<std::string, LibraryResolution> resolutions;
+
+  /** @brief The search paths against which the resolutions were made */
+  std::vector<std::string> resolved_search_paths;
+
+  /** @brief The value of search_system_folders when the resolutions were made */
+  bool resolved_search_system_folders{ true };
+
+  /** @brief Watcher used when watch_libraries is enabled, created on first use */
+  LibraryWatcher::Ptr watcher;
+
+  /** @brief The canonical paths of library files which changed while loaded, which are loaded from a copy */
+  std::vector<std::string> changed_library_files;
+
+  /** @brief The listings of the directories searched with cache_directory_listings, keyed by directory */
+  std::unordered_map<std::string, CachedDirectoryListing> directory_listings;
+
+  /** @brief The manifest loaded by PluginLoader::loadManifest, used for the libraries loaded afterwards */
+  LibraryManifest::ConstPtr manifest;
+
+  /** @brief The libraries described by the manifest in search order, which are not loaded (see getManifestLibraries) */
+  std::shared_ptr<const std::vector<LoadedLibrary::Ptr>> manifest_libraries;
+
+  /** @brief The last check of the manifest, which is reused while the configuration and the generation are unchanged */
+  ManifestCheck manifest_check;
+
+  /** @brief The last scan of the search paths for discovery_patterns */
+  CachedLibraryDiscovery discovery;
+
+  /** @brief The adaptive search order of the libraries last searched with adaptive_search_order */
+  AdaptiveSearchOrder::ConstPtr adaptive_search_order;
+
+  /** @brief The number of lookups made with adaptive_search_order since it was computed */
+  std::size_t adaptive_lookups{ 0 };
+
+  /**
+   * @brief Create a cache holding the same libraries and resolutions, which can then diverge from this one
+   * @details The caller must hold the mutex. The watcher is not shared with the copy.
+   */
+  inline Ptr clone() const;
+};
+
+/** @brief The result of evicting libraries from the plugin loader's cache */
+struct LibraryEvictionReport
+{
+  /** @brief The cache keys of the libraries which were removed from the cache */
+  std::vector<std::string> unloaded;
+
+  /** @brief The cache keys of the libraries which remain in the cache */
+  std::vector<std::string> retained;
+};
+
+/** @brief The time threads spent waiting for the locks of a plugin loader */
+struct LockWaitStatistics
+{
+  /** @brief The number of lock acquisitions which had to wait for another thread to release the lock */
+  std::uint64_t contended_acquisitions{ 0 };
+
+  /** @brief The total time spent waiting in those acquisitions */
+  std::chrono::nanoseconds wait_time{ 0 };
+};
+
 /**
  * @brief This is a utility class for loading plugins
  * @details The library_name should not include the prefix 'lib' or suffix '.so'. It will add the correct prefix and
@@ -76,7 +416,12 @@ class PluginLoader
 {
 public:
   PluginLoader() = default;
-  ~PluginLoader() = default;
+  ~PluginLoader()
+  {
+    // Per-thread cache entries are keyed by the address of the plugin loader, which may be reused
+    if (cache_ != nullptr)
+      advanceLibraryCacheGeneration();
+  }
   inline PluginLoader(const PluginLoader& other);
   inline PluginLoader& operator=(const PluginLoader& other);
   inline PluginLoader(PluginLoader&& other) noexcept;
@@ -102,15 +447,163 @@ public:
    */
   std::string search_libraries_env;
 
+  /**
+   * @brief Listeners notified of library loads, symbol resolution, instance creation and failures
+   * @details See ChromeTraceListener for a listener which records a timeline viewable in Perfetto
+   */
+  std::vector<PluginLoaderListener::Ptr> listeners;
+
+  /**
+   * @brief The mode used to load plugin libraries
+   * @details For example, `boost::dll::load_mode::rtld_now | boost::dll::load_mode::rtld_global` resolves all symbols
+   * when the library is loaded and makes them available to libraries loaded afterwards, and
+   * `boost_plugin_loader::load_mode::rtld_nodelete` keeps libraries mapped after they are closed to avoid
+   * unload/reload churn. Decorations are always appended to library names, and system folders are searched according
+   * to search_system_folders. The mode only applies when a library is loaded, not to libraries that are already cached.
+   */
+  boost::dll::load_mode::type load_mode{ boost::dll::load_mode::default_mode };
+
+  /** @brief Load mode overrides for individual libraries, keyed by the library name as listed in search_libraries */
+  std::unordered_map<std::string, boost::dll::load_mode::type> library_load_modes;
+
+  /**
+   * @brief Prefetch plugin library files into the page cache before loading them
+   * @details Before loading libraries which are not yet cached, all candidate files for them are read ahead in parallel
+   * (see prefetchFiles), so that the page faults taken while loading are served from memory. This is most useful for
+   * large libraries on slow disks or overlay filesystems.
+   */
+  bool warm_page_cache{ false };
+
+  /**
+   * @brief Libraries (named as in search_libraries) whose mapped segments are prefaulted after they are loaded
+   * @details See prefaultLibrary
+   */
+  std::vector<std::string> hot_libraries;
+
+  /**
+   * @brief The maximum number of libraries kept in the internal cache, or zero for no limit
+   * @details When the cache exceeds the budget after loading libraries, idle libraries (those without live plugin
+   * instances) which were not used by the current call are unloaded in least-recently-used order.
+   */
+  std::size_t max_cached_libraries{ 0 };
+
+  /**
+   * @brief The maximum total size in bytes of the library files kept in the internal cache, or zero for no limit
+   * @details This is enforced in the same way as max_cached_libraries.
+   */
+  std::uintmax_t max_cached_library_bytes{ 0 };
+
+  /**
+   * @brief Watch the search paths and loaded library files for changes and reload libraries which changed
+   * @details This is only supported on Linux (inotify). Changes are picked up by the next call which loads libraries.
+   * Only the cache entries of the changed libraries are dropped, and the new versions are loaded when they are next
+   * needed, so new plugin instances come from the new versions. Existing plugin instances keep the old versions mapped
+   * until they are destroyed. Libraries should be replaced atomically (e.g. written elsewhere and renamed into place)
+   * rather than overwritten in place, since overwriting a mapped library can crash the process.
+   */
+  bool watch_libraries{ false };
+
+  /**
+   * @brief Share loaded libraries with other plugin loaders through the process-wide LibraryRegistry
+   * @details A library which was already loaded by another plugin loader with this option enabled is reused, including
+   * its parsed sections and symbols, rather than being loaded and parsed again. Libraries are identified by the
+   * canonical path of their file. The load mode of the plugin loader which first loaded a library applies.
+   */
+  bool use_shared_registry{ false };
+
+  /**
+   * @brief Load the libraries which are not yet cached in parallel waves, ordered by their declared dependencies
+   * @details Libraries declare the plugin libraries they depend on in a sidecar manifest next to the library file (see
+   * readLibraryDependencies). Each wave loads the libraries whose dependencies were loaded by earlier waves, so the
+   * order of search_libraries no longer matters for them. Dependencies on libraries which are not listed are ignored,
+   * and libraries found in system folders are loaded afterwards as usual. Listeners are notified of the load of each
+   * library from the thread which loads it, and of each wave. Since all libraries are loaded at once, createInstance no
+   * longer stops loading at the library which has the plugin.
+   * @throws PluginLoaderException from the calls which load libraries if the dependencies are cyclic
+   */
+  bool parallel_load{ false };
+
+  /**
+   * @brief Probe the libraries which satisfied the most lookups first when searching for a plugin
+   * @details Libraries are counted each time they provide a plugin to createInstance, and are probed in descending
+   * order of hits. Plugins which more than one library provides (under the same section) are still searched for in
+   * search order, so the same library provides a plugin as without this option. Since that requires the plugins of all
+   * libraries, all libraries are loaded rather than only those up to the one which provides the plugin. This reduces
+   * the number of probes when many libraries are searched and most lookups hit a few of them.
+   */
+  bool adaptive_search_order{ false };
+
+  /**
+   * @brief Serve repeated plugin lookups from a small per-thread cache in front of the library cache
+   * @details Each thread keeps a small two-way set-associative cache of the libraries and plugin objects it resolved,
+   * keyed by plugin loader, plugin type and plugin name. Entries are validated against a process-wide generation which
+   * advances whenever a plugin loader loads, unloads or clears libraries, and against a hash of the search
+   * configuration of the plugin loader taken each time it searches its libraries, so a hit takes no lock, does not
+   * read the configuration or the environment and does not look up the symbol. A hit still takes a reference to the
+   * library for the instance. Hits do not count towards idle eviction or the adaptive search order. Changes to the
+   * configuration are seen by hits once the plugin loader next searches its libraries (e.g. for a lookup which misses
+   * or getAvailablePlugins), while changes to the values of the environment variables are not seen by hits at all:
+   * call advanceLibraryCacheGeneration() or clear() after changing either to invalidate the hits at once.
+   */
+  bool thread_local_cache{ false };
+
+  /**
+   * @brief Only try to load libraries from the search paths whose directory has a file for them
+   * @details Each search path is listed once and the names of its files are kept in the cache, so resolving a library
+   * name tries to load it only from the search paths which have its file, rather than making a failed attempt in each
+   * search path before it. A listing is read again when the modification time of its directory changed, checked at
+   * most once per call, and clear() drops all listings. Libraries found in system folders are not affected.
+   */
+  bool cache_directory_listings{ false };
+
+  /**
+   * @brief Glob patterns of library file names (e.g. `lib*_plugins.so`) to discover in the search paths
+   * @details The search paths, and their subdirectories up to discovery_depth, are scanned for files whose names match
+   * any of the patterns and which have the header of a shared library (see discoverLibraries). The files found are
+   * loaded as if they were listed in search_libraries by their absolute paths, so they are cached, indexed and searched
+   * like other libraries named by absolute paths. The scan is kept in the cache and repeated when the modification time
+   * of a scanned directory changed, checked once per call. Search paths from search_paths_env are scanned as well.
+   */
+  std::vector<std::string> discovery_patterns;
+
+  /** @brief The depth of the subdirectories of the search paths scanned for discovery_patterns (zero scans none) */
+  std::size_t discovery_depth{ 0 };
+
   /**
    * @brief Loads a shared instance of a plugin of a specified type
-   * @throws If the plugin is not found
+   * @throws PluginNotFoundException If the plugin is not found, or PluginLoaderException if no libraries were provided
    * @param plugin_name The plugin name to find
    * @return A shared instance
    */
   template <class PluginBase>
   std::shared_ptr<PluginBase> createInstance(const std::string& plugin_name) const;
 
+  /**
+   * @brief Loads a shared instance of a plugin of a specified type, without throwing if the plugin is not found
+   * @details This is intended for probing for optional plugins. Unlike createInstance, no error message is formatted
+   * when the plugin is not found. Errors which occur while loading libraries are still thrown.
+   * @param plugin_name The plugin name to find
+   * @param error If not null, set to the reason the plugin instance could not be created, or SUCCESS
+   * @return A shared instance, or nullptr if the plugin could not be found
+   */
+  template <class PluginBase>
+  std::shared_ptr<PluginBase> tryCreateInstance(const std::string& plugin_name,
+                                                PluginLoaderErrorCode* error = nullptr) const;
+
+  /**
+   * @brief Create an instance of each available plugin of a specified base type
+   * @details The libraries are loaded once and parsed concurrently. If several libraries provide a plugin with the same
+   * name, only the plugin of the library which createInstance would use is resolved, and the instances are then created
+   * concurrently, so the listeners are notified from several threads. Plugin objects are constructed when their library
+   * is loaded, so set parallel_load to also load the libraries concurrently. See getAvailablePlugins for the
+   * requirements on the plugin base type.
+   * @throws PluginLoaderException if no libraries were provided
+   * @return The plugin instances keyed by plugin name
+   */
+  template <class PluginBase>
+  typename std::enable_if_t<has_getSection<PluginBase>::value, std::map<std::string, std::shared_ptr<PluginBase>>>
+  createAllInstances() const;
+
   /**
    * @brief Lists all available plugins of a specified base type
    * @details This method requires that each plugin interface definition define a static string member called `section`.
@@ -141,8 +634,71 @@ public:
    */
   inline std::vector<std::string> getAvailableSections(bool include_hidden = false) const;
 
+  /**
+   * @brief Visit the available plugins under the provided section without copying their names
+   * @details The callback is invoked as `callback(std::string_view plugin, const LoadedLibrary::Ptr& library)`. The
+   * plugin name refers to storage owned by the library, so it remains valid for as long as the library is referenced.
+   * Unless the library names or search paths are extended by environment variables, no memory is allocated once the
+   * libraries are loaded and indexed (for up to 16 libraries and sections which are not hidden). While a manifest
+   * loaded with loadManifest is current, the plugins of sections which are not hidden are listed from the manifest
+   * without loading the libraries, and the library passed to the callback is not loaded (see LoadedLibrary::library).
+   * @param section The section name to get all available plugins
+   * @param callback The function invoked for each plugin
+   */
+  template <class Callback>
+  void forEachPlugin(const std::string& section, Callback&& callback) const;
+
+  /**
+   * @brief Visit the available sections within the provided search libraries without copying their names
+   * @details The callback is invoked as `callback(std::string_view section, const LoadedLibrary::Ptr& library)`. See
+   * forEachPlugin. While a manifest loaded with loadManifest is current, the sections are listed from the manifest
+   * without loading the libraries.
+   * @param callback The function invoked for each section
+   * @param include_hidden Indicate if hidden sections should be included
+   */
+  template <class Callback>
+  void forEachSection(Callback&& callback, bool include_hidden = false) const;
+
+  /**
+   * @brief Load and index the libraries recorded in a profile of a previous run ahead of the first request
+   * @details Only recorded libraries which are still listed in the library names or discovered with discovery_patterns
+   * are loaded, so the remaining libraries stay lazy, and the libraries already resolved are kept. The libraries are
+   * loaded into the internal cache, and then their sections and symbols are parsed in parallel. Libraries which cannot
+   * be found are skipped.
+   * @param profile The profile recorded by a PluginLoadProfile listener
+   * @return The number of libraries which were preloaded
+   */
+  inline std::size_t preload(const PluginLoadProfile& profile) const;
+
+  /**
+   * @brief Load the manifest of the sections and symbols of the configured libraries, building it if necessary
+   * @details If the manifest file exists, was built for the current configuration (the library names, search paths,
+   * search_system_folders and discovery settings) and the library files are unchanged, it is mapped. Otherwise the
+   * configured libraries are loaded and parsed and a new manifest is published, while other processes calling this
+   * function for the same file wait for it rather than parsing the libraries themselves. The libraries which this
+   * plugin loader loads afterwards read their sections and symbols from the manifest. As long as the configuration
+   * and the library files are unchanged, getAvailablePlugins, getAvailableSections, forEachPlugin, forEachSection and
+   * isPluginAvailable answer from the manifest without loading the libraries (except for plugins under hidden
+   * sections, which are not in the manifest), so only createInstance and the functions which create instances load
+   * libraries. Library files added after the manifest was built are not seen until it is rebuilt. Whether the manifest
+   * is current is checked again when the configuration changes or the plugin loader loads or unloads libraries, rather
+   * than for each query. The manifest is used by this plugin loader and copies made from it afterwards, and clear()
+   * drops it.
+   * @param file_path The path of the manifest file, which should be shared by the processes
+   * @throws PluginLoaderException if the manifest has to be built and cannot be written
+   * @return The manifest
+   */
+  inline LibraryManifest::ConstPtr loadManifest(const std::string& file_path) const;
+
+  /**
+   * @brief Get the library files discovered in the search paths with discovery_patterns
+   * @return The paths of the library files, in the order in which they are searched
+   */
+  inline std::vector<std::string> getDiscoveredLibraries() const;
+
   /**
    * @brief The number of plugins stored. The size of plugins variable
+   * @details This includes the libraries discovered with discovery_patterns.
    * @return The number of plugins.
    */
   inline int count() const;
@@ -153,42 +709,309 @@ public:
    */
   inline bool empty() const;
 
-  /** @brief Clear the internal cache of loaded plugin libraries */
+  /**
+   * @brief Clear the internal cache of loaded plugin libraries
+   * @details Libraries with live plugin instances stay loaded until their last instance is destroyed. Copies of this
+   * plugin loader which share its cache are not affected.
+   */
   inline void clear();
 
+  /**
+   * @brief Unload idle libraries (those without live plugin instances) in least-recently-used order
+   * @details Libraries are evicted until the cache is within max_cached_libraries and max_cached_library_bytes. If
+   * neither budget is set, all idle libraries are evicted. Libraries with live plugin instances are always retained.
+   * Copies of this plugin loader which share its cache are not affected, as with clear().
+   * @return The libraries which were unloaded and those which were retained
+   */
+  inline LibraryEvictionReport evictIdleLibraries();
+
+  /**
+   * @brief Get the number of live plugin instances created from each cached library
+   * @return The number of live plugin instances keyed by the path from which the library was loaded
+   */
+  inline std::unordered_map<std::string, std::size_t> getLiveInstanceCounts() const;
+
+  /**
+   * @brief Get the time threads spent waiting for the locks of this plugin loader since it was created
+   * @details Only acquisitions which had to wait are timed, so uncontended use is not slowed down. Copies of a plugin
+   * loader start with their own statistics.
+   */
+  inline LockWaitStatistics getLockWaitStatistics() const;
+
+  /**
+   * @brief Load all libraries, resolve all of their plugins and serve all further lookups from an immutable table
+   * @details The configured libraries (including those named by the environment variables and those discovered with
+   * discovery_patterns) are loaded and parsed, and the symbols of their plugins under all sections, including hidden
+   * ones, are resolved. The plugins are then looked up in a minimal perfect hash over their section and name (see
+   * FrozenPluginTable), so createInstance, tryCreateInstance, isPluginAvailable and forEachPlugin take no lock, read
+   * neither the environment nor the file system, and, unless there are listeners or createInstance throws because the
+   * plugin is not found, do not allocate memory. Instances share the library handle's control block. Plugin types
+   * without a section and isPluginAvailable only find plugins exported under a section. Changes to the configuration
+   * after freezing have no effect, and clear(), evictIdleLibraries(), preload() and loadManifest() throw. Copies of a
+   * frozen plugin loader are frozen as well. Freezing a frozen plugin loader does nothing.
+   * This must not be called concurrently with other calls on this plugin loader.
+   * @throws PluginLoaderException if no plugin libraries were provided or the libraries cannot be parsed
+   */
+  inline void freeze();
+
+  /** @brief Check if the plugin loader is frozen, see freeze() */
+  bool isFrozen() const { return frozen_ != nullptr; }
+
 protected:
+  /** @brief Guards cache_, and is held while this plugin loader uses the cache */
   mutable std::mutex libraries_mutex_;
-  /** @brief Internal cache of loaded plugin libraries, stored by the path from which the library was loaded */
-  mutable std::unordered_map<std::string, boost::dll::shared_library> libraries_;
+  /** @brief Internal cache of loaded plugin libraries, shared with copies of this plugin loader until they diverge */
+  mutable LibraryCache::Ptr cache_{ std::make_shared<LibraryCache>() };
+  /** @brief The number of lock acquisitions which had to wait */
+  mutable std::atomic<std::uint64_t> contended_lock_acquisitions_{ 0 };
+  /** @brief The total time spent waiting for locks in nanoseconds */
+  mutable std::atomic<std::uint64_t> lock_wait_ns_{ 0 };
+  /** @brief The libraries and plugins of this plugin loader once it is frozen, which are never modified */
+  FrozenPlugins::ConstPtr frozen_;
+  /** @brief The hash of the search configuration at the last search with thread_local_cache enabled */
+  mutable std::atomic<std::size_t> search_configuration_hash_{ 0 };
+  /** @brief Set by loadManifest, so that queries without a manifest do not take the locks to look for it */
+  mutable std::atomic<bool> manifest_loaded_{ false };
+
+  /**
+   * @brief Lock a mutex used by this plugin loader, recording the time spent waiting if it is held by another thread
+   * @param mutex libraries_mutex_ or the mutex of the cache
+   * @return The lock
+   */
+  inline std::unique_lock<std::mutex> lockAndRecordWait(std::mutex& mutex) const;
+
+  /**
+   * @brief Get the cache, creating it if this plugin loader was moved from
+   * @details The caller must hold libraries_mutex_.
+   */
+  inline LibraryCache& getCacheLocked() const;
+
+  /**
+   * @brief Switch to a private copy of the cache if it is shared with copies of this plugin loader
+   * @details The caller must hold libraries_mutex_ and the lock of the cache, which is moved to the copy.
+   * @param cache_lock The lock of the cache
+   * @return The cache, which is no longer shared
+   */
+  inline LibraryCache& detachCacheLocked(std::unique_lock<std::mutex>& cache_lock) const;
+
+  /**
+   * @brief Get the library files discovered with discovery_patterns, scanning the search paths if they changed
+   * @details The caller must hold the mutex of the cache.
+   */
+  inline const std::vector<std::string>&
+  discoverLibrariesLocked(LibraryCache& cache, const std::vector<std::string>& search_paths_local) const;
+
+  /**
+   * @brief Loads all libraries, using the internal cache of loaded libraries
+   * @param library_names list of library names
+   * @param search_paths_local list of local search paths in which to look for plugin libraries
+   * @return list of libraries with the specified input names that could be found
+   */
+  inline std::vector<LoadedLibrary::Ptr> loadLibraries(const std::vector<std::string>& library_names,
+                                                       const std::vector<std::string>& search_paths_local) const;
+
+  /**
+   * @brief Loads all libraries into a container, using the internal cache of loaded libraries
+   * @param library_names list of library names
+   * @param search_paths_local list of local search paths in which to look for plugin libraries
+   * @param libraries Set to the list of libraries with the specified input names that could be found
+   */
+  template <class LibraryContainer>
+  void loadLibraries(const std::vector<std::string>& library_names, const std::vector<std::string>& search_paths_local,
+                     LibraryContainer& libraries) const;
+
+  /**
+   * @brief Loads libraries into a container in search order until a predicate accepts one of them
+   * @details Libraries named by absolute paths are searched first (the last one listed first), followed by the other
+   * libraries in the order in which they are listed. Libraries after the accepted one are not loaded, unless
+   * parallel_load is set. The predicate is invoked while the cache's mutex is held.
+   * @param library_names list of library names
+   * @param search_paths_local list of local search paths in which to look for plugin libraries
+   * @param libraries Set to the list of libraries which were searched, ending with the accepted library if any
+   * @param stop The predicate, invoked as `stop(const LoadedLibrary::Ptr& lib)` for each library in search order
+   * @param configured Indicate if the library names are all configured library names. Otherwise only the named
+   * libraries are loaded, without adding those discovered with discovery_patterns or dropping the resolutions of the
+   * library names which are not listed.
+   * @param check_file A check invoked with the file of each library which is about to be loaded (if the file is known
+   * before loading it), which may throw to abort the search before the library is loaded
+   */
+  template <class LibraryContainer, class StopPredicate>
+  void loadLibrariesUntil(const std::vector<std::string>& library_names,
+                          const std::vector<std::string>& search_paths_local, LibraryContainer& libraries,
+                          StopPredicate&& stop, bool configured = true,
+                          const std::function<void(const std::string& file)>& check_file = nullptr) const;
+
+  /**
+   * @brief Load the libraries of the plugin loader and invoke a visitor with each of them
+   * @throws PluginLoaderException if no plugin libraries were provided
+   */
+  template <class Visitor>
+  void visitLibraries(Visitor&& visitor) const;
+
+  /**
+   * @brief Get the libraries described by the manifest loaded with loadManifest, if it is current
+   * @details The manifest is current if it was built for the current configuration and the library files are
+   * unchanged. This is checked when the configuration (including the values of the environment variables) or the
+   * library cache generation changed since the last check, so repeated queries neither allocate memory nor read the
+   * file system. The libraries are not loaded, so only their names, files and indexes can be used.
+   * @return The libraries in search order, or nullptr if no manifest is loaded or it is not current
+   */
+  inline std::shared_ptr<const std::vector<LoadedLibrary::Ptr>> getManifestLibraries() const;
+
+  /**
+   * @brief Check if a check of the manifest was made for the current configuration and library cache generation
+   * @param check The check
+   */
+  inline bool isManifestCheckCurrent(const ManifestCheck& check) const;
+
+  /**
+   * @brief Hash the configuration which determines the libraries that are loaded, for which a manifest is built
+   * @param library_names list of library names
+   * @param search_paths_local list of local search paths in which to look for plugin libraries
+   */
+  inline std::uint64_t getManifestConfigurationHash(const std::vector<std::string>& library_names,
+                                                    const std::vector<std::string>& search_paths_local) const;
+
+  /**
+   * @brief Drop the resolutions which may differ when resolving against new search paths
+   * @details A resolution to a search path is kept if the search paths up to and including that path are unchanged. The
+   * caller must hold the cache's mutex.
+   * @param cache The cache holding the resolutions
+   * @param search_paths_local list of local search paths in which to look for plugin libraries
+   */
+  inline void updateResolutionsLocked(LibraryCache& cache, const std::vector<std::string>& search_paths_local) const;
+
+  /**
+   * @brief Drop the cache entries of libraries whose files changed since the last call
+   * @details The caller must hold the cache's mutex.
+   * @param cache The cache holding the libraries
+   * @param search_paths_local list of local search paths to watch
+   */
+  inline void processLibraryChangesLocked(LibraryCache& cache,
+                                          const std::vector<std::string>& search_paths_local) const;
+
+  /**
+   * @brief Prefetch the candidate files of the libraries which are not yet cached into the page cache
+   * @details The caller must hold the cache's mutex.
+   * @param cache The cache holding the libraries
+   * @param library_names list of library names
+   * @param search_paths_local list of local search paths in which to look for plugin libraries
+   */
+  inline void prefetchLibraryFiles(const LibraryCache& cache, const std::vector<std::string>& library_names,
+                                   const std::vector<std::string>& search_paths_local) const;
+
+  /**
+   * @brief Load the libraries which are not yet cached in parallel waves ordered by their dependencies
+   * @details The caller must hold the cache's mutex. The listeners are notified of the load of each library from the
+   * thread which loads it, so the returned libraries are adopted into the cache without notifying them again.
+   * @param cache The cache holding the libraries
+   * @param library_names list of library names
+   * @param search_paths_local list of local search paths in which to look for plugin libraries
+   * @return The loaded libraries by the paths from which they were loaded
+   */
+  inline std::unordered_map<std::string, LoadedLibrary::Ptr>
+  loadLibraryWavesLocked(const LibraryCache& cache, const std::vector<std::string>& library_names,
+                         const std::vector<std::string>& search_paths_local) const;
+
+  /**
+   * @brief Evict idle libraries in least-recently-used order until the cache is within budget
+   * @details The caller must hold libraries_mutex_ and the cache's mutex. If libraries are evicted from a cache shared
+   * with copies of this plugin loader, this plugin loader switches to a private copy of the cache first.
+   * @param cache_lock The lock of the cache, which is moved to the private copy
+   * @param min_last_used Libraries used at or after this value of the use counter are never evicted
+   * @param evict_all Evict all idle libraries if no budget is set
+   */
+  inline LibraryEvictionReport evictIdleLibrariesLocked(std::unique_lock<std::mutex>& cache_lock,
+                                                        std::uint64_t min_last_used, bool evict_all) const;
+
+  /**
+   * @brief Get the adaptive search order of libraries, computing it if the libraries changed or it is due to be updated
+   * @param libraries The libraries in search order
+   * @return The adaptive search order for the libraries
+   */
+  inline AdaptiveSearchOrder::ConstPtr getAdaptiveSearchOrder(const std::vector<LoadedLibrary::Ptr>& libraries) const;
+
+  /**
+   * @brief Find the library which provides a plugin, probing the libraries in adaptive search order
+   * @param plugin_name The plugin name
+   * @param libraries The libraries in search order
+   * @return The first library in search order which provides the plugin, or nullptr if none does
+   */
+  template <class PluginBase>
+  LoadedLibrary::Ptr findPluginLibraryAdaptive(const std::string& plugin_name,
+                                               const std::vector<LoadedLibrary::Ptr>& libraries) const;
+
+  /**
+   * @brief Create an instance of a plugin from a library which has it, notifying the listeners
+   * @param lib The library
+   * @param plugin_name The plugin name
+   * @param plugin The plugin object if it was already resolved, or nullptr to look up its symbol
+   * @return The plugin instance
+   */
+  template <class PluginBase>
+  std::shared_ptr<PluginBase> createInstanceAndNotify(const LoadedLibrary& lib, const std::string& plugin_name,
+                                                      PluginBase* plugin = nullptr) const;
+
+  /**
+   * @brief Get the set of the calling thread's cache of plugin resolutions which a plugin maps to
+   * @param type The plugin base type
+   * @param plugin_name The plugin name
+   * @return The set, whose entries may hold other plugins
+   */
+  inline ThreadCacheSet& getThreadCacheSet(const std::type_info& type, const std::string& plugin_name) const;
+
+  /**
+   * @brief Get a hash of the members which determine the library providing a plugin, to validate thread cache entries
+   * @details The names of the environment variables are hashed, but not their values. This is computed when the
+   * libraries are searched and kept in search_configuration_hash_.
+   */
+  inline std::size_t getSearchConfigurationHash() const;
+
+  /**
+   * @brief Find a plugin in the libraries and create an instance of it
+   * @param plugin_name The plugin name to find
+   * @param error Set to the reason the plugin instance could not be created, or SUCCESS
+   * @param library_names Set to the library names which were searched
+   * @param search_paths_local Set to the search paths which were searched
+   * @param libraries Set to the libraries which were loaded
+   * @return The plugin instance, or nullptr if it could not be created
+   */
+  template <class PluginBase>
+  std::shared_ptr<PluginBase> findAndCreateInstance(const std::string& plugin_name, PluginLoaderErrorCode& error,
+                                                    std::vector<std::string>& library_names,
+                                                    std::vector<std::string>& search_paths_local,
+                                                    std::vector<LoadedLibrary::Ptr>& libraries) const;
 
   template <typename PluginBase>
-  void reportErrorCommon(std::ostream& msg, const std::string& plugin_name, bool search_system_folders,
-                         const std::vector<std::string>& search_paths,
-                         const std::vector<std::string>& search_libraries) const;
+  static void reportErrorCommon(std::ostream& msg, const std::string& plugin_name, bool search_system_folders,
+                                const std::vector<std::string>& search_paths,
+                                const std::vector<std::string>& search_libraries);
 
   template <typename PluginBase>
-  typename std::enable_if_t<!has_getSection<PluginBase>::value, void>
+  static typename std::enable_if_t<!has_getSection<PluginBase>::value, void>
   reportError(std::ostream& msg, const std::string& plugin_name, bool search_system_folders,
-              const std::vector<std::string>& search_paths, const std::vector<std::string>& search_libraries) const;
+              const std::vector<std::string>& search_paths, const std::vector<std::string>& search_libraries,
+              const std::vector<LoadedLibrary::Ptr>& libraries);
 
   template <typename PluginBase>
-  typename std::enable_if_t<has_getSection<PluginBase>::value, void>
+  static typename std::enable_if_t<has_getSection<PluginBase>::value, void>
   reportError(std::ostream& msg, const std::string& plugin_name, bool search_system_folders,
-              const std::vector<std::string>& search_paths, const std::vector<std::string>& search_libraries) const;
+              const std::vector<std::string>& search_paths, const std::vector<std::string>& search_libraries,
+              const std::vector<LoadedLibrary::Ptr>& libraries);
 
   /**
    * @brief Checks if the library has the input symbol name, given that the plugin class does not define a section name
    */
   template <class ClassBase>
   typename std::enable_if<!has_getSection<ClassBase>::value, bool>::type
-  hasSymbol(const boost::dll::shared_library& lib, const std::string& symbol_name) const;
+  hasSymbol(const LoadedLibrary& lib, const std::string& symbol_name) const;
 
   /**
    * @brief Checks that the library has the input symbol name and that the symbol is associated with the section defined
    * in the plugin class.
    */
   template <class ClassBase>
-  typename std::enable_if<has_getSection<ClassBase>::value, bool>::type hasSymbol(const boost::dll::shared_library& lib,
+  typename std::enable_if<has_getSection<ClassBase>::value, bool>::type hasSymbol(const LoadedLibrary& lib,
                                                                                   const std::string& symbol_name) const;
 };
 
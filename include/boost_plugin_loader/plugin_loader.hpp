@@ -22,10 +22,24 @@
 // STD
 #include <sstream>
 #include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <optional>
+#include <string_view>
+#include <typeinfo>
+#include <unordered_set>
+#include <utility>
 
 // Boost
+#include <boost/container/small_vector.hpp>
+#include <boost/container_hash/hash.hpp>
 #include <boost/core/demangle.hpp>
 #include <boost/dll/import.hpp>
+#include <boost/filesystem/operations.hpp>
 #include <boost/version.hpp>
 
 // Boost Plugin Loader
@@ -63,16 +77,148 @@ static std::shared_ptr<ClassBase> createSharedInstance(const boost::dll::shared_
 #endif
 }
 
+/**
+ * @brief Create a shared instance for the provided symbol_name which shares ownership of the library handle
+ * @details Unlike the overload taking a library reference, this does not copy (i.e. re-open) the library. Each instance
+ * holds one reference to the library handle until it is destroyed, which is how the plugin loader counts the live
+ * instances of a library.
+ * @param lib The library to search for available symbols
+ * @param symbol_name The symbol from which to create a shared instance. This name is the alias provided to
+ * EXPORT_CLASS_SECTIONED
+ * @return A shared pointer of the object with the symbol name located in library_name
+ */
+template <class ClassBase>
+static std::shared_ptr<ClassBase> createSharedInstance(const std::shared_ptr<boost::dll::shared_library>& lib,
+                                                       const std::string& symbol_name)
+{
+  // Check if library has symbol
+  if (!lib->has(symbol_name))
+    throw PluginLoaderException("Failed to find symbol '" + symbol_name +
+                                "' in library: " + boost::dll::shared_library::decorate(lib->location()).string());
+
+  return std::shared_ptr<ClassBase>(&lib->get<ClassBase>(symbol_name),
+                                    [holder = lib](ClassBase*) mutable { holder.reset(); });
+}
+
+/**
+ * @brief Check that a plugin was exported for a base class, before its library is loaded
+ * @param base_type The type hash of the base class in the plugin record (see PluginRecord::base_type), or zero if the
+ * record does not identify it
+ * @param plugin_name The plugin name
+ * @param library_file The file of the library which provides the plugin
+ * @throws PluginLoaderException if the plugin was exported for another base class
+ */
+template <class ClassBase>
+static void checkBaseType(std::uint64_t base_type, const std::string& plugin_name, const std::string& library_file)
+{
+  if (base_type == 0 || base_type == getTypeHash<ClassBase>())
+    return;
+
+  throw PluginLoaderException("Plugin '" + plugin_name + "' in library '" + library_file +
+                              "' was not exported for base class '" + std::string(getTypeName<ClassBase>()) + "'");
+}
+
+/**
+ * @brief Check that a plugin was exported for a base class, before its object is used as an object of that class
+ * @param base_type The type hash of the base class in the plugin record (see PluginRecord::base_type), or zero if the
+ * record does not identify it
+ * @param plugin_name The plugin name
+ * @param lib The library which provides the plugin
+ * @throws PluginLoaderException if the plugin was exported for another base class
+ */
+template <class ClassBase>
+static void checkBaseType(std::uint64_t base_type, const std::string& plugin_name, const LoadedLibrary& lib)
+{
+  if (base_type == 0 || base_type == getTypeHash<ClassBase>())
+    return;
+
+  checkBaseType<ClassBase>(base_type, plugin_name, lib.library->location().string());
+}
+
+LoadedLibrary::~LoadedLibrary()
+{
+  if (!shadow_directory.empty())
+  {
+    // Plugin instances may still map the copy, which remains valid after it is removed
+    boost::system::error_code ec;
+    boost::filesystem::remove_all(shadow_directory, ec);
+  }
+}
+
+const LibraryIndex& LoadedLibrary::getIndex() const
+{
+  std::call_once(index_flag_, [this]() {
+    if (manifest != nullptr && !file.empty())
+    {
+      boost::system::error_code ec;
+      const std::uintmax_t file_size = boost::filesystem::file_size(file, ec);
+      std::optional<LibraryIndex> index = ec ? std::nullopt :
+                                               manifest->findIndex(file, file_size, getModificationTime(file));
+      if (index.has_value())
+      {
+        index_ = std::move(index.value());
+        return;
+      }
+    }
+
+    // Libraries described by a manifest are not loaded, so they have no index once their file changed
+    if (library == nullptr)
+      return;
+
+    // The plugin records of the library list its plugins without walking its symbol table
+    std::optional<LibraryIndex> index = indexPluginRecords(library->location().string());
+    index_ = index.has_value() ? std::move(index.value()) : indexLibrary(*library);
+  });
+  return index_;
+}
+
+LibraryCache::Ptr LibraryCache::clone() const
+{
+  auto copy = std::make_shared<LibraryCache>();
+  copy->libraries = libraries;
+  copy->library_files = library_files;
+  copy->use_counter = use_counter;
+  copy->last_used = last_used;
+  copy->resolutions = resolutions;
+  copy->resolved_search_paths = resolved_search_paths;
+  copy->resolved_search_system_folders = resolved_search_system_folders;
+  copy->changed_library_files = changed_library_files;
+  copy->directory_listings = directory_listings;
+  copy->discovery = discovery;
+  copy->manifest = manifest;
+  copy->manifest_libraries = manifest_libraries;
+  copy->manifest_check = manifest_check;
+  return copy;
+}
+
 PluginLoader::PluginLoader(const PluginLoader& other)
   : search_system_folders(other.search_system_folders)
   , search_paths(other.search_paths)
   , search_libraries(other.search_libraries)
   , search_paths_env(other.search_paths_env)
   , search_libraries_env(other.search_libraries_env)
+  , listeners(other.listeners)
+  , load_mode(other.load_mode)
+  , library_load_modes(other.library_load_modes)
+  , warm_page_cache(other.warm_page_cache)
+  , hot_libraries(other.hot_libraries)
+  , max_cached_libraries(other.max_cached_libraries)
+  , max_cached_library_bytes(other.max_cached_library_bytes)
+  , watch_libraries(other.watch_libraries)
+  , use_shared_registry(other.use_shared_registry)
+  , parallel_load(other.parallel_load)
+  , adaptive_search_order(other.adaptive_search_order)
+  , thread_local_cache(other.thread_local_cache)
+  , cache_directory_listings(other.cache_directory_listings)
+  , discovery_patterns(other.discovery_patterns)
+  , discovery_depth(other.discovery_depth)
 {
   std::scoped_lock lock{ libraries_mutex_, other.libraries_mutex_ };
   // NOLINTNEXTLINE(cppcoreguidelines-prefer-member-initializer)
-  libraries_ = other.libraries_;
+  cache_ = other.cache_;
+  // NOLINTNEXTLINE(cppcoreguidelines-prefer-member-initializer)
+  frozen_ = other.frozen_;
+  manifest_loaded_.store(other.manifest_loaded_.load());
 }
 
 PluginLoader& PluginLoader::operator=(const PluginLoader& other)
@@ -82,9 +228,27 @@ PluginLoader& PluginLoader::operator=(const PluginLoader& other)
   search_libraries = other.search_libraries;
   search_paths_env = other.search_paths_env;
   search_libraries_env = other.search_libraries_env;
+  listeners = other.listeners;
+  load_mode = other.load_mode;
+  library_load_modes = other.library_load_modes;
+  warm_page_cache = other.warm_page_cache;
+  hot_libraries = other.hot_libraries;
+  max_cached_libraries = other.max_cached_libraries;
+  max_cached_library_bytes = other.max_cached_library_bytes;
+  watch_libraries = other.watch_libraries;
+  use_shared_registry = other.use_shared_registry;
+  parallel_load = other.parallel_load;
+  adaptive_search_order = other.adaptive_search_order;
+  thread_local_cache = other.thread_local_cache;
+  cache_directory_listings = other.cache_directory_listings;
+  discovery_patterns = other.discovery_patterns;
+  discovery_depth = other.discovery_depth;
 
   std::scoped_lock lock{ libraries_mutex_, other.libraries_mutex_ };
-  libraries_ = other.libraries_;
+  cache_ = other.cache_;
+  frozen_ = other.frozen_;
+  manifest_loaded_.store(other.manifest_loaded_.load());
+  advanceLibraryCacheGeneration();
   return *this;
 }
 
@@ -94,10 +258,29 @@ PluginLoader::PluginLoader(PluginLoader&& other) noexcept
   , search_libraries(std::move(other.search_libraries))
   , search_paths_env(std::move(other.search_paths_env))
   , search_libraries_env(std::move(other.search_libraries_env))
+  , listeners(std::move(other.listeners))
+  , load_mode(other.load_mode)
+  , library_load_modes(std::move(other.library_load_modes))
+  , warm_page_cache(other.warm_page_cache)
+  , hot_libraries(std::move(other.hot_libraries))
+  , max_cached_libraries(other.max_cached_libraries)
+  , max_cached_library_bytes(other.max_cached_library_bytes)
+  , watch_libraries(other.watch_libraries)
+  , use_shared_registry(other.use_shared_registry)
+  , parallel_load(other.parallel_load)
+  , adaptive_search_order(other.adaptive_search_order)
+  , thread_local_cache(other.thread_local_cache)
+  , cache_directory_listings(other.cache_directory_listings)
+  , discovery_patterns(std::move(other.discovery_patterns))
+  , discovery_depth(other.discovery_depth)
 {
   std::scoped_lock lock{ libraries_mutex_, other.libraries_mutex_ };
   // NOLINTNEXTLINE(cppcoreguidelines-prefer-member-initializer)
-  libraries_ = std::move(other.libraries_);
+  cache_ = std::move(other.cache_);
+  // NOLINTNEXTLINE(cppcoreguidelines-prefer-member-initializer)
+  frozen_ = std::move(other.frozen_);
+  manifest_loaded_.store(other.manifest_loaded_.load());
+  advanceLibraryCacheGeneration();
 }
 
 PluginLoader& PluginLoader::operator=(PluginLoader&& other) noexcept
@@ -107,17 +290,35 @@ PluginLoader& PluginLoader::operator=(PluginLoader&& other) noexcept
   search_libraries = std::move(other.search_libraries);
   search_paths_env = std::move(other.search_paths_env);
   search_libraries_env = std::move(other.search_libraries_env);
+  listeners = std::move(other.listeners);
+  load_mode = other.load_mode;
+  library_load_modes = std::move(other.library_load_modes);
+  warm_page_cache = other.warm_page_cache;
+  hot_libraries = std::move(other.hot_libraries);
+  max_cached_libraries = other.max_cached_libraries;
+  max_cached_library_bytes = other.max_cached_library_bytes;
+  watch_libraries = other.watch_libraries;
+  use_shared_registry = other.use_shared_registry;
+  parallel_load = other.parallel_load;
+  adaptive_search_order = other.adaptive_search_order;
+  thread_local_cache = other.thread_local_cache;
+  cache_directory_listings = other.cache_directory_listings;
+  discovery_patterns = std::move(other.discovery_patterns);
+  discovery_depth = other.discovery_depth;
 
   std::scoped_lock lock{ libraries_mutex_, other.libraries_mutex_ };
-  libraries_ = std::move(other.libraries_);
+  cache_ = std::move(other.cache_);
+  frozen_ = std::move(other.frozen_);
+  manifest_loaded_.store(other.manifest_loaded_.load());
+  advanceLibraryCacheGeneration();
   return *this;
 }
 
 template <class ClassBase>
 typename std::enable_if<!has_getSection<ClassBase>::value, bool>::type
-PluginLoader::hasSymbol(const boost::dll::shared_library& lib, const std::string& symbol_name) const
+PluginLoader::hasSymbol(const LoadedLibrary& lib, const std::string& symbol_name) const
 {
-  return lib.has(symbol_name);
+  return lib.library->has(symbol_name);
 }
 
 /**
@@ -126,11 +327,146 @@ PluginLoader::hasSymbol(const boost::dll::shared_library& lib, const std::string
  */
 template <class ClassBase>
 typename std::enable_if<has_getSection<ClassBase>::value, bool>::type
-PluginLoader::hasSymbol(const boost::dll::shared_library& lib, const std::string& symbol_name) const
+PluginLoader::hasSymbol(const LoadedLibrary& lib, const std::string& symbol_name) const
+{
+  const std::string section = ClassBase::getSection();
+  const LibraryIndex& index = lib.getIndex();
+  const std::vector<std::string>* symbols = index.findSymbols(section);
+  if (symbols != nullptr)
+  {
+    if (std::find(symbols->begin(), symbols->end(), symbol_name) == symbols->end())
+      return false;
+
+    checkBaseType<ClassBase>(index.findBaseType(section, symbol_name), symbol_name, lib);
+    return true;
+  }
+
+  // Symbols under hidden sections are not indexed
+  const std::vector<std::string> hidden_symbols = getAllAvailableSymbols(*lib.library, section);
+  return std::find(hidden_symbols.begin(), hidden_symbols.end(), symbol_name) != hidden_symbols.end();
+}
+
+/**
+ * @brief Attempt to load a library, notifying the listeners of the start and end of the load
+ * @param library_path The library path passed to loadLibrary
+ * @param mode The mode passed to loadLibrary
+ * @param listeners The listeners to notify
+ * @return The loaded library, or nullptr if it could not be loaded
+ */
+static LoadedLibrary::Ptr loadLibraryAndNotify(const boost::filesystem::path& library_path,
+                                               boost::dll::load_mode::type mode,
+                                               const std::vector<PluginLoaderListener::Ptr>& listeners)
+{
+  PluginLoaderEvent event;
+  if (!listeners.empty())
+  {
+    event.type = PluginLoaderEventType::LIBRARY_LOAD_START;
+    event.library = library_path.string();
+    for (const auto& listener : listeners)
+      listener->onLibraryLoadStart(event);
+  }
+
+  std::optional<boost::dll::shared_library> lib = loadLibrary(library_path, mode);
+
+  LoadedLibrary::Ptr loaded;
+  if (lib.has_value())
+  {
+    loaded = std::make_shared<LoadedLibrary>();
+    boost::system::error_code ec;
+    loaded->size = boost::filesystem::file_size(lib->location(ec), ec);
+    if (ec)
+      loaded->size = 0;
+    loaded->library = std::make_shared<boost::dll::shared_library>(std::move(lib.value()));
+  }
+
+  if (!listeners.empty())
+  {
+    event.type = PluginLoaderEventType::LIBRARY_LOAD_END;
+    event.success = (loaded != nullptr);
+    event.duration = PluginLoaderEvent::Clock::now() - event.timestamp;
+    for (const auto& listener : listeners)
+      listener->onLibraryLoadEnd(event);
+  }
+
+  return loaded;
+}
+
+/**
+ * @brief Find the file which would be loaded for a library path
+ * @details As in loadLibrary, the decorated path is tried before the path itself. Paths without a parent path are
+ * searched for in system folders by the dynamic loader, so their file cannot be found before they are loaded.
+ * @param library_path The library path passed to loadLibrary
+ * @return The canonical path of the library file, or an empty string if it was not found
+ */
+static std::string findLibraryFile(const boost::filesystem::path& library_path)
+{
+  if (!library_path.has_parent_path())
+    return {};
+
+  for (const boost::filesystem::path& candidate :
+       { boost::dll::shared_library::decorate(library_path), library_path })
+  {
+    boost::system::error_code ec;
+    const boost::filesystem::path file = boost::filesystem::canonical(candidate, ec);
+    if (!ec && boost::filesystem::is_regular_file(file, ec))
+      return file.string();
+  }
+
+  return {};
+}
+
+/**
+ * @brief Append the symbols under a section of a library
+ * @param lib The library
+ * @param section The section
+ * @param symbols The list to which the symbols are appended
+ */
+inline void appendLibrarySymbols(const LoadedLibrary& lib, const std::string& section,
+                                 std::vector<std::string>& symbols)
 {
-  std::vector<std::string> symbols = getAllAvailableSymbols(lib, ClassBase::getSection());
-  std::sort(symbols.begin(), symbols.end());
-  return std::find(symbols.begin(), symbols.end(), symbol_name) != symbols.end();
+  const std::vector<std::string>* indexed_symbols = lib.getIndex().findSymbols(section);
+  if (indexed_symbols != nullptr)
+  {
+    symbols.insert(symbols.end(), indexed_symbols->begin(), indexed_symbols->end());
+    return;
+  }
+
+  // Symbols under hidden sections are not indexed
+  std::vector<std::string> hidden_symbols = getAllAvailableSymbols(*lib.library, section);
+  symbols.insert(symbols.end(), hidden_symbols.begin(), hidden_symbols.end());
+}
+
+/**
+ * @brief Notify the listeners of a failure
+ * @param listeners The listeners to notify
+ * @param plugin_name The name of the plugin associated with the failure
+ * @param error The reason for the failure
+ * @param exception The exception which is thrown to the caller, if any
+ */
+static void notifyFailure(const std::vector<PluginLoaderListener::Ptr>& listeners, const std::string& plugin_name,
+                          PluginLoaderErrorCode error, std::exception_ptr exception = nullptr)
+{
+  PluginLoaderEvent event;
+  event.type = PluginLoaderEventType::FAILURE;
+  event.plugin = plugin_name;
+  event.message = toString(error);
+  event.exception = std::move(exception);
+  for (const auto& listener : listeners)
+    listener->onFailure(event);
+}
+
+/**
+ * @brief Read the value of an environment variable
+ * @param name The name of the environment variable, which may be empty
+ * @return The value, or nothing if the name is empty or the variable is not set
+ */
+static std::optional<std::string> readEnvironmentVariable(const std::string& name)
+{
+  const char* value = name.empty() ? nullptr : std::getenv(name.c_str());
+  if (value == nullptr)
+    return std::nullopt;
+
+  return std::string(value);
 }
 
 /**
@@ -139,260 +475,1600 @@ PluginLoader::hasSymbol(const boost::dll::shared_library& lib, const std::string
  * If the provided library name is not an absolute path, then this function searches for the library in each of the
  * provided local search paths. If the provided library name is not an absolute path and does not exist in the local
  * search paths, then this function optionally searches for the library in system directories.
+ * Each library is loaded with its entry in library_load_modes, or load_mode if it has none.
  * @param library_names list of library names
  * @param search_paths_local list of local search paths in which to look for plugin libraries
- * @param search_system_folders flag indicating whether to look for plugins in system level folders
- * @return list of libraries with the specified input names that could be found in the specified input directories.
- * Libraries specified with absolute paths will be returned first in the list before libraries found in local paths (but
- * in no particular order in at the front of the list).
+ * @param libraries Set to the list of libraries with the specified input names that could be found in the specified
+ * input directories. Libraries specified with absolute paths will be returned first in the list before libraries found
+ * in local paths (but in no particular order in at the front of the list). Each library is listed once, even if several
+ * names lead to its file.
  */
-static std::vector<boost::dll::shared_library>
-loadLibraries(const std::vector<std::string>& library_names, const std::vector<std::string>& search_paths_local,
-              const bool search_system_folders, std::unordered_map<std::string, boost::dll::shared_library>& cache)
+template <class LibraryContainer>
+void PluginLoader::loadLibraries(const std::vector<std::string>& library_names,
+                                 const std::vector<std::string>& search_paths_local, LibraryContainer& libraries) const
 {
-  std::vector<boost::dll::shared_library> libraries;
-  libraries.reserve(library_names.size());
+  loadLibrariesUntil(library_names, search_paths_local, libraries,
+                     [](const LoadedLibrary::Ptr& /*lib*/) { return false; });
+}
 
-  // Loop over each provided library name
-  for (const std::string& library_name : library_names)
+template <class LibraryContainer, class StopPredicate>
+void PluginLoader::loadLibrariesUntil(const std::vector<std::string>& listed_library_names,
+                                      const std::vector<std::string>& search_paths_local, LibraryContainer& libraries,
+                                      StopPredicate&& stop, bool configured,
+                                      const std::function<void(const std::string& file)>& check_file) const
+{
+  libraries.clear();
+  libraries.reserve(listed_library_names.size());
+
+  const std::unique_lock<std::mutex> lock = lockAndRecordWait(libraries_mutex_);
+  getCacheLocked();
+
+  // A cache shared with copies of this plugin loader is resolved against a single search configuration, so switch to a
+  // private copy of the cache when the search configuration of this plugin loader diverges from it
+  std::unique_lock<std::mutex> cache_lock = lockAndRecordWait(cache_->mutex);
+  if (search_paths_local != cache_->resolved_search_paths ||
+      search_system_folders != cache_->resolved_search_system_folders)
+    detachCacheLocked(cache_lock);
+
+  LibraryCache& cache = *cache_;
+  const std::uint64_t use_counter = ++cache.use_counter;
+
+  // Hash the search configuration once per search rather than on each thread cache hit
+  if (thread_local_cache)
+    search_configuration_hash_.store(getSearchConfigurationHash(), std::memory_order_relaxed);
+
+  // Add the libraries discovered in the search paths, which are named by their absolute paths
+  std::vector<std::string> discovered_library_names;
+  const bool discover = configured && !discovery_patterns.empty();
+  if (discover)
   {
-    std::optional<boost::dll::shared_library> lib = std::nullopt;
-    // First check if the library name is actually a complete, absolute path where the library is located
+    discovered_library_names = listed_library_names;
+    for (const std::string& file : discoverLibrariesLocked(cache, search_paths_local))
     {
-      const boost::filesystem::path library_path(library_name);
+      if (std::find(listed_library_names.begin(), listed_library_names.end(), file) == listed_library_names.end())
+        discovered_library_names.push_back(file);
+    }
+  }
+  const std::vector<std::string>& library_names = discover ? discovered_library_names : listed_library_names;
 
-      if (boost::filesystem::exists(library_path) && library_path.is_absolute())
-      {
-        auto it = cache.find(library_path.string());
-        lib = (it != cache.end()) ? it->second : loadLibrary(library_path);
+  const bool watch = watch_libraries && LibraryWatcher::isSupported();
+  if (watch)
+    processLibraryChangesLocked(cache, search_paths_local);
 
-        // If the library exists, add it to the output list and continue to the next library name
-        if (lib.has_value())
-        {
-          // Libraries specified as absolute paths should appear first in the output list, so insert them at the front
-          // of the list
-          libraries.insert(libraries.begin(), lib.value());
+  // Record the file of a library loaded while watching for changes and watch its directory. If the file changed while
+  // an older version was loaded, the dynamic loader returns the older version, so load a copy of the file instead.
+  auto watch_library = [&](LoadedLibrary::Ptr lib, boost::dll::load_mode::type mode) -> LoadedLibrary::Ptr {
+    boost::system::error_code ec;
+    const boost::filesystem::path file = boost::filesystem::canonical(lib->library->location(ec), ec);
+    if (ec)
+      return lib;
 
-          // Add to cache if it did not exist
-          if (it == cache.end())
-            cache[library_path.string()] = lib.value();
+    cache.watcher->watchDirectory(file.parent_path().string());
+    lib->file = file.string();
+    if (std::find(cache.changed_library_files.begin(), cache.changed_library_files.end(), lib->file) ==
+        cache.changed_library_files.end())
+      return lib;
 
-          continue;
-        }
-      }
+    const boost::filesystem::path shadow_directory =
+        boost::filesystem::temp_directory_path(ec) / boost::filesystem::unique_path("boost_plugin_loader_%%%%%%%%", ec);
+    if (ec || !boost::filesystem::create_directories(shadow_directory, ec))
+      return lib;
+
+    const boost::filesystem::path shadow_file = shadow_directory / file.filename();
+    boost::filesystem::copy_file(file, shadow_file, ec);
+    LoadedLibrary::Ptr shadow_lib = ec ? nullptr : loadLibraryAndNotify(shadow_file, mode, listeners);
+    if (shadow_lib == nullptr)
+    {
+      boost::filesystem::remove_all(shadow_directory, ec);
+      return lib;
     }
 
-    // If the library name is not an absolute path, try finding the library at the path defined as the combination of
-    // each local search path and the library name
-    for (const std::string& search_path : search_paths_local)
+    shadow_lib->name = lib->name;
+    shadow_lib->file = file.string();
+    shadow_lib->shadow_directory = shadow_directory;
+    return shadow_lib;
+  };
+
+  // Find a library loaded by another plugin loader in the registry, unless an older version of it may be loaded
+  auto find_registered_library = [&](const std::string& file) -> LoadedLibrary::Ptr {
+    if (file.empty() || std::find(cache.changed_library_files.begin(), cache.changed_library_files.end(), file) !=
+                            cache.changed_library_files.end())
+      return nullptr;
+
+    LoadedLibrary::Ptr lib = LibraryRegistry::instance().find(file);
+    if (lib != nullptr && watch)
+      cache.watcher->watchDirectory(boost::filesystem::path(file).parent_path().string());
+
+    return lib;
+  };
+
+  // Find the cache entry of a library file reached through another path, setting the key to the key of the entry
+  auto find_cached_file = [&](const std::string& file, std::string& key) -> LoadedLibrary::Ptr {
+    if (file.empty())
+      return nullptr;
+
+    auto file_it = cache.library_files.find(file);
+    if (file_it == cache.library_files.end())
+      return nullptr;
+
+    auto it = cache.libraries.find(file_it->second);
+    if (it == cache.libraries.end() || it->second->file != file)
     {
-      const boost::filesystem::path library_path = boost::filesystem::path(search_path) / library_name;
+      cache.library_files.erase(file_it);
+      return nullptr;
+    }
 
-      auto it = cache.find(library_path.string());
-      lib = (it != cache.end()) ? it->second : loadLibrary(library_path);
+    key = it->first;
+    cache.last_used[key] = use_counter;
+    return it->second;
+  };
 
-      // If the library exists at this path, add the library to the output list and break out of the loop
-      if (lib.has_value())
-      {
-        libraries.push_back(lib.value());
+  // Register a library loaded by this plugin loader, or use the library registered for the same file in the meantime
+  auto register_library = [&](LoadedLibrary::Ptr lib) -> LoadedLibrary::Ptr {
+    if (lib->file.empty())
+      return lib;
 
-        // Add to cache if it did not exist
-        if (it == cache.end())
-          cache[library_path.string()] = lib.value();
+    return LibraryRegistry::instance().insert(lib->file, lib);
+  };
 
-        break;
-      }
+  // The libraries loaded in waves by their paths, which are adopted into the cache below
+  std::unordered_map<std::string, LoadedLibrary::Ptr> wave_libraries;
+
+  // Get a library from the cache or load it, adding it to the cache if it could be loaded. The key is set to the key of
+  // the cache entry, which belongs to another path if the library file was already loaded through that path.
+  auto get_library = [&](const std::string& library_name, const boost::filesystem::path& library_path,
+                         boost::dll::load_mode::type mode, bool hot, std::string& key) -> LoadedLibrary::Ptr {
+    key = library_path.string();
+    auto it = cache.libraries.find(key);
+    if (it != cache.libraries.end())
+    {
+      cache.last_used[key] = use_counter;
+      return it->second;
     }
 
-    // If the library cannot be found in any of the local search paths, search in the system level directories for the
-    // library (if enabled)
-    if (lib == std::nullopt && search_system_folders)
+    // Libraries found in system folders are only located once the dynamic loader has loaded them
+    const std::string file = findLibraryFile(library_path);
+    LoadedLibrary::Ptr lib = find_cached_file(file, key);
+    if (lib != nullptr)
+      return lib;
+
+    if (use_shared_registry)
+      lib = find_registered_library(file);
+
+    if (lib == nullptr)
     {
-      auto it = cache.find(library_name);
-      lib = (it != cache.end()) ? it->second : loadLibrary(library_name);
+      // Adopt the library loaded in a wave, whose listeners were already notified
+      auto wave_it = wave_libraries.find(key);
+      if (wave_it != wave_libraries.end())
+      {
+        lib = std::move(wave_it->second);
+        wave_libraries.erase(wave_it);
+      }
+      else
+      {
+        if (check_file && !file.empty())
+          check_file(file);
 
-      // Add the library to the output list, and break out of the loop
-      if (lib.has_value())
+        lib = loadLibraryAndNotify(library_path, mode, listeners);
+      }
+
+      if (lib != nullptr)
+      {
+        lib->name = library_name;
+        lib->file = file;
+        lib->manifest = cache.manifest;
+      }
+
+      if (lib != nullptr && watch)
+        lib = watch_library(std::move(lib), mode);
+
+      if (lib != nullptr && lib->file.empty())
       {
-        libraries.push_back(lib.value());
+        boost::system::error_code ec;
+        const boost::filesystem::path location = boost::filesystem::canonical(lib->library->location(ec), ec);
+        if (!ec)
+          lib->file = location.string();
 
-        // Add to cache if it did not exist
-        if (it == cache.end())
-          cache[library_name] = lib.value();
+        LoadedLibrary::Ptr cached_lib = find_cached_file(lib->file, key);
+        if (cached_lib != nullptr)
+          return cached_lib;
       }
+
+      // Libraries loaded from a copy are specific to this cache
+      if (lib != nullptr && use_shared_registry && lib->shadow_directory.empty())
+        lib = register_library(std::move(lib));
     }
-  }
 
-  return libraries;
-}
+    if (lib != nullptr)
+    {
+      if (hot)
+        prefaultLibrary(*lib->library);
 
-template <typename PluginBase>
-void PluginLoader::reportErrorCommon(std::ostream& msg, const std::string& plugin_name, bool search_system_folders,
-                                     const std::vector<std::string>& search_paths,
-                                     const std::vector<std::string>& search_libraries) const
-{
-  const std::string plugin_base_type = boost::core::demangle(typeid(PluginBase).name());
-  msg << "Failed to create plugin instance '" << plugin_name << "' of type '" << plugin_base_type << "'\n";
-  msg << "Search Paths " << std::string(search_system_folders ? "(including " : "(not including ")
-      << "system folders)\n";
+      cache.libraries.emplace(key, lib);
+      cache.last_used[key] = use_counter;
+      if (!lib->file.empty())
+        cache.library_files[lib->file] = key;
 
-  for (const auto& path : search_paths)
-    msg << "    - " << path << "\n";
+      advanceLibraryCacheGeneration();
+    }
+    return lib;
+  };
 
-  msg << "Search Libraries:\n";
-  for (const auto& library : search_libraries)
-    msg << "    - " << decorate(library) << "\n";
-}
+  // Drop the resolutions which may be affected by changes to the search paths
+  if (search_paths_local != cache.resolved_search_paths ||
+      search_system_folders != cache.resolved_search_system_folders)
+    updateResolutionsLocked(cache, search_paths_local);
 
-template <typename PluginBase>
-typename std::enable_if_t<!has_getSection<PluginBase>::value, void>
-PluginLoader::reportError(std::ostream& msg, const std::string& plugin_name, bool search_system_folders,
-                          const std::vector<std::string>& search_paths,
-                          const std::vector<std::string>& search_libraries) const
-{
-  return reportErrorCommon<PluginBase>(msg, plugin_name, search_system_folders, search_paths, search_libraries);
-}
+  // Drop the resolutions of library names which were removed, unless they may be used by copies of this plugin loader
+  if (configured && cache_.use_count() == 1 && cache.resolutions.size() > library_names.size())
+  {
+    const std::unordered_set<std::string> names(library_names.begin(), library_names.end());
+    for (auto it = cache.resolutions.begin(); it != cache.resolutions.end();)
+      it = (names.count(it->first) == 0) ? cache.resolutions.erase(it) : std::next(it);
 
-template <typename PluginBase>
-typename std::enable_if_t<has_getSection<PluginBase>::value, void>
-PluginLoader::reportError(std::ostream& msg, const std::string& plugin_name, bool search_system_folders,
-                          const std::vector<std::string>& search_paths,
-                          const std::vector<std::string>& search_libraries) const
-{
-  reportErrorCommon<PluginBase>(msg, plugin_name, search_system_folders, search_paths, search_libraries);
+    advanceLibraryCacheGeneration();
+  }
 
-  // Add information about the available plugins
-  const std::string plugin_base_type = boost::core::demangle(typeid(PluginBase).name());
-  auto plugins = getAvailablePlugins(PluginBase::getSection());
-  msg << "Available plugins of type '" << plugin_base_type << "':\n";
-  for (const auto& p : plugins)
-    msg << "    - " << p << "\n";
-}
+  if (warm_page_cache)
+    prefetchLibraryFiles(cache, library_names, search_paths_local);
 
-template <class PluginBase>
-std::shared_ptr<PluginBase> PluginLoader::createInstance(const std::string& plugin_name) const
-{
-  // Check for environment variable for plugin definitions
-  const std::vector<std::string> library_names = getAllLibraryNames(search_libraries_env, search_libraries);
-  if (library_names.empty())
-    throw PluginLoaderException("No plugin libraries were provided!");
+  if (parallel_load)
+    wave_libraries = loadLibraryWavesLocked(cache, library_names, search_paths_local);
 
-  // Check for environment variable for search paths
-  const std::vector<std::string> search_paths_local = getAllSearchPaths(search_paths_env, search_paths);
+  // Check if the directory of a search path has a file for a library name, listing it again if it changed
+  auto is_listed = [&](const std::string& search_path, const std::string& library_name) {
+    const boost::filesystem::path library_path = boost::filesystem::path(search_path) / library_name;
+    const std::string directory = library_path.parent_path().string();
+    CachedDirectoryListing& cached = cache.directory_listings[directory];
+    if (cached.checked != use_counter)
+    {
+      if (cached.checked == 0 || cached.listing.modified < 0 ||
+          getModificationTime(directory) != cached.listing.modified)
+        cached.listing = listDirectory(directory);
 
-  // Load the libraries
-  const std::vector<boost::dll::shared_library> libraries = [&]() {
-    std::scoped_lock lock(libraries_mutex_);
-    return loadLibraries(library_names, search_paths_local, search_system_folders, libraries_);
-  }();
+      cached.checked = use_counter;
+    }
 
-  // Create an instance of the plugin
-  for (const auto& lib : libraries)
-  {
-    if (hasSymbol<PluginBase>(lib, plugin_name))
-      return createSharedInstance<PluginBase>(lib, plugin_name);
-  }
+    const boost::filesystem::path file_name = library_path.filename();
+    return cached.listing.entries.count(boost::dll::shared_library::decorate(file_name).string()) > 0 ||
+           cached.listing.entries.count(file_name.string()) > 0;
+  };
 
-  std::stringstream msg;
-  reportError<PluginBase>(msg, plugin_name, search_system_folders, search_paths_local, library_names);
-  throw PluginLoaderException(msg.str());
-}
+  // Find the library for a library name, either only as an absolute path or only in the search paths and system folders
+  auto find_library = [&](const std::string& library_name, bool absolute) -> LoadedLibrary::Ptr {
+    // Use the previous resolution of the library name if its cache entry still exists
+    auto resolution_it = cache.resolutions.find(library_name);
+    if (resolution_it != cache.resolutions.end())
+    {
+      auto it = cache.libraries.find(resolution_it->second.key);
+      if (it != cache.libraries.end())
+      {
+        if (absolute != (resolution_it->second.search_path_index == LibraryResolution::absolute))
+          return nullptr;
 
-bool PluginLoader::isPluginAvailable(const std::string& plugin_name) const
-{
-  // Check for environment variable for plugin definitions
-  const std::vector<std::string> library_names = getAllLibraryNames(search_libraries_env, search_libraries);
-  if (library_names.empty())
-    throw PluginLoaderException("No plugin libraries were provided!");
+        cache.last_used[it->first] = use_counter;
+        return it->second;
+      }
 
-  // Check for environment variable for search paths
-  const std::vector<std::string> search_paths_local = getAllSearchPaths(search_paths_env, search_paths);
+      cache.resolutions.erase(resolution_it);
+    }
 
-  // Load the libraries
-  const std::vector<boost::dll::shared_library> libraries = [&]() {
-    std::scoped_lock lock(libraries_mutex_);
-    return loadLibraries(library_names, search_paths_local, search_system_folders, libraries_);
-  }();
+    const auto mode_it = library_load_modes.find(library_name);
+    const boost::dll::load_mode::type mode = (mode_it != library_load_modes.end()) ? mode_it->second : load_mode;
+    const bool hot = std::find(hot_libraries.begin(), hot_libraries.end(), library_name) != hot_libraries.end();
 
-  // Check for the symbol name
-  return std::any_of(libraries.begin(), libraries.end(), [&](const auto& lib) { return lib.has(plugin_name); });
-}
+    // Check if the library name is actually a complete, absolute path where the library is located
+    if (absolute)
+    {
+      const boost::filesystem::path library_path(library_name);
+      if (!boost::filesystem::exists(library_path))
+        return nullptr;
 
-template <class PluginBase>
-typename std::enable_if_t<has_getSection<PluginBase>::value, std::vector<std::string>>
-PluginLoader::getAvailablePlugins() const
-{
-  return getAvailablePlugins(PluginBase::getSection());
-}
+      std::string key;
+      LoadedLibrary::Ptr lib = get_library(library_name, library_path, mode, hot, key);
+      if (lib != nullptr)
+        cache.resolutions[library_name] = { key, LibraryResolution::absolute };
+      return lib;
+    }
 
-std::vector<std::string> PluginLoader::getAvailablePlugins(const std::string& section) const
-{
-  // Check for environment variable for plugin definitions
-  const std::vector<std::string> library_names = getAllLibraryNames(search_libraries_env, search_libraries);
-  if (library_names.empty())
-    throw PluginLoaderException("No plugin libraries were provided!");
+    // Try finding the library at the path defined as the combination of each local search path and the library name
+    for (std::size_t i = 0; i < search_paths_local.size(); ++i)
+    {
+      if (cache_directory_listings && !is_listed(search_paths_local[i], library_name))
+        continue;
 
-  // Check for environment variable for search paths
-  const std::vector<std::string> search_paths_local = getAllSearchPaths(search_paths_env, search_paths);
+      const boost::filesystem::path library_path = boost::filesystem::path(search_paths_local[i]) / library_name;
+      std::string key;
+      LoadedLibrary::Ptr lib = get_library(library_name, library_path, mode, hot, key);
+      if (lib != nullptr)
+      {
+        cache.resolutions[library_name] = { key, i };
+        return lib;
+      }
+    }
 
-  // Load the libraries
-  const std::vector<boost::dll::shared_library> libraries = [&]() {
-    std::scoped_lock lock(libraries_mutex_);
-    return loadLibraries(library_names, search_paths_local, search_system_folders, libraries_);
-  }();
+    // If the library cannot be found in any of the local search paths, search in the system level directories for the
+    // library (if enabled)
+    if (!search_system_folders)
+      return nullptr;
 
-  // Populate the list of plugins
-  std::vector<std::string> plugins;
-  for (const auto& lib : libraries)
+    std::string key;
+    LoadedLibrary::Ptr lib = get_library(library_name, library_name, mode, hot, key);
+    if (lib != nullptr)
+      cache.resolutions[library_name] = { key, LibraryResolution::system };
+    return lib;
+  };
+
+  // The libraries loaded in waves are all cached, even if the search stops before them
+  const bool load_all = !wave_libraries.empty();
+  bool stopped = false;
+
+  // Libraries specified as absolute paths should appear first in the output list, the last one listed first. Library
+  // names which resolve to the same library are listed once.
+  for (auto it = library_names.rbegin(); it != library_names.rend() && (!stopped || load_all); ++it)
+  {
+    if (!boost::filesystem::path(*it).is_absolute())
+      continue;
+
+    LoadedLibrary::Ptr lib = find_library(*it, true);
+    if (lib != nullptr && !stopped && std::find(libraries.begin(), libraries.end(), lib) == libraries.end())
+    {
+      libraries.push_back(lib);
+      stopped = stop(libraries.back());
+    }
+  }
+
+  // Then the libraries found in the search paths and system folders follow in the order in which they are listed
+  for (auto it = library_names.begin(); it != library_names.end() && (!stopped || load_all); ++it)
   {
-    std::vector<std::string> lib_plugins = getAllAvailableSymbols(lib, section);
-    plugins.insert(plugins.end(), lib_plugins.begin(), lib_plugins.end());
+    LoadedLibrary::Ptr lib = find_library(*it, false);
+    if (lib != nullptr && !stopped && std::find(libraries.begin(), libraries.end(), lib) == libraries.end())
+    {
+      libraries.push_back(lib);
+      stopped = stop(libraries.back());
+    }
   }
 
-  return plugins;
+  // Enforce the cache budget, without evicting the libraries used by this call
+  if (max_cached_libraries > 0 || max_cached_library_bytes > 0)
+    evictIdleLibrariesLocked(cache_lock, use_counter, false);
 }
 
-std::vector<std::string> PluginLoader::getAvailableSections(bool include_hidden) const
+std::vector<LoadedLibrary::Ptr> PluginLoader::loadLibraries(const std::vector<std::string>& library_names,
+                                                            const std::vector<std::string>& search_paths_local) const
 {
-  // Check for environment variable for plugin definitions
-  const std::vector<std::string> library_names = getAllLibraryNames(search_libraries_env, search_libraries);
-  if (library_names.empty())
-    throw PluginLoaderException("No plugin libraries were provided!");
-
-  // Check for environment variable for search paths
-  const std::vector<std::string> search_paths_local = getAllSearchPaths(search_paths_env, search_paths);
+  std::vector<LoadedLibrary::Ptr> libraries;
+  loadLibraries(library_names, search_paths_local, libraries);
+  return libraries;
+}
 
-  // Load the libraries
-  const std::vector<boost::dll::shared_library> libraries = [&]() {
-    std::scoped_lock lock(libraries_mutex_);
-    return loadLibraries(library_names, search_paths_local, search_system_folders, libraries_);
-  }();
+const std::vector<std::string>&
+PluginLoader::discoverLibrariesLocked(LibraryCache& cache, const std::vector<std::string>& search_paths_local) const
+{
+  CachedLibraryDiscovery& discovery = cache.discovery;
+  bool current = (discovery.search_paths == search_paths_local && discovery.patterns == discovery_patterns &&
+                  discovery.depth == discovery_depth);
+  for (auto it = discovery.result.directories.begin(); it != discovery.result.directories.end() && current; ++it)
+    current = (it->second >= 0 && getModificationTime(it->first) == it->second);
 
-  // Populate the list of sections
-  std::vector<std::string> sections;
-  for (const auto& lib : libraries)
+  if (!current)
   {
-    std::vector<std::string> lib_sections = getAllAvailableSections(lib, include_hidden);
-    sections.insert(sections.end(), lib_sections.begin(), lib_sections.end());
+    discovery.search_paths = search_paths_local;
+    discovery.patterns = discovery_patterns;
+    discovery.depth = discovery_depth;
+    discovery.result = discoverLibraries(search_paths_local, discovery_patterns, discovery_depth);
   }
 
-  return sections;
+  return discovery.result.files;
 }
 
-int PluginLoader::count() const
+void PluginLoader::updateResolutionsLocked(LibraryCache& cache,
+                                           const std::vector<std::string>& search_paths_local) const
 {
-  return static_cast<int>(getAllLibraryNames(search_libraries_env, search_libraries).size());
-}
+  // The number of leading search paths which are unchanged
+  const auto mismatch = std::mismatch(cache.resolved_search_paths.begin(), cache.resolved_search_paths.end(),
+                                      search_paths_local.begin(), search_paths_local.end());
+  const auto unchanged = static_cast<std::size_t>(std::distance(cache.resolved_search_paths.begin(), mismatch.first));
 
-bool PluginLoader::empty() const
+  // Libraries found in system folders may now be found in a search path (or must no longer be searched for), while
+  // libraries found in a search path are only affected by changes to that path or the ones before it
+  for (auto it = cache.resolutions.begin(); it != cache.resolutions.end();)
+  {
+    const std::size_t index = it->second.search_path_index;
+    const bool keep =
+        (index == LibraryResolution::absolute) || (index != LibraryResolution::system && index < unchanged);
+    it = keep ? std::next(it) : cache.resolutions.erase(it);
+  }
+
+  cache.resolved_search_paths = search_paths_local;
+  cache.resolved_search_system_folders = search_system_folders;
+  advanceLibraryCacheGeneration();
+}
+
+void PluginLoader::processLibraryChangesLocked(LibraryCache& cache,
+                                               const std::vector<std::string>& search_paths_local) const
+{
+  if (cache.watcher == nullptr)
+    cache.watcher = std::make_shared<LibraryWatcher>();
+
+  for (const std::string& search_path : search_paths_local)
+    cache.watcher->watchDirectory(search_path);
+
+  const LibraryChanges changes = cache.watcher->poll();
+  if (changes.empty())
+    return;
+
+  for (auto it = cache.libraries.begin(); it != cache.libraries.end();)
+  {
+    const LoadedLibrary& lib = *it->second;
+    if (lib.file.empty() || !changes.isChanged(lib.file))
+    {
+      ++it;
+      continue;
+    }
+
+    if (std::find(cache.changed_library_files.begin(), cache.changed_library_files.end(), lib.file) ==
+        cache.changed_library_files.end())
+      cache.changed_library_files.push_back(lib.file);
+
+    if (!listeners.empty())
+    {
+      PluginLoaderEvent event;
+      event.type = PluginLoaderEventType::LIBRARY_EVICTED;
+      event.library = it->first;
+      event.message = "Library file changed: " + lib.file;
+      for (const auto& listener : listeners)
+        listener->onLibraryEvicted(event);
+    }
+
+    cache.last_used.erase(it->first);
+    it = cache.libraries.erase(it);
+    advanceLibraryCacheGeneration();
+  }
+}
+
+void PluginLoader::prefetchLibraryFiles(const LibraryCache& cache, const std::vector<std::string>& library_names,
+                                        const std::vector<std::string>& search_paths_local) const
+{
+  std::vector<std::string> files;
+  for (const std::string& library_name : library_names)
+  {
+    // Skip libraries which were resolved to a cached library
+    const auto resolution_it = cache.resolutions.find(library_name);
+    if (resolution_it != cache.resolutions.end() && cache.libraries.count(resolution_it->second.key) > 0)
+      continue;
+
+    const boost::filesystem::path library_path(library_name);
+    if (library_path.is_absolute())
+    {
+      if (cache.libraries.find(library_name) == cache.libraries.end())
+        files.push_back(library_name);
+      continue;
+    }
+
+    // Skip libraries which are already cached under any of their candidate paths
+    std::vector<std::string> candidates;
+    bool cached = (cache.libraries.find(library_name) != cache.libraries.end());
+    for (auto it = search_paths_local.begin(); it != search_paths_local.end() && !cached; ++it)
+    {
+      cached = (cache.libraries.find((boost::filesystem::path(*it) / library_name).string()) != cache.libraries.end());
+      candidates.push_back(boost::dll::shared_library::decorate(boost::filesystem::path(*it) / library_name).string());
+    }
+
+    if (!cached)
+      files.insert(files.end(), candidates.begin(), candidates.end());
+  }
+
+  prefetchFiles(files);
+}
+
+std::unordered_map<std::string, LoadedLibrary::Ptr>
+PluginLoader::loadLibraryWavesLocked(const LibraryCache& cache, const std::vector<std::string>& library_names,
+                                     const std::vector<std::string>& search_paths_local) const
+{
+  // Find the files of the libraries which are not cached, as loadLibraries does. Libraries in system folders are left
+  // to loadLibraries, since their files are only found by the dynamic loader.
+  std::vector<std::string> names;
+  std::vector<boost::filesystem::path> paths;
+  std::vector<std::string> files;
+  for (const std::string& library_name : library_names)
+  {
+    const auto resolution_it = cache.resolutions.find(library_name);
+    if (resolution_it != cache.resolutions.end() && cache.libraries.count(resolution_it->second.key) > 0)
+      continue;
+
+    boost::filesystem::path library_path(library_name);
+    std::string file = library_path.is_absolute() ? findLibraryFile(library_path) : std::string();
+    for (auto it = search_paths_local.begin(); it != search_paths_local.end() && file.empty(); ++it)
+    {
+      library_path = boost::filesystem::path(*it) / library_name;
+      file = findLibraryFile(library_path);
+    }
+
+    // Changed files are loaded from a copy, and registered libraries are not loaded again
+    if (file.empty() || cache.libraries.count(library_path.string()) > 0 || cache.library_files.count(file) > 0 ||
+        std::find(cache.changed_library_files.begin(), cache.changed_library_files.end(), file) !=
+            cache.changed_library_files.end() ||
+        (use_shared_registry && LibraryRegistry::instance().find(file) != nullptr) ||
+        std::find(names.begin(), names.end(), library_name) != names.end())
+      continue;
+
+    names.push_back(library_name);
+    paths.push_back(std::move(library_path));
+    files.push_back(std::move(file));
+  }
+
+  if (names.empty())
+    return {};
+
+  // Dependencies on libraries which are cached or not listed are already satisfied
+  std::vector<std::vector<std::size_t>> dependencies(names.size());
+  for (std::size_t i = 0; i < names.size(); ++i)
+  {
+    for (const std::string& dependency : readLibraryDependencies(files[i]))
+    {
+      const auto it = std::find(names.begin(), names.end(), dependency);
+      if (it != names.end())
+        dependencies[i].push_back(static_cast<std::size_t>(std::distance(names.begin(), it)));
+    }
+  }
+
+  std::vector<LoadedLibrary::Ptr> loaded(names.size());
+  for (const std::vector<std::size_t>& wave : getDependencyWaves(names, dependencies))
+  {
+    PluginLoaderEvent event;
+    parallelFor(wave.size(), [&](std::size_t i) {
+      const std::size_t node = wave[i];
+      const auto mode_it = library_load_modes.find(names[node]);
+      loaded[node] = loadLibraryAndNotify(
+          paths[node], (mode_it != library_load_modes.end()) ? mode_it->second : load_mode, listeners);
+    });
+
+    if (!listeners.empty())
+    {
+      event.type = PluginLoaderEventType::LOAD_WAVE;
+      event.duration = PluginLoaderEvent::Clock::now() - event.timestamp;
+      for (const std::size_t node : wave)
+        event.library += (event.library.empty() ? "" : ", ") + names[node];
+      for (const auto& listener : listeners)
+        listener->onLoadWave(event);
+    }
+  }
+
+  std::unordered_map<std::string, LoadedLibrary::Ptr> libraries;
+  for (std::size_t i = 0; i < names.size(); ++i)
+  {
+    if (loaded[i] != nullptr)
+      libraries.emplace(paths[i].string(), std::move(loaded[i]));
+  }
+
+  return libraries;
+}
+
+LibraryEvictionReport PluginLoader::evictIdleLibrariesLocked(std::unique_lock<std::mutex>& cache_lock,
+                                                             std::uint64_t min_last_used, bool evict_all) const
+{
+  LibraryEvictionReport report;
+
+  // The recency of the libraries is tracked by each cache, since libraries may be shared through the registry
+  std::uintmax_t total_size{ 0 };
+  std::vector<std::pair<std::uint64_t, std::string>> candidates;
+  for (const auto& entry : cache_->libraries)
+  {
+    total_size += entry.second->size;
+    const auto last_used_it = cache_->last_used.find(entry.first);
+    const std::uint64_t last_used = (last_used_it != cache_->last_used.end()) ? last_used_it->second : 0;
+    if (entry.second->liveInstances() == 0 && last_used < min_last_used)
+      candidates.emplace_back(last_used, entry.first);
+  }
+
+  // Evict the least recently used libraries first
+  std::sort(candidates.begin(), candidates.end());
+
+  const bool has_budget = (max_cached_libraries > 0 || max_cached_library_bytes > 0);
+  std::size_t cached_libraries = cache_->libraries.size();
+  auto over_budget = [&]() {
+    if (!has_budget)
+      return evict_all;
+
+    return (max_cached_libraries > 0 && cached_libraries > max_cached_libraries) ||
+           (max_cached_library_bytes > 0 && total_size > max_cached_library_bytes);
+  };
+
+  // Evicting from a cache shared with copies of this plugin loader would unload their libraries, so switch to a
+  // private copy of the cache first, as clear() does
+  if (!candidates.empty() && over_budget())
+    detachCacheLocked(cache_lock);
+
+  LibraryCache& cache = *cache_;
+  for (const auto& candidate : candidates)
+  {
+    if (!over_budget())
+      break;
+
+    const std::string& key = candidate.second;
+    total_size -= cache.libraries.at(key)->size;
+    --cached_libraries;
+    cache.libraries.erase(key);
+    cache.last_used.erase(key);
+    report.unloaded.push_back(key);
+    advanceLibraryCacheGeneration();
+
+    if (!listeners.empty())
+    {
+      PluginLoaderEvent event;
+      event.type = PluginLoaderEventType::LIBRARY_EVICTED;
+      event.library = key;
+      for (const auto& listener : listeners)
+        listener->onLibraryEvicted(event);
+    }
+  }
+
+  report.retained.reserve(cache.libraries.size());
+  for (const auto& entry : cache.libraries)
+    report.retained.push_back(entry.first);
+
+  return report;
+}
+
+template <typename PluginBase>
+void PluginLoader::reportErrorCommon(std::ostream& msg, const std::string& plugin_name, bool search_system_folders,
+                                     const std::vector<std::string>& search_paths,
+                                     const std::vector<std::string>& search_libraries)
+{
+  const std::string plugin_base_type = boost::core::demangle(typeid(PluginBase).name());
+  msg << "Failed to create plugin instance '" << plugin_name << "' of type '" << plugin_base_type << "'\n";
+  msg << "Search Paths " << std::string(search_system_folders ? "(including " : "(not including ")
+      << "system folders)\n";
+
+  for (const auto& path : search_paths)
+    msg << "    - " << path << "\n";
+
+  msg << "Search Libraries:\n";
+  for (const auto& library : search_libraries)
+    msg << "    - " << decorate(library) << "\n";
+}
+
+template <typename PluginBase>
+typename std::enable_if_t<!has_getSection<PluginBase>::value, void>
+PluginLoader::reportError(std::ostream& msg, const std::string& plugin_name, bool search_system_folders,
+                          const std::vector<std::string>& search_paths,
+                          const std::vector<std::string>& search_libraries,
+                          const std::vector<LoadedLibrary::Ptr>& /*libraries*/)
+{
+  return reportErrorCommon<PluginBase>(msg, plugin_name, search_system_folders, search_paths, search_libraries);
+}
+
+template <typename PluginBase>
+typename std::enable_if_t<has_getSection<PluginBase>::value, void>
+PluginLoader::reportError(std::ostream& msg, const std::string& plugin_name, bool search_system_folders,
+                          const std::vector<std::string>& search_paths,
+                          const std::vector<std::string>& search_libraries,
+                          const std::vector<LoadedLibrary::Ptr>& libraries)
+{
+  reportErrorCommon<PluginBase>(msg, plugin_name, search_system_folders, search_paths, search_libraries);
+
+  // Add information about the available plugins in the libraries which were loaded
+  const std::string plugin_base_type = boost::core::demangle(typeid(PluginBase).name());
+  std::vector<std::string> plugins;
+  for (const auto& lib : libraries)
+    appendLibrarySymbols(*lib, PluginBase::getSection(), plugins);
+
+  msg << "Available plugins of type '" << plugin_base_type << "':\n";
+  for (const auto& p : plugins)
+    msg << "    - " << p << "\n";
+}
+
+AdaptiveSearchOrder::ConstPtr
+PluginLoader::getAdaptiveSearchOrder(const std::vector<LoadedLibrary::Ptr>& libraries) const
+{
+  const std::unique_lock<std::mutex> lock = lockAndRecordWait(libraries_mutex_);
+  LibraryCache& cache = getCacheLocked();
+  const std::unique_lock<std::mutex> cache_lock = lockAndRecordWait(cache.mutex);
+
+  // Compare the libraries by ownership, which does not touch the reference counts
+  const AdaptiveSearchOrder::ConstPtr& current = cache.adaptive_search_order;
+  const bool same_libraries =
+      (current != nullptr) &&
+      std::equal(libraries.begin(), libraries.end(), current->libraries.begin(), current->libraries.end(),
+                 [](const LoadedLibrary::Ptr& lib, const std::weak_ptr<LoadedLibrary>& searched) {
+                   return !lib.owner_before(searched) && !searched.owner_before(lib);
+                 });
+  if (same_libraries && ++cache.adaptive_lookups < libraries.size())
+    return current;
+
+  auto next = std::make_shared<AdaptiveSearchOrder>();
+  if (same_libraries)
+  {
+    next->libraries = current->libraries;
+    next->ambiguous_plugins = current->ambiguous_plugins;
+    next->hidden_sections = current->hidden_sections;
+  }
+  else
+  {
+    // Count the libraries which provide each plugin
+    std::unordered_map<std::string, std::unordered_map<std::string, std::size_t>> providers;
+    for (const LoadedLibrary::Ptr& lib : libraries)
+    {
+      next->libraries.push_back(lib);
+      const LibraryIndex& index = lib->getIndex();
+      for (const auto& entry : index.symbols)
+      {
+        for (const std::string& plugin : entry.second)
+          ++providers[entry.first][plugin];
+      }
+
+      for (const std::string& section : index.all_sections)
+      {
+        if (index.findSymbols(section) == nullptr)
+          next->hidden_sections.insert(section);
+      }
+    }
+
+    for (const auto& section : providers)
+    {
+      for (const auto& plugin : section.second)
+      {
+        if (plugin.second > 1)
+          next->ambiguous_plugins[section.first].insert(plugin.first);
+      }
+    }
+  }
+
+  // Sort by descending hits, keeping the search order for ties
+  std::vector<std::uint64_t> hits(libraries.size());
+  next->order.resize(libraries.size());
+  for (std::size_t i = 0; i < libraries.size(); ++i)
+  {
+    hits[i] = libraries[i]->hits.load(std::memory_order_relaxed);
+    next->order[i] = i;
+  }
+  std::stable_sort(next->order.begin(), next->order.end(),
+                   [&hits](std::size_t lhs, std::size_t rhs) { return hits[lhs] > hits[rhs]; });
+
+  cache.adaptive_lookups = 0;
+  cache.adaptive_search_order = next;
+  return next;
+}
+
+template <class PluginBase>
+LoadedLibrary::Ptr PluginLoader::findPluginLibraryAdaptive(const std::string& plugin_name,
+                                                           const std::vector<LoadedLibrary::Ptr>& libraries) const
+{
+  auto hit = [](const LoadedLibrary::Ptr& lib) {
+    lib->hits.fetch_add(1, std::memory_order_relaxed);
+    return lib;
+  };
+
+  // Plugins which are only provided by one library can be searched for in any order. Plugin types without a section
+  // are looked up by symbol name, which is not indexed.
+  if constexpr (has_getSection<PluginBase>::value)
+  {
+    const AdaptiveSearchOrder::ConstPtr search_order = getAdaptiveSearchOrder(libraries);
+    if (!search_order->isAmbiguous(PluginBase::getSection(), plugin_name))
+    {
+      for (const std::size_t i : search_order->order)
+      {
+        if (hasSymbol<PluginBase>(*libraries[i], plugin_name))
+          return hit(libraries[i]);
+      }
+
+      return nullptr;
+    }
+  }
+
+  for (const LoadedLibrary::Ptr& lib : libraries)
+  {
+    if (hasSymbol<PluginBase>(*lib, plugin_name))
+      return hit(lib);
+  }
+
+  return nullptr;
+}
+
+template <class PluginBase>
+std::shared_ptr<PluginBase> PluginLoader::createInstanceAndNotify(const LoadedLibrary& lib,
+                                                                  const std::string& plugin_name,
+                                                                  PluginBase* plugin) const
+{
+  // Share the plugin object resolved earlier, without looking up its symbol again. The instance shares ownership of the
+  // library handle (and its control block, so no memory is allocated).
+  auto create = [&lib, &plugin_name, plugin]() {
+    if (plugin == nullptr)
+      return createSharedInstance<PluginBase>(lib.library, plugin_name);
+
+    return std::shared_ptr<PluginBase>(lib.library, plugin);
+  };
+
+  if (listeners.empty())
+    return create();
+
+  PluginLoaderEvent event;
+  event.type = PluginLoaderEventType::SYMBOL_RESOLVED;
+  event.plugin = plugin_name;
+  event.library = lib.library->location().string();
+  event.library_name = lib.name;
+  for (const auto& listener : listeners)
+    listener->onSymbolResolved(event);
+
+  event.type = PluginLoaderEventType::INSTANCE_CREATED;
+  event.timestamp = PluginLoaderEvent::Clock::now();
+  std::shared_ptr<PluginBase> instance = create();
+  event.duration = PluginLoaderEvent::Clock::now() - event.timestamp;
+  for (const auto& listener : listeners)
+    listener->onInstanceCreated(event);
+
+  return instance;
+}
+
+ThreadCacheSet& PluginLoader::getThreadCacheSet(const std::type_info& type, const std::string& plugin_name) const
+{
+  static constexpr std::size_t size{ 64 };
+  thread_local std::array<ThreadCacheSet, size> sets;
+
+  // Mix the key (pointers have their low bits clear) and index by the high bits of the product
+  const std::uint64_t key = std::hash<std::string>()(plugin_name) ^ type.hash_code() ^
+                            static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(this) >> 4U);
+  return sets[static_cast<std::size_t>((key * 0x9E3779B97F4A7C15ULL) >> 58U)];
+}
+
+std::size_t PluginLoader::getSearchConfigurationHash() const
+{
+  std::size_t hash{ 0 };
+  boost::hash_combine(hash, search_system_folders);
+  boost::hash_combine(hash, search_paths);
+  boost::hash_combine(hash, search_libraries);
+  boost::hash_combine(hash, search_paths_env);
+  boost::hash_combine(hash, search_libraries_env);
+  boost::hash_combine(hash, static_cast<unsigned>(load_mode));
+  boost::hash_combine(hash, adaptive_search_order);
+  boost::hash_combine(hash, discovery_patterns);
+  boost::hash_combine(hash, discovery_depth);
+
+  // The iteration order of the map depends on its history, so sum the hashes of its entries
+  std::size_t load_modes_hash{ 0 };
+  for (const auto& entry : library_load_modes)
+  {
+    std::size_t entry_hash{ 0 };
+    boost::hash_combine(entry_hash, entry.first);
+    boost::hash_combine(entry_hash, static_cast<unsigned>(entry.second));
+    load_modes_hash += entry_hash;
+  }
+  boost::hash_combine(hash, load_modes_hash);
+
+  return hash;
+}
+
+template <class PluginBase>
+std::shared_ptr<PluginBase> PluginLoader::findAndCreateInstance(const std::string& plugin_name,
+                                                                PluginLoaderErrorCode& error,
+                                                                std::vector<std::string>& library_names,
+                                                                std::vector<std::string>& search_paths_local,
+                                                                std::vector<LoadedLibrary::Ptr>& libraries) const
+{
+  // Frozen plugin loaders look the plugin up in their table
+  if (frozen_ != nullptr)
+  {
+    const FrozenPluginTable::Entry* entry{ nullptr };
+    if constexpr (has_getSection<PluginBase>::value)
+    {
+      static const std::string section = PluginBase::getSection();
+      entry = frozen_->plugins.find(section, plugin_name);
+    }
+    else
+    {
+      entry = frozen_->plugins.find({}, plugin_name);
+    }
+
+    if (entry == nullptr)
+    {
+      error = PluginLoaderErrorCode::PLUGIN_NOT_FOUND;
+      return nullptr;
+    }
+
+    const LoadedLibrary& lib = *frozen_->libraries[entry->library];
+    if constexpr (has_getSection<PluginBase>::value)
+      checkBaseType<PluginBase>(entry->base_type, plugin_name, lib);
+
+    error = PluginLoaderErrorCode::SUCCESS;
+    return createInstanceAndNotify<PluginBase>(lib, plugin_name, static_cast<PluginBase*>(entry->plugin));
+  }
+
+  // Serve the lookup from the calling thread's cache if it resolved the plugin in the current generation and with the
+  // search configuration of the last search of this plugin loader
+  ThreadCacheSet* thread_cache_set{ nullptr };
+  const std::uint64_t generation = thread_local_cache ? getLibraryCacheGeneration() : 0;
+  if (thread_local_cache)
+  {
+    const std::size_t configuration = search_configuration_hash_.load(std::memory_order_relaxed);
+    thread_cache_set = &getThreadCacheSet(typeid(PluginBase), plugin_name);
+    for (const ThreadCacheEntry& entry : *thread_cache_set)
+    {
+      if (entry.generation != generation || entry.configuration != configuration ||
+          !entry.matches(this, typeid(PluginBase), plugin_name))
+        continue;
+
+      const LoadedLibrary::Ptr lib = entry.library.lock();
+      if (lib != nullptr)
+      {
+        error = PluginLoaderErrorCode::SUCCESS;
+        return createInstanceAndNotify<PluginBase>(*lib, plugin_name, static_cast<PluginBase*>(entry.plugin));
+      }
+    }
+  }
+
+  // Check for environment variable for plugin definitions
+  library_names = getAllLibraryNames(search_libraries_env, search_libraries);
+  if (library_names.empty() && discovery_patterns.empty())
+  {
+    error = PluginLoaderErrorCode::NO_LIBRARIES;
+    return nullptr;
+  }
+
+  // Check for environment variable for search paths
+  search_paths_local = getAllSearchPaths(search_paths_env, search_paths);
+
+  LoadedLibrary::Ptr plugin_library;
+  if (adaptive_search_order)
+  {
+    // The adaptive order needs all libraries to know which plugins more than one of them provides
+    libraries = loadLibraries(library_names, search_paths_local);
+    plugin_library = findPluginLibraryAdaptive<PluginBase>(plugin_name, libraries);
+  }
+  else
+  {
+    // Load the libraries in search order until one of them has the plugin. Plugins exported for another base class are
+    // rejected from the plugin records of a library file before the library is loaded.
+    std::function<void(const std::string& file)> check_file;
+    if constexpr (has_getSection<PluginBase>::value)
+    {
+      check_file = [&plugin_name](const std::string& file) {
+        static const std::string section = PluginBase::getSection();
+        const std::optional<std::uint64_t> base_type = findRecordedBaseType(file, section, plugin_name);
+        if (base_type.has_value())
+          checkBaseType<PluginBase>(base_type.value(), plugin_name, file);
+      };
+    }
+
+    loadLibrariesUntil(
+        library_names, search_paths_local, libraries,
+        [this, &plugin_name, &plugin_library](const LoadedLibrary::Ptr& lib) {
+          if (!hasSymbol<PluginBase>(*lib, plugin_name))
+            return false;
+
+          plugin_library = lib;
+          return true;
+        },
+        true, check_file);
+  }
+
+  if (plugin_library == nullptr)
+  {
+    error = PluginLoaderErrorCode::PLUGIN_NOT_FOUND;
+    return nullptr;
+  }
+
+  // Create an instance of the plugin
+  error = PluginLoaderErrorCode::SUCCESS;
+  std::shared_ptr<PluginBase> instance = createInstanceAndNotify<PluginBase>(*plugin_library, plugin_name);
+
+  // Record the resolution in the generation read before searching, so that it is dropped if the libraries changed in
+  // the meantime. The most recent resolution goes first, replacing an older one of the same plugin or the oldest one.
+  if (thread_cache_set != nullptr)
+  {
+    ThreadCacheSet& set = *thread_cache_set;
+    if (!set.front().matches(this, typeid(PluginBase), plugin_name))
+      std::rotate(set.begin(), std::prev(set.end()), set.end());
+
+    ThreadCacheEntry& entry = set.front();
+    entry.generation = generation;
+    entry.configuration = search_configuration_hash_.load(std::memory_order_relaxed);
+    entry.loader = this;
+    entry.type = &typeid(PluginBase);
+    entry.plugin_name = plugin_name;
+    entry.library = plugin_library;
+    entry.plugin = instance.get();
+  }
+
+  return instance;
+}
+
+template <class PluginBase>
+std::shared_ptr<PluginBase> PluginLoader::createInstance(const std::string& plugin_name) const
+{
+  PluginLoaderErrorCode error{ PluginLoaderErrorCode::SUCCESS };
+  std::vector<std::string> library_names;
+  std::vector<std::string> search_paths_local;
+  std::vector<LoadedLibrary::Ptr> libraries;
+  std::shared_ptr<PluginBase> instance =
+      findAndCreateInstance<PluginBase>(plugin_name, error, library_names, search_paths_local, libraries);
+  if (instance != nullptr)
+    return instance;
+
+  if (error == PluginLoaderErrorCode::NO_LIBRARIES)
+  {
+    const PluginLoaderException exception(toString(error));
+    if (!listeners.empty())
+      notifyFailure(listeners, plugin_name, error, std::make_exception_ptr(exception));
+    throw exception;
+  }
+
+  if (frozen_ != nullptr)
+  {
+    library_names = frozen_->library_names;
+    search_paths_local = frozen_->search_paths;
+    libraries = frozen_->libraries;
+  }
+
+  // The detailed message is only formatted if it is requested, from the libraries which were loaded by this call
+  PluginNotFoundException exception(
+      plugin_name, [plugin_name, search_system_folders = search_system_folders,
+                    search_paths_local = std::move(search_paths_local), library_names = std::move(library_names),
+                    libraries = std::move(libraries)]() {
+        std::stringstream msg;
+        reportError<PluginBase>(msg, plugin_name, search_system_folders, search_paths_local, library_names, libraries);
+        return msg.str();
+      });
+
+  // The listeners get a copy of the exception, which shares the message so that it is formatted at most once
+  if (!listeners.empty())
+    notifyFailure(listeners, plugin_name, error, std::make_exception_ptr(exception));
+
+  throw exception;
+}
+
+template <class PluginBase>
+std::shared_ptr<PluginBase> PluginLoader::tryCreateInstance(const std::string& plugin_name,
+                                                            PluginLoaderErrorCode* error) const
+{
+  PluginLoaderErrorCode result{ PluginLoaderErrorCode::SUCCESS };
+  std::vector<std::string> library_names;
+  std::vector<std::string> search_paths_local;
+  std::vector<LoadedLibrary::Ptr> libraries;
+  std::shared_ptr<PluginBase> instance =
+      findAndCreateInstance<PluginBase>(plugin_name, result, library_names, search_paths_local, libraries);
+
+  if (instance == nullptr && !listeners.empty())
+    notifyFailure(listeners, plugin_name, result);
+
+  if (error != nullptr)
+    *error = result;
+
+  return instance;
+}
+
+template <class PluginBase>
+typename std::enable_if_t<has_getSection<PluginBase>::value, std::map<std::string, std::shared_ptr<PluginBase>>>
+PluginLoader::createAllInstances() const
+{
+  std::vector<LoadedLibrary::Ptr> libraries;
+  visitLibraries([&libraries](const LoadedLibrary::Ptr& lib) { libraries.push_back(lib); });
+
+  // Parse the libraries concurrently
+  const std::string section = PluginBase::getSection();
+  std::vector<std::vector<std::string>> library_plugins(libraries.size());
+  parallelFor(libraries.size(), [&](std::size_t i) {
+    const std::vector<std::string>* indexed_plugins = libraries[i]->getIndex().findSymbols(section);
+
+    // Symbols under hidden sections are not indexed
+    library_plugins[i] = (indexed_plugins != nullptr) ? *indexed_plugins :
+                                                        getAllAvailableSymbols(*libraries[i]->library, section);
+  });
+
+  // Select the library providing each plugin in search order, so that the first library wins as in createInstance
+  std::vector<std::pair<std::string, std::size_t>> plugins;
+  std::unordered_set<std::string> plugin_names;
+  for (std::size_t i = 0; i < libraries.size(); ++i)
+  {
+    for (std::string& plugin : library_plugins[i])
+    {
+      if (plugin_names.insert(plugin).second)
+        plugins.emplace_back(std::move(plugin), i);
+    }
+  }
+
+  // Resolve and create only the selected plugins concurrently
+  std::vector<std::shared_ptr<PluginBase>> plugin_instances(plugins.size());
+  parallelFor(plugins.size(), [&](std::size_t i) {
+    const LoadedLibrary& lib = *libraries[plugins[i].second];
+    checkBaseType<PluginBase>(lib.getIndex().findBaseType(section, plugins[i].first), plugins[i].first, lib);
+    plugin_instances[i] = createInstanceAndNotify<PluginBase>(lib, plugins[i].first);
+  });
+
+  std::map<std::string, std::shared_ptr<PluginBase>> instances;
+  for (std::size_t i = 0; i < plugins.size(); ++i)
+    instances.emplace(std::move(plugins[i].first), std::move(plugin_instances[i]));
+
+  return instances;
+}
+
+bool PluginLoader::isPluginAvailable(const std::string& plugin_name) const
+{
+  if (frozen_ != nullptr)
+    return frozen_->plugins.find({}, plugin_name) != nullptr;
+
+  // Check for environment variable for plugin definitions
+  const std::vector<std::string> library_names = getAllLibraryNames(search_libraries_env, search_libraries);
+  if (library_names.empty() && discovery_patterns.empty())
+    throw PluginLoaderException("No plugin libraries were provided!");
+
+  // Check for environment variable for search paths
+  const std::vector<std::string> search_paths_local = getAllSearchPaths(search_paths_env, search_paths);
+
+  // Look the plugin up in the manifest without loading the libraries. Plugins under hidden sections are not indexed.
+  const std::shared_ptr<const std::vector<LoadedLibrary::Ptr>> manifest_libraries = getManifestLibraries();
+  if (manifest_libraries != nullptr)
+  {
+    return std::any_of(manifest_libraries->begin(), manifest_libraries->end(), [&plugin_name](const auto& lib) {
+      const LibraryIndex& index = lib->getIndex();
+      return std::any_of(index.symbols.begin(), index.symbols.end(), [&plugin_name](const auto& section) {
+        return std::find(section.second.begin(), section.second.end(), plugin_name) != section.second.end();
+      });
+    });
+  }
+
+  // Load the libraries in search order until one of them has the symbol
+  bool found = false;
+  std::vector<LoadedLibrary::Ptr> libraries;
+  loadLibrariesUntil(library_names, search_paths_local, libraries,
+                     [&plugin_name, &found](const LoadedLibrary::Ptr& lib) {
+                       found = lib->library->has(plugin_name);
+                       return found;
+                     });
+  return found;
+}
+
+template <class PluginBase>
+typename std::enable_if_t<has_getSection<PluginBase>::value, std::vector<std::string>>
+PluginLoader::getAvailablePlugins() const
+{
+  return getAvailablePlugins(PluginBase::getSection());
+}
+
+std::vector<std::string> PluginLoader::getAvailablePlugins(const std::string& section) const
+{
+  std::vector<std::string> plugins;
+  forEachPlugin(section, [&plugins](std::string_view plugin, const LoadedLibrary::Ptr& /*lib*/) {
+    plugins.emplace_back(plugin);
+  });
+  return plugins;
+}
+
+std::vector<std::string> PluginLoader::getAvailableSections(bool include_hidden) const
+{
+  std::vector<std::string> sections;
+  forEachSection(
+      [&sections](std::string_view section, const LoadedLibrary::Ptr& /*lib*/) { sections.emplace_back(section); },
+      include_hidden);
+  return sections;
+}
+
+template <class Visitor>
+void PluginLoader::visitLibraries(Visitor&& visitor) const
+{
+  if (frozen_ != nullptr)
+  {
+    for (const auto& lib : frozen_->libraries)
+      visitor(lib);
+    return;
+  }
+
+  // Only copy the library names and search paths if they are extended by environment variables
+  std::vector<std::string> env_library_names;
+  const std::vector<std::string>& library_names =
+      search_libraries_env.empty() ? search_libraries :
+                                     (env_library_names = getAllLibraryNames(search_libraries_env, search_libraries));
+  if (library_names.empty() && discovery_patterns.empty())
+    throw PluginLoaderException("No plugin libraries were provided!");
+
+  std::vector<std::string> env_search_paths;
+  const std::vector<std::string>& search_paths_local =
+      search_paths_env.empty() ? search_paths : (env_search_paths = getAllSearchPaths(search_paths_env, search_paths));
+
+  // Load the libraries
+  boost::container::small_vector<LoadedLibrary::Ptr, 16> libraries;
+  loadLibraries(library_names, search_paths_local, libraries);
+
+  for (const auto& lib : libraries)
+    visitor(lib);
+}
+
+template <class Callback>
+void PluginLoader::forEachPlugin(const std::string& section, Callback&& callback) const
+{
+  if (frozen_ != nullptr)
+  {
+    for (const FrozenPluginTable::Entry& entry : frozen_->plugins.findSection(section))
+      callback(std::string_view(entry.name), frozen_->libraries[entry.library]);
+    return;
+  }
+
+  // List the plugins from the manifest without loading the libraries, unless the section is hidden in one of them
+  const std::shared_ptr<const std::vector<LoadedLibrary::Ptr>> manifest_libraries = getManifestLibraries();
+  if (manifest_libraries != nullptr &&
+      std::none_of(manifest_libraries->begin(), manifest_libraries->end(), [&section](const LoadedLibrary::Ptr& lib) {
+        const LibraryIndex& index = lib->getIndex();
+        return index.findSymbols(section) == nullptr &&
+               std::find(index.all_sections.begin(), index.all_sections.end(), section) != index.all_sections.end();
+      }))
+  {
+    for (const LoadedLibrary::Ptr& lib : *manifest_libraries)
+    {
+      const std::vector<std::string>* plugins = lib->getIndex().findSymbols(section);
+      if (plugins == nullptr)
+        continue;
+
+      for (const std::string& plugin : *plugins)
+        callback(std::string_view(plugin), lib);
+    }
+    return;
+  }
+
+  visitLibraries([&section, &callback](const LoadedLibrary::Ptr& lib) {
+    const std::vector<std::string>* plugins = lib->getIndex().findSymbols(section);
+    if (plugins != nullptr)
+    {
+      for (const std::string& plugin : *plugins)
+        callback(std::string_view(plugin), lib);
+      return;
+    }
+
+    // Symbols under hidden sections are not indexed
+    for (const std::string& plugin : getAllAvailableSymbols(*lib->library, section))
+      callback(std::string_view(plugin), lib);
+  });
+}
+
+template <class Callback>
+void PluginLoader::forEachSection(Callback&& callback, bool include_hidden) const
+{
+  auto visit = [&callback, include_hidden](const LoadedLibrary::Ptr& lib) {
+    const LibraryIndex& index = lib->getIndex();
+    for (const std::string& section : include_hidden ? index.all_sections : index.sections)
+      callback(std::string_view(section), lib);
+  };
+
+  // List the sections from the manifest without loading the libraries
+  const std::shared_ptr<const std::vector<LoadedLibrary::Ptr>> manifest_libraries = getManifestLibraries();
+  if (manifest_libraries != nullptr)
+  {
+    for (const LoadedLibrary::Ptr& lib : *manifest_libraries)
+      visit(lib);
+    return;
+  }
+
+  visitLibraries(visit);
+}
+
+std::size_t PluginLoader::preload(const PluginLoadProfile& profile) const
+{
+  if (frozen_ != nullptr)
+    throw PluginLoaderException("Cannot preload libraries into a frozen plugin loader");
+
+  // Only preload the recorded libraries which are still configured, including those discovered with discovery_patterns
+  const std::vector<std::string> library_names = getAllLibraryNames(search_libraries_env, search_libraries);
+  const std::vector<std::string> discovered_libraries = getDiscoveredLibraries();
+  std::vector<std::string> preload_names;
+  for (std::string& library_name : profile.getLibraries())
+  {
+    if (std::find(library_names.begin(), library_names.end(), library_name) != library_names.end() ||
+        std::find(discovered_libraries.begin(), discovered_libraries.end(), library_name) != discovered_libraries.end())
+      preload_names.push_back(std::move(library_name));
+  }
+
+  if (preload_names.empty())
+    return 0;
+
+  // The dynamic loader serializes loading, so the libraries are loaded in order and only parsing them is parallelized.
+  // Only the recorded libraries are loaded, and the resolutions of the other libraries are kept.
+  const std::vector<std::string> search_paths_local = getAllSearchPaths(search_paths_env, search_paths);
+  std::vector<LoadedLibrary::Ptr> libraries;
+  loadLibrariesUntil(
+      preload_names, search_paths_local, libraries, [](const LoadedLibrary::Ptr& /*lib*/) { return false; }, false);
+
+  parallelFor(libraries.size(), [&libraries](std::size_t i) {
+    try
+    {
+      libraries[i]->getIndex();
+    }
+    catch (...)
+    {
+      // Errors are reported when the library is used
+    }
+  });
+
+  return libraries.size();
+}
+
+LibraryManifest::ConstPtr PluginLoader::loadManifest(const std::string& file_path) const
+{
+  if (frozen_ != nullptr)
+    throw PluginLoaderException("Cannot load a manifest into a frozen plugin loader");
+
+  const std::vector<std::string> library_names = getAllLibraryNames(search_libraries_env, search_libraries);
+  const std::vector<std::string> search_paths_local = getAllSearchPaths(search_paths_env, search_paths);
+  const std::uint64_t configuration_hash = getManifestConfigurationHash(library_names, search_paths_local);
+
+  LibraryManifest::ConstPtr manifest = LibraryManifest::map(file_path, configuration_hash);
+  if (manifest == nullptr || !manifest->isCurrent())
+  {
+    // Only one of the processes starting together builds the manifest, while the others wait for it to be published
+    const LibraryManifest::BuildLock build_lock(file_path);
+    manifest = LibraryManifest::map(file_path, configuration_hash);
+    if (manifest == nullptr || !manifest->isCurrent())
+    {
+      std::vector<LibraryManifest::Entry> entries;
+      for (const LoadedLibrary::Ptr& lib : loadLibraries(library_names, search_paths_local))
+      {
+        LibraryManifest::Entry entry;
+        boost::system::error_code ec;
+        entry.name = lib->name;
+        entry.file = lib->file;
+        entry.size = entry.file.empty() ? 0 : boost::filesystem::file_size(entry.file, ec);
+        entry.modified = entry.file.empty() ? -1 : getModificationTime(entry.file);
+        if (entry.file.empty() || ec || entry.modified < 0)
+          continue;
+
+        entry.index = lib->getIndex();
+        entries.push_back(std::move(entry));
+      }
+
+      LibraryManifest::publish(file_path, configuration_hash, entries);
+      manifest = LibraryManifest::map(file_path, configuration_hash);
+      if (manifest == nullptr)
+        throw PluginLoaderException("Failed to map plugin library manifest: " + file_path);
+    }
+  }
+
+  // The libraries described by the manifest are visited without loading them while the manifest is current
+  auto manifest_libraries = std::make_shared<std::vector<LoadedLibrary::Ptr>>();
+  for (LibraryManifest::Entry& entry : manifest->getEntries())
+  {
+    auto lib = std::make_shared<LoadedLibrary>();
+    lib->name = std::move(entry.name);
+    lib->file = std::move(entry.file);
+    lib->size = entry.size;
+    lib->manifest = manifest;
+    manifest_libraries->push_back(std::move(lib));
+  }
+
+  const std::unique_lock<std::mutex> lock = lockAndRecordWait(libraries_mutex_);
+  LibraryCache& cache = getCacheLocked();
+  const std::unique_lock<std::mutex> cache_lock = lockAndRecordWait(cache.mutex);
+  cache.manifest = manifest;
+  cache.manifest_libraries = std::move(manifest_libraries);
+  cache.manifest_check = ManifestCheck();
+  manifest_loaded_.store(true);
+  return manifest;
+}
+
+std::shared_ptr<const std::vector<LoadedLibrary::Ptr>> PluginLoader::getManifestLibraries() const
+{
+  if (frozen_ != nullptr || !manifest_loaded_.load(std::memory_order_relaxed))
+    return nullptr;
+
+  const std::unique_lock<std::mutex> lock = lockAndRecordWait(libraries_mutex_);
+  LibraryCache& cache = getCacheLocked();
+  const std::unique_lock<std::mutex> cache_lock = lockAndRecordWait(cache.mutex);
+  if (cache.manifest_libraries == nullptr)
+    return nullptr;
+
+  // Check the manifest again only if the configuration or the libraries changed since it was last checked
+  ManifestCheck& check = cache.manifest_check;
+  if (!isManifestCheckCurrent(check))
+  {
+    check.generation = getLibraryCacheGeneration();
+    check.search_system_folders = search_system_folders;
+    check.search_paths = search_paths;
+    check.search_libraries = search_libraries;
+    check.search_paths_env = search_paths_env;
+    check.search_libraries_env = search_libraries_env;
+    check.search_paths_env_value = readEnvironmentVariable(search_paths_env);
+    check.search_libraries_env_value = readEnvironmentVariable(search_libraries_env);
+    check.discovery_patterns = discovery_patterns;
+    check.discovery_depth = discovery_depth;
+    check.current = cache.manifest->getConfigurationHash() ==
+                        getManifestConfigurationHash(getAllLibraryNames(search_libraries_env, search_libraries),
+                                                     getAllSearchPaths(search_paths_env, search_paths)) &&
+                    cache.manifest->isCurrent();
+  }
+
+  return check.current ? cache.manifest_libraries : nullptr;
+}
+
+bool PluginLoader::isManifestCheckCurrent(const ManifestCheck& check) const
+{
+  // Compare the values of the environment variables without copying them
+  auto matches_environment = [](const std::string& name, const std::optional<std::string>& value) {
+    const char* current = name.empty() ? nullptr : std::getenv(name.c_str());
+    return (current == nullptr) ? !value.has_value() : (value.has_value() && value.value() == current);
+  };
+
+  return check.generation != 0 && check.generation == getLibraryCacheGeneration() &&
+         check.search_system_folders == search_system_folders && check.discovery_depth == discovery_depth &&
+         check.search_paths == search_paths && check.search_libraries == search_libraries &&
+         check.discovery_patterns == discovery_patterns && check.search_paths_env == search_paths_env &&
+         check.search_libraries_env == search_libraries_env &&
+         matches_environment(search_paths_env, check.search_paths_env_value) &&
+         matches_environment(search_libraries_env, check.search_libraries_env_value);
+}
+
+std::uint64_t PluginLoader::getManifestConfigurationHash(const std::vector<std::string>& library_names,
+                                                         const std::vector<std::string>& search_paths_local) const
+{
+  // The manifest is only valid for the configuration which determines the libraries that are loaded
+  std::vector<std::string> configuration = library_names;
+  configuration.emplace_back();
+  configuration.insert(configuration.end(), search_paths_local.begin(), search_paths_local.end());
+  configuration.emplace_back();
+  configuration.insert(configuration.end(), discovery_patterns.begin(), discovery_patterns.end());
+  configuration.push_back(std::to_string(discovery_depth));
+  configuration.push_back(search_system_folders ? "1" : "0");
+  return LibraryManifest::hashConfiguration(configuration);
+}
+
+std::vector<std::string> PluginLoader::getDiscoveredLibraries() const
+{
+  if (frozen_ != nullptr)
+    return frozen_->discovered_libraries;
+
+  if (discovery_patterns.empty())
+    return {};
+
+  const std::vector<std::string> search_paths_local = getAllSearchPaths(search_paths_env, search_paths);
+  const std::unique_lock<std::mutex> lock = lockAndRecordWait(libraries_mutex_);
+  LibraryCache& cache = getCacheLocked();
+  const std::unique_lock<std::mutex> cache_lock = lockAndRecordWait(cache.mutex);
+  return discoverLibrariesLocked(cache, search_paths_local);
+}
+
+int PluginLoader::count() const
+{
+  if (frozen_ != nullptr)
+    return static_cast<int>(frozen_->library_names.size() + frozen_->discovered_libraries.size());
+
+  return static_cast<int>(getAllLibraryNames(search_libraries_env, search_libraries).size() +
+                          getDiscoveredLibraries().size());
+}
+
+bool PluginLoader::empty() const
 {
   return (count() == 0);
 }
 
 void PluginLoader::clear()
 {
-  std::scoped_lock lock(libraries_mutex_);
-  libraries_.clear();
+  if (frozen_ != nullptr)
+    throw PluginLoaderException("Cannot clear a frozen plugin loader");
+
+  const std::unique_lock<std::mutex> lock = lockAndRecordWait(libraries_mutex_);
+  LibraryCache& cache = getCacheLocked();
+
+  // Switch to a new cache rather than clearing the cache, which may be shared with copies of this plugin loader.
+  // Library files which changed while loaded are remembered, since old versions of them may still be mapped.
+  auto cleared = std::make_shared<LibraryCache>();
+  {
+    const std::unique_lock<std::mutex> cache_lock = lockAndRecordWait(cache.mutex);
+    cleared->changed_library_files = cache.changed_library_files;
+  }
+  cache_ = std::move(cleared);
+  manifest_loaded_.store(false);
+  advanceLibraryCacheGeneration();
+}
+
+LibraryEvictionReport PluginLoader::evictIdleLibraries()
+{
+  if (frozen_ != nullptr)
+    throw PluginLoaderException("Cannot evict libraries from a frozen plugin loader");
+
+  const std::unique_lock<std::mutex> lock = lockAndRecordWait(libraries_mutex_);
+  std::unique_lock<std::mutex> cache_lock = lockAndRecordWait(getCacheLocked().mutex);
+  return evictIdleLibrariesLocked(cache_lock, std::numeric_limits<std::uint64_t>::max(), true);
+}
+
+std::unordered_map<std::string, std::size_t> PluginLoader::getLiveInstanceCounts() const
+{
+  std::unordered_map<std::string, std::size_t> counts;
+  const std::unique_lock<std::mutex> lock = lockAndRecordWait(libraries_mutex_);
+  LibraryCache& cache = getCacheLocked();
+  const std::unique_lock<std::mutex> cache_lock = lockAndRecordWait(cache.mutex);
+  for (const auto& entry : cache.libraries)
+    counts[entry.first] = entry.second->liveInstances();
+
+  return counts;
+}
+
+LockWaitStatistics PluginLoader::getLockWaitStatistics() const
+{
+  LockWaitStatistics statistics;
+  statistics.contended_acquisitions = contended_lock_acquisitions_.load(std::memory_order_relaxed);
+  statistics.wait_time = std::chrono::nanoseconds(lock_wait_ns_.load(std::memory_order_relaxed));
+  return statistics;
+}
+
+void PluginLoader::freeze()
+{
+  if (frozen_ != nullptr)
+    return;
+
+  auto frozen = std::make_shared<FrozenPlugins>();
+  frozen->library_names = getAllLibraryNames(search_libraries_env, search_libraries);
+  if (frozen->library_names.empty() && discovery_patterns.empty())
+    throw PluginLoaderException("No plugin libraries were provided!");
+
+  frozen->search_paths = getAllSearchPaths(search_paths_env, search_paths);
+  frozen->discovered_libraries = getDiscoveredLibraries();
+  frozen->libraries = loadLibraries(frozen->library_names, frozen->search_paths);
+
+  // Parse the libraries and resolve the symbols of their plugins concurrently
+  std::vector<std::vector<FrozenPluginTable::Entry>> library_plugins(frozen->libraries.size());
+  parallelFor(frozen->libraries.size(), [&frozen, &library_plugins](std::size_t i) {
+    const LoadedLibrary& lib = *frozen->libraries[i];
+    const LibraryIndex& index = lib.getIndex();
+    for (const std::string& section : index.all_sections)
+    {
+      // Symbols under hidden sections are not indexed
+      const std::vector<std::string>* indexed_plugins = index.findSymbols(section);
+      const std::vector<std::string> hidden_plugins =
+          (indexed_plugins == nullptr) ? getAllAvailableSymbols(*lib.library, section) : std::vector<std::string>();
+      for (const std::string& plugin : (indexed_plugins != nullptr) ? *indexed_plugins : hidden_plugins)
+      {
+        if (!lib.library->has(plugin))
+          continue;
+
+        FrozenPluginTable::Entry entry;
+        entry.section = section;
+        entry.name = plugin;
+        entry.library = i;
+        entry.plugin = &lib.library->get<char>(plugin);
+        entry.base_type = index.findBaseType(section, plugin);
+        library_plugins[i].push_back(std::move(entry));
+      }
+    }
+  });
+
+  std::vector<FrozenPluginTable::Entry> plugins;
+  for (auto& entries : library_plugins)
+    std::move(entries.begin(), entries.end(), std::back_inserter(plugins));
+
+  frozen->plugins = FrozenPluginTable(std::move(plugins));
+  frozen_ = std::move(frozen);
+}
+
+std::unique_lock<std::mutex> PluginLoader::lockAndRecordWait(std::mutex& mutex) const
+{
+  std::unique_lock<std::mutex> lock(mutex, std::try_to_lock);
+  if (lock.owns_lock())
+    return lock;
+
+  const auto start = std::chrono::steady_clock::now();
+  lock.lock();
+  const auto wait = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+  contended_lock_acquisitions_.fetch_add(1, std::memory_order_relaxed);
+  lock_wait_ns_.fetch_add(static_cast<std::uint64_t>(wait.count()), std::memory_order_relaxed);
+  return lock;
+}
+
+LibraryCache& PluginLoader::getCacheLocked() const
+{
+  if (cache_ == nullptr)
+    cache_ = std::make_shared<LibraryCache>();
+
+  return *cache_;
+}
+
+LibraryCache& PluginLoader::detachCacheLocked(std::unique_lock<std::mutex>& cache_lock) const
+{
+  if (cache_.use_count() > 1)
+  {
+    LibraryCache::Ptr copy = cache_->clone();
+    cache_lock.unlock();
+    cache_ = std::move(copy);
+    advanceLibraryCacheGeneration();
+    cache_lock = lockAndRecordWait(cache_->mutex);
+  }
+
+  return *cache_;
 }
 
 }  // namespace boost_plugin_loader
@@ -0,0 +1,143 @@
+/**
+ *
+ * @copyright Copyright (c) 2021, Southwest Research Institute
+ *
+ * @par License
+ * Software License Agreement (Apache License)
+ * @par
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * @par
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef BOOST_PLUGIN_LOADER_PLUGIN_LOADER_LISTENER_H
+#define BOOST_PLUGIN_LOADER_PLUGIN_LOADER_LISTENER_H
+
+// STD
+#include <chrono>
+#include <exception>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace boost_plugin_loader
+{
+/** @brief The type of a plugin loader event */
+enum class PluginLoaderEventType
+{
+  LIBRARY_LOAD_START,
+  LIBRARY_LOAD_END,
+  SYMBOL_RESOLVED,
+  INSTANCE_CREATED,
+  FAILURE,
+  LIBRARY_EVICTED,
+  LOAD_WAVE
+};
+
+/** @brief A single event emitted by the plugin loader */
+struct PluginLoaderEvent
+{
+  using Clock = std::chrono::steady_clock;
+
+  /** @brief The type of the event */
+  PluginLoaderEventType type{ PluginLoaderEventType::FAILURE };
+
+  /** @brief The time at which the event occurred (or started, for events with a duration) */
+  Clock::time_point timestamp{ Clock::now() };
+
+  /** @brief The thread on which the event occurred */
+  std::thread::id thread_id{ std::this_thread::get_id() };
+
+  /** @brief The path or name of the library associated with the event, if any (the library names for LOAD_WAVE) */
+  std::string library;
+
+  /** @brief The name of the library as listed in search_libraries, for SYMBOL_RESOLVED and INSTANCE_CREATED events */
+  std::string library_name;
+
+  /** @brief The name of the plugin associated with the event, if any */
+  std::string plugin;
+
+  /** @brief A short description of the failure for FAILURE events (see toString(PluginLoaderErrorCode)) */
+  std::string message;
+
+  /**
+   * @brief The exception thrown to the caller after a FAILURE event, if any
+   * @details The detailed message of a PluginNotFoundException, which lists the search paths and libraries, is only
+   * formatted when what() is first called. Listeners which need it rethrow this exception and catch it to read it, so
+   * listeners which only trace failures do not format it.
+   */
+  std::exception_ptr exception;
+
+  /** @brief Indicate if the operation succeeded (used by LIBRARY_LOAD_END) */
+  bool success{ true };
+
+  /** @brief The duration of the operation for LIBRARY_LOAD_END, INSTANCE_CREATED and LOAD_WAVE events */
+  Clock::duration duration{ Clock::duration::zero() };
+};
+
+/**
+ * @brief Interface for observing the plugin loader
+ * @details Callbacks are invoked synchronously on the thread performing the operation, potentially while the plugin
+ * loader holds its internal library cache lock, so implementations must be fast and must not call back into the plugin
+ * loader. Implementations must also be thread-safe: besides concurrent calls into the plugin loader, a single call may
+ * invoke callbacks concurrently from several threads, e.g. when loading libraries with PluginLoader::parallel_load or
+ * creating instances with PluginLoader::createAllInstances.
+ */
+class PluginLoaderListener
+{
+public:
+  using Ptr = std::shared_ptr<PluginLoaderListener>;
+
+  PluginLoaderListener() = default;
+  virtual ~PluginLoaderListener() = default;
+  PluginLoaderListener(const PluginLoaderListener&) = default;
+  PluginLoaderListener& operator=(const PluginLoaderListener&) = default;
+  PluginLoaderListener(PluginLoaderListener&&) = default;
+  PluginLoaderListener& operator=(PluginLoaderListener&&) = default;
+
+  /** @brief Called before the plugin loader attempts to load a library from disk */
+  virtual void onLibraryLoadStart(const PluginLoaderEvent& /*event*/)
+  {
+  }
+
+  /** @brief Called after the plugin loader attempted to load a library from disk, successful or not */
+  virtual void onLibraryLoadEnd(const PluginLoaderEvent& /*event*/)
+  {
+  }
+
+  /** @brief Called when a plugin symbol has been found in a library */
+  virtual void onSymbolResolved(const PluginLoaderEvent& /*event*/)
+  {
+  }
+
+  /** @brief Called after a plugin instance has been created */
+  virtual void onInstanceCreated(const PluginLoaderEvent& /*event*/)
+  {
+  }
+
+  /** @brief Called when a plugin loader operation fails, before the error is reported to the caller */
+  virtual void onFailure(const PluginLoaderEvent& /*event*/)
+  {
+  }
+
+  /** @brief Called when an idle library is evicted from the plugin loader's cache */
+  virtual void onLibraryEvicted(const PluginLoaderEvent& /*event*/)
+  {
+  }
+
+  /** @brief Called after a wave of libraries was loaded in parallel (see PluginLoader::parallel_load) */
+  virtual void onLoadWave(const PluginLoaderEvent& /*event*/)
+  {
+  }
+};
+
+}  // namespace boost_plugin_loader
+
+#endif  // BOOST_PLUGIN_LOADER_PLUGIN_LOADER_LISTENER_H
@@ -0,0 +1,123 @@
+/**
+ *
+ * @copyright Copyright (c) 2021, Southwest Research Institute
+ *
+ * @par License
+ * Software License Agreement (Apache License)
+ * @par
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * @par
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef BOOST_PLUGIN_LOADER_PLUGIN_RECORD_H
+#define BOOST_PLUGIN_LOADER_PLUGIN_RECORD_H
+
+// STD
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace boost_plugin_loader
+{
+/** @brief The magic number at the start of each plugin record ("BPLR") */
+constexpr std::uint32_t PLUGIN_RECORD_MAGIC{ 0x42504C52 };
+
+/** @brief The version of the layout of plugin records, which changes whenever the layout changes */
+constexpr std::uint32_t PLUGIN_RECORD_ABI_VERSION{ 1 };
+
+/** @brief The name of the section of a library holding the plugin records (hidden, so it is not listed as a section) */
+constexpr std::string_view PLUGIN_RECORD_SECTION{ "__bplrec" };
+
+/**
+ * @brief A fixed-layout record describing a plugin exported with EXPORT_CLASS_SECTIONED
+ * @details The export macros emit one record per plugin into the PLUGIN_RECORD_SECTION section of the library, so the
+ * plugins of a library can be enumerated by reading that section alone, without walking the symbol table (see
+ * readPluginRecords). The layout only uses fixed-size types and is the same on 32-bit and 64-bit platforms. The strings
+ * are null-terminated.
+ */
+struct PluginRecord
+{
+  /** @brief PLUGIN_RECORD_MAGIC */
+  std::uint32_t magic;
+
+  /** @brief The layout version of the record (PLUGIN_RECORD_ABI_VERSION when it was exported) */
+  std::uint32_t abi_version;
+
+  /** @brief The type hash of the base class of the plugin (see getTypeHash), or zero if it is unknown */
+  std::uint64_t base_type;
+
+  /** @brief The section of the plugin, of at most 63 characters (the export macros check this at compile time) */
+  char section[64];  // NOLINT(modernize-avoid-c-arrays)
+
+  /** @brief The plugin name, i.e. the alias of the exported symbol, of at most 127 characters */
+  char alias[128];  // NOLINT(modernize-avoid-c-arrays)
+};
+
+static_assert(sizeof(PluginRecord) == 208, "The layout of plugin records must not depend on the platform");
+
+namespace detail
+{
+/**
+ * @brief Get the signature of this function as spelled by the compiler, which names the type
+ * @details GCC leaves out the namespace of the function when naming types of that namespace, so this function lives in
+ * a namespace which declares no types.
+ */
+template <typename T>
+constexpr std::string_view getTypeSignature()
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+  return __FUNCSIG__;
+#else
+  return __PRETTY_FUNCTION__;
+#endif
+}
+}  // namespace detail
+
+/**
+ * @brief Get the name of a type at compile time
+ * @details The name is extracted from a function signature as spelled by the compiler, so it is the same for all
+ * libraries built with the same compiler, but may differ between compilers.
+ */
+template <typename T>
+constexpr std::string_view getTypeName()
+{
+  constexpr std::string_view signature = detail::getTypeSignature<T>();
+#if defined(_MSC_VER) && !defined(__clang__)
+  // e.g. "... detail::getTypeSignature<struct ns::Base>(void)"
+  constexpr std::string_view prefix = "getTypeSignature<";
+  constexpr std::size_t start = signature.find(prefix) + prefix.size();
+  constexpr std::size_t end = signature.rfind(">(void)");
+#else
+  // e.g. "... getTypeSignature() [with T = ns::Base; ...]" (GCC) or "... getTypeSignature() [T = ns::Base]" (Clang)
+  constexpr std::string_view prefix = "T = ";
+  constexpr std::size_t start = signature.find(prefix) + prefix.size();
+  constexpr std::size_t end = (signature.find(';', start) != std::string_view::npos) ? signature.find(';', start) :
+                                                                                        signature.rfind(']');
+#endif
+  return signature.substr(start, end - start);
+}
+
+/**
+ * @brief Get a hash identifying a type across libraries (FNV-1a of its name, see getTypeName)
+ * @details The hash is never zero, which stands for an unknown type in plugin records.
+ */
+template <typename T>
+constexpr std::uint64_t getTypeHash()
+{
+  std::uint64_t hash{ 14695981039346656037ULL };
+  for (const char c : getTypeName<T>())
+    hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ULL;
+
+  return (hash != 0) ? hash : 1;
+}
+
+}  // namespace boost_plugin_loader
+
+#endif  // BOOST_PLUGIN_LOADER_PLUGIN_RECORD_H
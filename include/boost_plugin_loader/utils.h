@@ -20,12 +20,24 @@
 #define BOOST_PLUGIN_LOADER_UTILS_H
 
 // STD
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 #include <optional>
 
 // Boost
 #include <boost/dll/shared_library.hpp>
+#include <boost/dll/shared_library_load_mode.hpp>
+
+// Boost Plugin Loader
+#include <boost_plugin_loader/plugin_record.h>
 
 namespace boost_plugin_loader
 {
@@ -37,13 +49,72 @@ public:
   using std::runtime_error::runtime_error;
 };
 
+/** @brief The reasons for which a plugin instance could not be created */
+enum class PluginLoaderErrorCode
+{
+  /** @brief The plugin instance was created */
+  SUCCESS,
+  /** @brief No plugin libraries were provided */
+  NO_LIBRARIES,
+  /** @brief None of the plugin libraries which could be loaded provides the plugin */
+  PLUGIN_NOT_FOUND,
+};
+
+/** @brief Get a short description of an error code */
+const char* toString(PluginLoaderErrorCode error);
+
+/**
+ * @brief The exception thrown when a plugin could not be found
+ * @details The detailed message, which lists the search paths, libraries and available plugins, is only formatted when
+ * what() is first called, so catching this exception without inspecting the message is cheap.
+ */
+class PluginNotFoundException : public PluginLoaderException
+{
+public:
+  /**
+   * @param plugin_name The name of the plugin which could not be found
+   * @param formatter Function formatting the detailed message
+   */
+  PluginNotFoundException(std::string plugin_name, std::function<std::string()> formatter);
+
+  /** @brief The detailed message, formatted on the first call */
+  const char* what() const noexcept override;
+
+  /** @brief The name of the plugin which could not be found */
+  const std::string& getPluginName() const;
+
+private:
+  struct Message
+  {
+    std::once_flag flag;
+    std::function<std::string()> formatter;
+    std::string text;
+  };
+
+  std::string plugin_name_;
+  /** @brief Shared between copies of the exception, so the message is formatted at most once */
+  std::shared_ptr<Message> message_;
+};
+
+namespace load_mode
+{
+/**
+ * @brief Load mode flag which keeps a library mapped after its last handle is closed (RTLD_NODELETE)
+ * @details Boost.DLL does not expose this flag. It is zero on platforms which do not support it.
+ */
+extern const boost::dll::load_mode::type rtld_nodelete;
+}  // namespace load_mode
+
 /**
  * @brief Attempt to load library give library name and directory
- * @param library_name The library name to load which does not include the prefix 'lib' or suffix '.so'
- * @param library_directory The library directory, if empty it will enable search system directories
+ * @param library_path The library path to load, where the filename does not include the prefix 'lib' or suffix '.so'.
+ * If it has no parent path, system directories are searched.
+ * @param mode Additional load mode flags (e.g. boost::dll::load_mode::rtld_now). Decorations are always appended.
  * @return A shared library
  */
-std::optional<boost::dll::shared_library> loadLibrary(const boost::filesystem::path& library_path);
+std::optional<boost::dll::shared_library>
+loadLibrary(const boost::filesystem::path& library_path,
+            boost::dll::load_mode::type mode = boost::dll::load_mode::default_mode);
 
 /**
  * @brief Get a list of available symbols under the provided section
@@ -62,6 +133,97 @@ std::vector<std::string> getAllAvailableSymbols(const boost::dll::shared_library
 std::vector<std::string> getAllAvailableSections(const boost::dll::shared_library& library,
                                                  bool include_hidden = false);
 
+/** @brief The sections of a library and the symbols under each of them, read from the library file once */
+struct LibraryIndex
+{
+  /** @brief All sections of the library, including hidden sections */
+  std::vector<std::string> all_sections;
+
+  /** @brief The sections which are not hidden, in the same order as all_sections */
+  std::vector<std::string> sections;
+
+  /** @brief The symbols under each section which is not hidden */
+  std::unordered_map<std::string, std::vector<std::string>> symbols;
+
+  /**
+   * @brief The type hash of the base class of each plugin under each section, for plugins whose record identifies it
+   * (see PluginRecord::base_type)
+   */
+  std::unordered_map<std::string, std::unordered_map<std::string, std::uint64_t>> base_types;
+
+  /**
+   * @brief Find the indexed symbols under a section
+   * @return The symbols, or nullptr if the section is not indexed (i.e. it is hidden or does not exist)
+   */
+  const std::vector<std::string>* findSymbols(const std::string& section) const
+  {
+    const auto it = symbols.find(section);
+    return (it != symbols.end()) ? &it->second : nullptr;
+  }
+
+  /**
+   * @brief Find the type hash of the base class of a plugin
+   * @return The type hash, or zero if the record of the plugin does not identify its base class
+   */
+  std::uint64_t findBaseType(const std::string& section, const std::string& name) const
+  {
+    const auto it = base_types.find(section);
+    if (it == base_types.end())
+      return 0;
+
+    const auto plugin_it = it->second.find(name);
+    return (plugin_it != it->second.end()) ? plugin_it->second : 0;
+  }
+};
+
+/**
+ * @brief Read the sections of a library and the symbols under each section which is not hidden
+ * @details This parses the library file once, instead of once per query as getAllAvailableSections and
+ * getAllAvailableSymbols do.
+ * @param library The library to index
+ * @return The index of the library
+ */
+LibraryIndex indexLibrary(const boost::dll::shared_library& library);
+
+/**
+ * @brief Read the plugin records of a library file (see PluginRecord)
+ * @details Only the section headers and the PLUGIN_RECORD_SECTION section are read, so this is much cheaper than
+ * walking the symbol table, and the library need not be loaded, e.g. to check the plugins of a library before loading
+ * it. Records of another layout version are returned as well. Only ELF files in the byte order of this platform are
+ * supported.
+ * @param file The path of the library file
+ * @return The records in the order they appear in the file, or nothing if the file cannot be read, is not a supported
+ * ELF file or has no plugin records
+ */
+std::optional<std::vector<PluginRecord>> readPluginRecords(const std::string& file);
+
+/**
+ * @brief Find the type hash of the base class of a plugin in the plugin records of a library file
+ * @details This reads the records with readPluginRecords, so the library need not be loaded. Records of another layout
+ * version and plugins under hidden sections are ignored, as in indexPluginRecords.
+ * @param file The path of the library file
+ * @param section The section of the plugin
+ * @param name The plugin name
+ * @return The type hash, which is zero if the record does not identify the base class, or nothing if the file has no
+ * record of the plugin
+ */
+std::optional<std::uint64_t> findRecordedBaseType(const std::string& file, const std::string& section,
+                                                  const std::string& name);
+
+/**
+ * @brief Index a library from its plugin records instead of its symbol table
+ * @details The sections are read from the section headers and the symbols under each section from the plugin records.
+ * The index is the same as the one built by indexLibrary as long as all plugins of the library were exported with the
+ * export macros, which emit the records. To detect plugins exported without them, the number of records under each
+ * section is checked against the number of exported symbols under that section in the dynamic symbol table, which is
+ * read without the string table.
+ * @param file The path of the library file
+ * @return The index, or nothing if the file has no plugin records, has records of another layout version, has a
+ * section which is not hidden and has no records, or has a section with a different number of exported symbols than
+ * records (e.g. plugins exported without the export macros)
+ */
+std::optional<LibraryIndex> indexPluginRecords(const std::string& file);
+
 /**
  * @brief Give library name without prefix and suffix it will return the library name with the prefix and suffix
  *
@@ -103,6 +265,135 @@ std::vector<std::string> getAllSearchPaths(const std::string& search_paths_env,
 std::vector<std::string> getAllLibraryNames(const std::string& search_libraries_env,
                                             const std::vector<std::string>& existing_search_libraries);
 
+/**
+ * @brief Read the plugin libraries a library depends on from its sidecar manifest
+ * @details The manifest is a text file next to the library file, named after the library file with the suffix `.deps`
+ * (e.g. `libmy_plugins.so.deps`). It lists one library name per line, as listed in PluginLoader::search_libraries.
+ * Empty lines and lines starting with '#' are ignored.
+ * @param library_file The path of the library file
+ * @return The names of the libraries it depends on, or an empty list if it has no manifest
+ */
+std::vector<std::string> readLibraryDependencies(const std::string& library_file);
+
+/**
+ * @brief Group the nodes of a dependency graph into waves, such that the dependencies of each node are in earlier waves
+ * @param names The names of the nodes, used for error messages
+ * @param dependencies The indexes of the nodes each node depends on
+ * @throws PluginLoaderException if the dependencies are cyclic
+ * @return The indexes of the nodes in each wave, in the order of the nodes
+ */
+std::vector<std::vector<std::size_t>> getDependencyWaves(const std::vector<std::string>& names,
+                                                         const std::vector<std::vector<std::size_t>>& dependencies);
+
+/**
+ * @brief Run a task for each index in [0, count) on a number of threads
+ * @details Indexes are handed out dynamically, and the calling thread takes part. The other threads come from a
+ * process-wide pool of workers, which is started on first use and reused by all calls, so a call does not create
+ * threads and a single index runs on the calling thread alone. Tasks may call this function themselves. If a task
+ * throws, the remaining indexes are still processed and the first exception is rethrown once all threads finished.
+ * @param count The number of indexes
+ * @param task The task, invoked as `task(index)`
+ */
+void parallelFor(std::size_t count, const std::function<void(std::size_t)>& task);
+
+/**
+ * @brief Ask the operating system to read files into the page cache ahead of use
+ * @details Issues posix_fadvise(POSIX_FADV_WILLNEED) on the files from a number of threads. Files which cannot be
+ * opened are skipped. This does nothing on platforms without posix_fadvise.
+ * @param file_paths The files to prefetch
+ * @return The number of files for which the advice was issued
+ */
+std::size_t prefetchFiles(const std::vector<std::string>& file_paths);
+
+/** @brief The names of the entries of a directory, read in a single pass */
+struct DirectoryListing
+{
+  /**
+   * @brief The modification time of the directory when it was listed, in nanoseconds since the epoch
+   * @details This is -1 if the time could not be read, or if the directory was modified so recently that a later change
+   * may leave the time unchanged (file system timestamps have a limited resolution). Such a listing is never current.
+   */
+  std::int64_t modified{ -1 };
+
+  /** @brief The names of the entries of the directory, or none if it could not be read */
+  std::unordered_set<std::string> entries;
+};
+
+/**
+ * @brief List the entries of a directory
+ * @param directory The directory
+ * @return The listing, which is empty if the directory does not exist or cannot be read
+ */
+DirectoryListing listDirectory(const std::string& directory);
+
+/**
+ * @brief Get the modification time of a file or directory
+ * @details The time has nanosecond resolution on Linux and second resolution elsewhere.
+ * @param path The path of the file or directory
+ * @return The modification time in nanoseconds since the epoch, or -1 if it cannot be read
+ */
+std::int64_t getModificationTime(const std::string& path);
+
+/**
+ * @brief Check if a file name matches a glob pattern
+ * @details '*' matches any sequence of characters and '?' matches any single character. Other characters match
+ * themselves.
+ * @param name The file name
+ * @param pattern The pattern, e.g. `lib*_plugins.so`
+ * @return True if the name matches the pattern
+ */
+bool matchesGlob(const std::string& name, const std::string& pattern);
+
+/**
+ * @brief Check if a file starts with the header of a shared library (ELF, Mach-O or PE)
+ * @details Only the first bytes of the file are read.
+ * @param file The path of the file
+ * @return True if the file could be read and has the header of a shared library
+ */
+bool hasSharedLibraryHeader(const std::string& file);
+
+/** @brief The library files found by discoverLibraries */
+struct DiscoveredLibraries
+{
+  /** @brief The paths of the library files, in the order of the directories they were found in and then by name */
+  std::vector<std::string> files;
+
+  /** @brief The directories which were scanned and their modification times (see DirectoryListing::modified) */
+  std::vector<std::pair<std::string, std::int64_t>> directories;
+};
+
+/**
+ * @brief Find the shared library files whose names match any of a number of glob patterns in directories
+ * @details The directories are walked level by level, listing the directories of each level in parallel. Files whose
+ * names match are then checked for the header of a shared library in parallel, so that other files with matching names
+ * are skipped without loading them.
+ * @param directories The directories to scan
+ * @param patterns The glob patterns matched against file names (see matchesGlob)
+ * @param max_depth The depth of subdirectories to scan, where zero only scans the directories themselves
+ * @return The absolute paths of the library files found and the directories which were scanned
+ */
+DiscoveredLibraries discoverLibraries(const std::vector<std::string>& directories,
+                                      const std::vector<std::string>& patterns, std::size_t max_depth);
+
+/**
+ * @brief Ask the operating system to fault in the mapped segments of a loaded library (madvise(MADV_WILLNEED))
+ * @details This is only supported on Linux.
+ * @param library The loaded library
+ * @return True if the advice was issued for at least one segment
+ */
+bool prefaultLibrary(const boost::dll::shared_library& library);
+
+/**
+ * @brief Get the current generation of the library caches of all plugin loaders
+ * @details The generation advances whenever a plugin loader adds libraries to or drops libraries from its cache, or is
+ * cleared, assigned or destroyed. Per-thread caches of plugin resolutions record the generation they were filled in and
+ * are only used while it is current.
+ */
+std::uint64_t getLibraryCacheGeneration();
+
+/** @brief Advance the generation of the library caches, invalidating all per-thread caches of plugin resolutions */
+void advanceLibraryCacheGeneration();
+
 /**
  * @brief Utility function to add library containing symbol to the search env variable
  *  * In some cases the name and location of a library is unknown at runtime, but a symbol can
@@ -0,0 +1,222 @@
+/**
+ *
+ * @copyright Copyright (c) 2021, Southwest Research Institute
+ *
+ * @par License
+ * Software License Agreement (Apache License)
+ * @par
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * @par
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// STD
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Boost
+#include <boost/filesystem/path.hpp>
+
+// Boost Plugin Loader
+#include <boost_plugin_loader/chrome_trace_listener.h>
+#include <boost_plugin_loader/utils.h>
+
+namespace boost_plugin_loader
+{
+namespace
+{
+/** @brief Escape a string for use as a JSON string literal */
+std::string escapeJson(const std::string& value)
+{
+  std::string escaped;
+  escaped.reserve(value.size());
+  for (const char c : value)
+  {
+    switch (c)
+    {
+      case '"':
+        escaped += "\\\"";
+        break;
+      case '\\':
+        escaped += "\\\\";
+        break;
+      case '\n':
+        escaped += "\\n";
+        break;
+      case '\r':
+        escaped += "\\r";
+        break;
+      case '\t':
+        escaped += "\\t";
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20)
+        {
+          std::array<char, 7> buffer{};
+          std::snprintf(buffer.data(), buffer.size(), "\\u%04x", static_cast<unsigned>(c));
+          escaped += buffer.data();
+        }
+        else
+        {
+          escaped += c;
+        }
+    }
+  }
+  return escaped;
+}
+
+/** @brief Convert a duration to the fractional microseconds used by the trace-event format */
+double toMicroseconds(PluginLoaderEvent::Clock::duration duration)
+{
+  return std::chrono::duration<double, std::micro>(duration).count();
+}
+
+/** @brief Get a short display name for a library path */
+std::string libraryDisplayName(const std::string& library)
+{
+  const std::string filename = boost::filesystem::path(library).filename().string();
+  return filename.empty() ? library : filename;
+}
+}  // namespace
+
+ChromeTraceListener::ChromeTraceListener() : origin_(PluginLoaderEvent::Clock::now())
+{
+}
+
+void ChromeTraceListener::onLibraryLoadStart(const PluginLoaderEvent& event)
+{
+  add('B', "load " + libraryDisplayName(event.library), "library", event, { { "library", event.library } });
+}
+
+void ChromeTraceListener::onLibraryLoadEnd(const PluginLoaderEvent& event)
+{
+  add('E', "load " + libraryDisplayName(event.library), "library", event,
+      { { "library", event.library }, { "success", event.success ? "true" : "false" } });
+}
+
+void ChromeTraceListener::onSymbolResolved(const PluginLoaderEvent& event)
+{
+  add('i', "resolve " + event.plugin, "symbol", event, { { "plugin", event.plugin }, { "library", event.library } });
+}
+
+void ChromeTraceListener::onInstanceCreated(const PluginLoaderEvent& event)
+{
+  add('X', "create " + event.plugin, "instance", event, { { "plugin", event.plugin }, { "library", event.library } });
+}
+
+void ChromeTraceListener::onFailure(const PluginLoaderEvent& event)
+{
+  add('i', "failure", "error", event,
+      { { "plugin", event.plugin }, { "library", event.library }, { "message", event.message } });
+}
+
+void ChromeTraceListener::onLibraryEvicted(const PluginLoaderEvent& event)
+{
+  add('i', "evict " + libraryDisplayName(event.library), "library", event, { { "library", event.library } });
+}
+
+void ChromeTraceListener::onLoadWave(const PluginLoaderEvent& event)
+{
+  add('X', "load wave", "library", event, { { "libraries", event.library } });
+}
+
+void ChromeTraceListener::add(char phase, std::string name, std::string category, const PluginLoaderEvent& event,
+                              std::vector<std::pair<std::string, std::string>> args)
+{
+  Record record;
+  record.phase = phase;
+  record.name = std::move(name);
+  record.category = std::move(category);
+  record.timestamp = event.timestamp;
+  record.duration = event.duration;
+  record.args = std::move(args);
+
+  // A library load end event is stamped when the load finished
+  if (phase == 'E')
+    record.timestamp += event.duration;
+
+  const std::scoped_lock lock(mutex_);
+  auto it = threads_.find(event.thread_id);
+  if (it == threads_.end())
+    it = threads_.emplace(event.thread_id, static_cast<int>(threads_.size()) + 1).first;
+
+  record.thread = it->second;
+  records_.push_back(std::move(record));
+}
+
+void ChromeTraceListener::write(std::ostream& os) const
+{
+  const std::scoped_lock lock(mutex_);
+  os << std::fixed << std::setprecision(3);
+  os << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+  // Metadata events naming the process and threads
+  os << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"boost_plugin_loader\"}}";
+  for (const auto& thread : threads_)
+  {
+    os << ",{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << thread.second
+       << ",\"args\":{\"name\":\"thread " << thread.second << "\"}}";
+  }
+
+  for (const Record& record : records_)
+  {
+    os << ",{\"name\":\"" << escapeJson(record.name) << "\",\"cat\":\"" << record.category << "\",\"ph\":\""
+       << record.phase << "\",\"ts\":" << toMicroseconds(record.timestamp - origin_) << ",\"pid\":1,\"tid\":"
+       << record.thread;
+
+    if (record.phase == 'X')
+      os << ",\"dur\":" << toMicroseconds(record.duration);
+    else if (record.phase == 'i')
+      os << ",\"s\":\"t\"";
+
+    os << ",\"args\":{";
+    for (std::size_t i = 0; i < record.args.size(); ++i)
+    {
+      os << (i == 0 ? "" : ",") << "\"" << escapeJson(record.args[i].first) << "\":\""
+         << escapeJson(record.args[i].second) << "\"";
+    }
+    os << "}}";
+  }
+
+  os << "]}\n";
+}
+
+void ChromeTraceListener::save(const std::string& file_path) const
+{
+  std::ofstream file(file_path);
+  if (!file)
+    throw PluginLoaderException("Failed to open trace file for writing: " + file_path);
+
+  write(file);
+}
+
+std::size_t ChromeTraceListener::size() const
+{
+  const std::scoped_lock lock(mutex_);
+  return records_.size();
+}
+
+void ChromeTraceListener::clear()
+{
+  const std::scoped_lock lock(mutex_);
+  records_.clear();
+  threads_.clear();
+  origin_ = PluginLoaderEvent::Clock::now();
+}
+
+}  // namespace boost_plugin_loader
@@ -0,0 +1,245 @@
+/**
+ *
+ * @copyright Copyright (c) 2021, Southwest Research Institute
+ *
+ * @par License
+ * Software License Agreement (Apache License)
+ * @par
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * @par
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// STD
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <set>
+#include <string_view>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+// Boost Plugin Loader
+#include <boost_plugin_loader/frozen_plugin_table.h>
+#include <boost_plugin_loader/utils.h>
+
+namespace boost_plugin_loader
+{
+namespace
+{
+/** @brief The number of seeds for the key hash which are tried before giving up */
+constexpr std::uint64_t MAX_HASH_SEEDS{ 16 };
+
+/** @brief Scramble the bits of a hash (the finalizer of SplitMix64) */
+std::uint64_t mix(std::uint64_t hash)
+{
+  hash = (hash ^ (hash >> 30U)) * 0xBF58476D1CE4E5B9ULL;
+  hash = (hash ^ (hash >> 27U)) * 0x94D049BB133111EBULL;
+  return hash ^ (hash >> 31U);
+}
+
+/** @brief Hash the section and name of a key (FNV-1a) */
+std::uint64_t hashKey(std::string_view section, std::string_view name, std::uint64_t seed)
+{
+  std::uint64_t hash{ 14695981039346656037ULL ^ seed };
+  for (const char c : section)
+    hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ULL;
+
+  // Mix in the length of the section, so that the boundary between the section and the name is part of the hash
+  hash = (hash ^ section.size()) * 1099511628211ULL;
+  for (const char c : name)
+    hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ULL;
+
+  return mix(hash);
+}
+
+/** @brief Get the slot of a key hash with the seed of its bucket */
+std::size_t getSlot(std::uint64_t hash, std::uint32_t bucket_seed, std::size_t slot_count)
+{
+  return static_cast<std::size_t>(mix(hash ^ (bucket_seed * 0x9E3779B97F4A7C15ULL)) % slot_count);
+}
+
+/**
+ * @brief Assign each bucket of keys a seed which maps its keys to free slots, largest buckets first
+ * @details There are as many buckets and slots as keys, so most buckets hold one or two keys.
+ * @param hashes The hashes of the keys
+ * @param bucket_seeds Set to the seed of each bucket
+ * @param key_slots Set to the slot of each key
+ * @return False if no seed was found for one of the buckets, e.g. because two keys have the same hash
+ */
+bool assignSlots(const std::vector<std::uint64_t>& hashes, std::vector<std::uint32_t>& bucket_seeds,
+                 std::vector<std::size_t>& key_slots)
+{
+  const std::size_t count = hashes.size();
+  std::vector<std::vector<std::size_t>> buckets(count);
+  for (std::size_t i = 0; i < count; ++i)
+    buckets[hashes[i] % count].push_back(i);
+
+  std::vector<std::size_t> order(count);
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(),
+                   [&buckets](std::size_t lhs, std::size_t rhs) { return buckets[lhs].size() > buckets[rhs].size(); });
+
+  // The last buckets need about as many tries as there are slots to find one of the few free slots
+  const auto max_bucket_seed = static_cast<std::uint32_t>(
+      std::min<std::uint64_t>(std::max<std::uint64_t>(65536, 32 * std::uint64_t{ count }),
+                              std::numeric_limits<std::uint32_t>::max()));
+
+  std::vector<bool> used(count, false);
+  std::vector<std::size_t> slots;
+  bucket_seeds.assign(count, 0);
+  key_slots.assign(count, 0);
+  for (const std::size_t b : order)
+  {
+    const std::vector<std::size_t>& bucket = buckets[b];
+    if (bucket.empty())
+      break;
+
+    bool found = false;
+    for (std::uint32_t seed = 0; !found && seed < max_bucket_seed; ++seed)
+    {
+      slots.clear();
+      found = true;
+      for (const std::size_t key : bucket)
+      {
+        const std::size_t slot = getSlot(hashes[key], seed, count);
+        if (used[slot] || std::find(slots.begin(), slots.end(), slot) != slots.end())
+        {
+          found = false;
+          break;
+        }
+        slots.push_back(slot);
+      }
+
+      if (!found)
+        continue;
+
+      bucket_seeds[b] = seed;
+      for (std::size_t i = 0; i < bucket.size(); ++i)
+      {
+        used[slots[i]] = true;
+        key_slots[bucket[i]] = slots[i];
+      }
+    }
+
+    if (!found)
+      return false;
+  }
+
+  return true;
+}
+}  // namespace
+
+FrozenPluginTable::FrozenPluginTable(std::vector<Entry> entries)
+{
+  if (entries.size() >= NAME_KEY)
+    throw PluginLoaderException("Too many plugins for the plugin lookup table");
+
+  // Group the entries by section, keeping them in search order within each section
+  std::vector<std::size_t> order(entries.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&entries](std::size_t lhs, std::size_t rhs) {
+    return entries[lhs].section < entries[rhs].section;
+  });
+
+  std::vector<std::size_t> positions(entries.size());
+  entries_.reserve(entries.size());
+  for (const std::size_t i : order)
+  {
+    positions[i] = entries_.size();
+    entries_.push_back(std::move(entries[i]));
+  }
+
+  for (std::size_t first = 0; first < entries_.size();)
+  {
+    std::size_t last = first + 1;
+    while (last < entries_.size() && entries_[last].section == entries_[first].section)
+      ++last;
+
+    sections_.emplace_back(first, last);
+    first = last;
+  }
+
+  // Key the first entry in search order of each section and name, and of each name
+  std::vector<std::uint32_t> keys;
+  std::set<std::pair<std::string_view, std::string_view>> section_names;
+  std::unordered_set<std::string_view> names;
+  for (const std::size_t position : positions)
+  {
+    const Entry& entry = entries_[position];
+    if (!entry.section.empty() && section_names.emplace(entry.section, entry.name).second)
+      keys.push_back(static_cast<std::uint32_t>(position));
+
+    if (names.insert(entry.name).second)
+      keys.push_back(static_cast<std::uint32_t>(position) | NAME_KEY);
+  }
+
+  if (keys.empty())
+    return;
+
+  std::vector<std::uint64_t> hashes(keys.size());
+  std::vector<std::size_t> key_slots;
+  for (std::uint64_t attempt = 0; attempt < MAX_HASH_SEEDS; ++attempt)
+  {
+    seed_ = mix(attempt + 1);
+    for (std::size_t i = 0; i < keys.size(); ++i)
+    {
+      const Entry& entry = entries_[keys[i] & ~NAME_KEY];
+      hashes[i] = hashKey((keys[i] & NAME_KEY) != 0 ? std::string_view() : std::string_view(entry.section), entry.name,
+                          seed_);
+    }
+
+    if (!assignSlots(hashes, bucket_seeds_, key_slots))
+      continue;
+
+    slots_.assign(keys.size(), 0);
+    for (std::size_t i = 0; i < keys.size(); ++i)
+      slots_[key_slots[i]] = keys[i];
+
+    return;
+  }
+
+  throw PluginLoaderException("Failed to build the plugin lookup table");
+}
+
+const FrozenPluginTable::Entry* FrozenPluginTable::find(std::string_view section, std::string_view name) const noexcept
+{
+  if (slots_.empty())
+    return nullptr;
+
+  const std::size_t count = slots_.size();
+  const std::uint64_t hash = hashKey(section, name, seed_);
+  const std::uint32_t key = slots_[getSlot(hash, bucket_seeds_[hash % count], count)];
+
+  // Keys which are not in the table map to an arbitrary slot, so the key of the slot is compared
+  const Entry& entry = entries_[key & ~NAME_KEY];
+  const bool name_key = (key & NAME_KEY) != 0;
+  if (name_key != section.empty() || entry.name != name || (!name_key && entry.section != section))
+    return nullptr;
+
+  return &entry;
+}
+
+FrozenPluginTable::Range FrozenPluginTable::findSection(std::string_view section) const noexcept
+{
+  const auto it = std::lower_bound(sections_.begin(), sections_.end(), section,
+                                   [this](const std::pair<std::size_t, std::size_t>& range, std::string_view value) {
+                                     return entries_[range.first].section < value;
+                                   });
+  if (it == sections_.end() || entries_[it->first].section != section)
+    return {};
+
+  return { entries_.data() + it->first, entries_.data() + it->second };  // NOLINT
+}
+
+}  // namespace boost_plugin_loader
@@ -0,0 +1,434 @@
+/**
+ *
+ * @copyright Copyright (c) 2021, Southwest Research Institute
+ *
+ * @par License
+ * Software License Agreement (Apache License)
+ * @par
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * @par
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// STD
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Boost
+#include <boost/filesystem/operations.hpp>
+#include <boost/filesystem/path.hpp>
+#include <boost/system/error_code.hpp>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Boost Plugin Loader
+#include <boost_plugin_loader/library_manifest.h>
+#include <boost_plugin_loader/utils.h>
+
+namespace boost_plugin_loader
+{
+namespace
+{
+constexpr std::array<char, 8> MANIFEST_MAGIC{ 'B', 'P', 'L', 'M', 'N', 'F', 'S', 'T' };
+constexpr std::uint32_t BYTE_ORDER_MARK{ 0x01020304 };
+
+/** @brief The header at the start of a manifest file */
+struct ManifestHeader
+{
+  std::array<char, 8> magic{};
+  std::uint32_t version{ 0 };
+  std::uint32_t byte_order{ 0 };
+  std::uint64_t configuration_hash{ 0 };
+  std::uint64_t library_count{ 0 };
+  std::uint64_t size{ 0 };
+};
+
+/** @brief Appends values and length-prefixed strings to a buffer */
+class ManifestWriter
+{
+public:
+  template <typename T>
+  void write(const T& value)
+  {
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    data.append(reinterpret_cast<const char*>(&value), sizeof(T));
+  }
+
+  void writeString(const std::string& value)
+  {
+    write(static_cast<std::uint32_t>(value.size()));
+    data.append(value);
+  }
+
+  std::string data;
+};
+
+/** @brief Reads values and length-prefixed strings from a buffer, failing instead of reading past its end */
+class ManifestReader
+{
+public:
+  ManifestReader(const char* data, std::size_t size, std::size_t offset) : data_(data), size_(size), offset_(offset) {}
+
+  template <typename T>
+  bool read(T& value)
+  {
+    if (size_ - offset_ < sizeof(T))
+      return false;
+
+    std::memcpy(&value, data_ + offset_, sizeof(T));  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    offset_ += sizeof(T);
+    return true;
+  }
+
+  bool readString(std::string_view& value)
+  {
+    std::uint32_t length{ 0 };
+    if (!read(length) || size_ - offset_ < length)
+      return false;
+
+    value = std::string_view(data_ + offset_, length);  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    offset_ += length;
+    return true;
+  }
+
+  std::size_t offset() const { return offset_; }
+
+private:
+  const char* data_;
+  std::size_t size_;
+  std::size_t offset_;
+};
+
+/**
+ * @brief Read the record of a library
+ * @param index The index to fill in, or nullptr to only check and skip the record
+ * @return False if the record is malformed
+ */
+bool readRecord(ManifestReader& reader, std::string_view& name, std::string_view& file, std::uint64_t& size,
+                std::int64_t& modified, LibraryIndex* index)
+{
+  std::uint32_t section_count{ 0 };
+  if (!reader.readString(name) || !reader.readString(file) || !reader.read(size) || !reader.read(modified) ||
+      !reader.read(section_count))
+    return false;
+
+  for (std::uint32_t i = 0; i < section_count; ++i)
+  {
+    std::string_view section;
+    std::uint8_t hidden{ 0 };
+    if (!reader.readString(section) || !reader.read(hidden))
+      return false;
+
+    if (index != nullptr)
+      index->all_sections.emplace_back(section);
+
+    if (hidden != 0)
+      continue;
+
+    std::uint32_t symbol_count{ 0 };
+    if (!reader.read(symbol_count))
+      return false;
+
+    std::vector<std::string>* symbols = nullptr;
+    if (index != nullptr)
+    {
+      index->sections.emplace_back(section);
+      symbols = &index->symbols[std::string(section)];
+      symbols->reserve(symbol_count);
+    }
+
+    for (std::uint32_t j = 0; j < symbol_count; ++j)
+    {
+      std::string_view symbol;
+      std::uint64_t base_type{ 0 };
+      if (!reader.readString(symbol) || !reader.read(base_type))
+        return false;
+
+      if (symbols == nullptr)
+        continue;
+
+      symbols->emplace_back(symbol);
+      if (base_type != 0)
+        index->base_types[std::string(section)][symbols->back()] = base_type;
+    }
+  }
+
+  return true;
+}
+
+/** @brief Check if a library file has the size and modification time recorded for it */
+bool isUnchanged(const std::string& file, std::uint64_t size, std::int64_t modified)
+{
+  boost::system::error_code ec;
+  const std::uintmax_t file_size = boost::filesystem::file_size(file, ec);
+  return !ec && file_size == size && modified >= 0 && getModificationTime(file) == modified;
+}
+}  // namespace
+
+LibraryManifest::BuildLock::BuildLock(const std::string& file_path)
+{
+#ifndef _WIN32
+  const std::string lock_path = file_path + ".lock";
+  fd_ = ::open(lock_path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);  // NOLINT(cppcoreguidelines-pro-type-vararg)
+  if (fd_ < 0)
+    return;
+
+  while (::flock(fd_, LOCK_EX) != 0 && errno == EINTR)
+  {
+  }
+#else
+  (void)file_path;
+#endif
+}
+
+LibraryManifest::BuildLock::~BuildLock()
+{
+#ifndef _WIN32
+  if (fd_ >= 0)
+  {
+    ::flock(fd_, LOCK_UN);
+    ::close(fd_);
+  }
+#endif
+}
+
+LibraryManifest::~LibraryManifest()
+{
+#ifndef _WIN32
+  if (mapped_)
+    ::munmap(const_cast<char*>(data_), size_);  // NOLINT(cppcoreguidelines-pro-type-const-cast)
+#endif
+}
+
+LibraryManifest::ConstPtr LibraryManifest::map(const std::string& file_path, std::uint64_t configuration_hash)
+{
+  std::shared_ptr<LibraryManifest> manifest(new LibraryManifest());  // NOLINT(cppcoreguidelines-owning-memory)
+#ifndef _WIN32
+  const int fd = ::open(file_path.c_str(), O_RDONLY | O_CLOEXEC);  // NOLINT(cppcoreguidelines-pro-type-vararg)
+  if (fd < 0)
+    return nullptr;
+
+  struct stat status{};
+  if (::fstat(fd, &status) != 0 || static_cast<std::size_t>(status.st_size) < sizeof(ManifestHeader))
+  {
+    ::close(fd);
+    return nullptr;
+  }
+
+  void* data = ::mmap(nullptr, static_cast<std::size_t>(status.st_size), PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (data == MAP_FAILED)  // NOLINT(cppcoreguidelines-pro-type-cstyle-cast)
+    return nullptr;
+
+  manifest->data_ = static_cast<const char*>(data);
+  manifest->size_ = static_cast<std::size_t>(status.st_size);
+  manifest->mapped_ = true;
+#else
+  std::ifstream file(file_path, std::ios::binary);
+  if (!file)
+    return nullptr;
+
+  manifest->buffer_.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+  manifest->data_ = manifest->buffer_.data();
+  manifest->size_ = manifest->buffer_.size();
+  if (manifest->size_ < sizeof(ManifestHeader))
+    return nullptr;
+#endif
+
+  ManifestHeader header;
+  std::memcpy(&header, manifest->data_, sizeof(ManifestHeader));
+  if (header.magic != MANIFEST_MAGIC || header.version != VERSION || header.byte_order != BYTE_ORDER_MARK ||
+      header.configuration_hash != configuration_hash || header.size != manifest->size_ ||
+      !manifest->indexRecords(header.library_count))
+    return nullptr;
+
+  manifest->configuration_hash_ = configuration_hash;
+  return manifest;
+}
+
+void LibraryManifest::publish(const std::string& file_path, std::uint64_t configuration_hash,
+                              const std::vector<Entry>& entries)
+{
+  ManifestHeader header;
+  header.magic = MANIFEST_MAGIC;
+  header.version = VERSION;
+  header.byte_order = BYTE_ORDER_MARK;
+  header.configuration_hash = configuration_hash;
+  header.library_count = entries.size();
+
+  ManifestWriter writer;
+  writer.write(header);
+  for (const Entry& entry : entries)
+  {
+    writer.writeString(entry.name);
+    writer.writeString(entry.file);
+    writer.write(static_cast<std::uint64_t>(entry.size));
+    writer.write(entry.modified);
+    writer.write(static_cast<std::uint32_t>(entry.index.all_sections.size()));
+    for (const std::string& section : entry.index.all_sections)
+    {
+      const std::vector<std::string>* symbols = entry.index.findSymbols(section);
+      writer.writeString(section);
+      writer.write(static_cast<std::uint8_t>(symbols == nullptr ? 1 : 0));
+      if (symbols == nullptr)
+        continue;
+
+      writer.write(static_cast<std::uint32_t>(symbols->size()));
+      for (const std::string& symbol : *symbols)
+      {
+        writer.writeString(symbol);
+        writer.write(entry.index.findBaseType(section, symbol));
+      }
+    }
+  }
+
+  header.size = writer.data.size();
+  std::memcpy(writer.data.data(), &header, sizeof(ManifestHeader));
+
+  // Write the manifest under a temporary name and rename it into place, so that readers never see a partial manifest
+  boost::system::error_code ec;
+  const std::string temp_path = file_path + boost::filesystem::unique_path(".%%%%%%%%.tmp", ec).string();
+  {
+    std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+    file.write(writer.data.data(), static_cast<std::streamsize>(writer.data.size()));
+    if (ec || !file.flush())
+    {
+      boost::filesystem::remove(temp_path, ec);
+      throw PluginLoaderException("Failed to write plugin library manifest: " + file_path);
+    }
+  }
+
+  boost::filesystem::rename(temp_path, file_path, ec);
+  if (ec)
+  {
+    boost::filesystem::remove(temp_path, ec);
+    throw PluginLoaderException("Failed to publish plugin library manifest: " + file_path);
+  }
+}
+
+std::uint64_t LibraryManifest::hashConfiguration(const std::vector<std::string>& values)
+{
+  std::uint64_t hash{ 14695981039346656037ULL };
+  for (const std::string& value : values)
+  {
+    // Terminate each value, so that the boundaries between values are part of the hash
+    for (const char c : value)
+      hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ULL;
+    hash = hash * 1099511628211ULL;
+  }
+
+  return hash;
+}
+
+std::optional<LibraryIndex> LibraryManifest::findIndex(const std::string& file, std::uintmax_t size,
+                                                       std::int64_t modified) const
+{
+  const auto it = records_.find(file);
+  if (it == records_.end())
+    return std::nullopt;
+
+  ManifestReader reader(data_, size_, it->second);
+  std::string_view record_name;
+  std::string_view record_file;
+  std::uint64_t record_size{ 0 };
+  std::int64_t record_modified{ -1 };
+  LibraryIndex index;
+  if (!readRecord(reader, record_name, record_file, record_size, record_modified, &index) || record_size != size ||
+      record_modified < 0 || record_modified != modified)
+    return std::nullopt;
+
+  return index;
+}
+
+std::vector<LibraryManifest::Entry> LibraryManifest::getEntries() const
+{
+  std::vector<Entry> entries;
+  entries.reserve(record_offsets_.size());
+  for (const std::size_t offset : record_offsets_)
+  {
+    ManifestReader reader(data_, size_, offset);
+    std::string_view name;
+    std::string_view file;
+    Entry entry;
+    std::uint64_t size{ 0 };
+    readRecord(reader, name, file, size, entry.modified, &entry.index);
+    entry.name = name;
+    entry.file = file;
+    entry.size = size;
+    entries.push_back(std::move(entry));
+  }
+
+  return entries;
+}
+
+bool LibraryManifest::isCurrent() const
+{
+  for (const auto& record : records_)
+  {
+    ManifestReader reader(data_, size_, record.second);
+    std::string_view name;
+    std::string_view file;
+    std::uint64_t size{ 0 };
+    std::int64_t modified{ -1 };
+    if (!readRecord(reader, name, file, size, modified, nullptr) || !isUnchanged(std::string(file), size, modified))
+      return false;
+  }
+
+  return true;
+}
+
+std::uint64_t LibraryManifest::getConfigurationHash() const
+{
+  return configuration_hash_;
+}
+
+std::size_t LibraryManifest::size() const
+{
+  return records_.size();
+}
+
+bool LibraryManifest::indexRecords(std::uint64_t library_count)
+{
+  ManifestReader reader(data_, size_, sizeof(ManifestHeader));
+  for (std::uint64_t i = 0; i < library_count; ++i)
+  {
+    const std::size_t offset = reader.offset();
+    std::string_view name;
+    std::string_view file;
+    std::uint64_t size{ 0 };
+    std::int64_t modified{ -1 };
+    if (!readRecord(reader, name, file, size, modified, nullptr))
+      return false;
+
+    records_.emplace(file, offset);
+    record_offsets_.push_back(offset);
+  }
+
+  return reader.offset() == size_;
+}
+
+}  // namespace boost_plugin_loader
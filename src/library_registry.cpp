@@ -0,0 +1,75 @@
+/**
+ *
+ * @copyright Copyright (c) 2021, Southwest Research Institute
+ *
+ * @par License
+ * Software License Agreement (Apache License)
+ * @par
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * @par
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// STD
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <string>
+
+// Boost Plugin Loader
+#include <boost_plugin_loader/library_registry.h>
+
+namespace boost_plugin_loader
+{
+LibraryRegistry& LibraryRegistry::instance()
+{
+  static LibraryRegistry registry;
+  return registry;
+}
+
+std::shared_ptr<LoadedLibrary> LibraryRegistry::find(const std::string& file) const
+{
+  const std::scoped_lock lock(mutex_);
+  const auto it = libraries_.find(file);
+  return (it != libraries_.end()) ? it->second.lock() : nullptr;
+}
+
+std::shared_ptr<LoadedLibrary> LibraryRegistry::insert(const std::string& file,
+                                                       const std::shared_ptr<LoadedLibrary>& library)
+{
+  const std::scoped_lock lock(mutex_);
+  std::weak_ptr<LoadedLibrary>& entry = libraries_[file];
+  std::shared_ptr<LoadedLibrary> registered = entry.lock();
+  if (registered != nullptr)
+    return registered;
+
+  entry = library;
+
+  // Remove the entries of libraries which were destroyed, once the registry has grown enough to amortize the cost
+  if (libraries_.size() >= prune_threshold_)
+  {
+    for (auto it = libraries_.begin(); it != libraries_.end();)
+      it = it->second.expired() ? libraries_.erase(it) : std::next(it);
+
+    prune_threshold_ = std::max<std::size_t>(16, 2 * libraries_.size());
+  }
+
+  return library;
+}
+
+std::size_t LibraryRegistry::size() const
+{
+  const std::scoped_lock lock(mutex_);
+  return static_cast<std::size_t>(
+      std::count_if(libraries_.begin(), libraries_.end(), [](const auto& entry) { return !entry.second.expired(); }));
+}
+
+}  // namespace boost_plugin_loader
@@ -0,0 +1,167 @@
+/**
+ *
+ * @copyright Copyright (c) 2021, Southwest Research Institute
+ *
+ * @par License
+ * Software License Agreement (Apache License)
+ * @par
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * @par
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// STD
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Boost
+#include <boost/filesystem/operations.hpp>
+#include <boost/filesystem/path.hpp>
+#include <boost/system/error_code.hpp>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+// Boost Plugin Loader
+#include <boost_plugin_loader/library_watcher.h>
+#include <boost_plugin_loader/utils.h>
+
+namespace boost_plugin_loader
+{
+bool LibraryChanges::isChanged(const std::string& file) const
+{
+  if (overflow || std::find(files.begin(), files.end(), file) != files.end())
+    return true;
+
+  const std::string directory = boost::filesystem::path(file).parent_path().string();
+  return std::find(directories.begin(), directories.end(), directory) != directories.end();
+}
+
+#ifdef __linux__
+LibraryWatcher::LibraryWatcher() : fd_(::inotify_init1(IN_NONBLOCK | IN_CLOEXEC))
+{
+  if (fd_ < 0)
+    throw PluginLoaderException("Failed to initialize inotify: " + std::string(std::strerror(errno)));
+}
+
+LibraryWatcher::~LibraryWatcher()
+{
+  if (fd_ >= 0)
+    ::close(fd_);
+}
+
+bool LibraryWatcher::isSupported()
+{
+  return true;
+}
+
+bool LibraryWatcher::watchDirectory(const std::string& directory)
+{
+  boost::system::error_code ec;
+  const boost::filesystem::path canonical = boost::filesystem::canonical(directory, ec);
+  if (ec || !boost::filesystem::is_directory(canonical, ec))
+    return false;
+
+  const std::string canonical_str = canonical.string();
+  const auto it = std::find_if(directories_.begin(), directories_.end(),
+                               [&canonical_str](const auto& entry) { return entry.second == canonical_str; });
+  if (it != directories_.end())
+    return true;
+
+  const int wd = ::inotify_add_watch(fd_, canonical_str.c_str(),
+                                     IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE | IN_DELETE_SELF |
+                                         IN_MOVE_SELF);
+  if (wd < 0)
+    return false;
+
+  directories_[wd] = canonical_str;
+  return true;
+}
+
+LibraryChanges LibraryWatcher::poll()
+{
+  LibraryChanges changes;
+
+  // Buffer aligned for inotify_event as recommended by inotify(7)
+  alignas(inotify_event) std::array<char, 4096> buffer{};
+  for (;;)
+  {
+    const ssize_t length = ::read(fd_, buffer.data(), buffer.size());
+    if (length <= 0)
+      break;
+
+    for (ssize_t offset = 0; offset < length;)
+    {
+      const auto* event = reinterpret_cast<const inotify_event*>(buffer.data() + offset);  // NOLINT
+      offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+
+      // Events were dropped, so any watched file may have changed
+      if ((event->mask & IN_Q_OVERFLOW) != 0)
+      {
+        changes.overflow = true;
+        continue;
+      }
+
+      const auto it = directories_.find(event->wd);
+      if (it == directories_.end())
+        continue;
+
+      // A directory which was removed or moved away may be recreated with other files, and is watched again when it is
+      if ((event->mask & (IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED)) != 0)
+      {
+        if ((event->mask & IN_MOVE_SELF) != 0)
+          ::inotify_rm_watch(fd_, event->wd);
+
+        if (std::find(changes.directories.begin(), changes.directories.end(), it->second) == changes.directories.end())
+          changes.directories.push_back(it->second);
+
+        directories_.erase(it);
+        continue;
+      }
+
+      if (event->len == 0)
+        continue;
+
+      std::string file = (boost::filesystem::path(it->second) / event->name).string();  // NOLINT
+      if (std::find(changes.files.begin(), changes.files.end(), file) == changes.files.end())
+        changes.files.push_back(std::move(file));
+    }
+  }
+
+  return changes;
+}
+#else
+LibraryWatcher::LibraryWatcher() = default;
+
+LibraryWatcher::~LibraryWatcher() = default;
+
+bool LibraryWatcher::isSupported()
+{
+  return false;
+}
+
+bool LibraryWatcher::watchDirectory(const std::string& /*directory*/)
+{
+  return false;
+}
+
+LibraryChanges LibraryWatcher::poll()
+{
+  return {};
+}
+#endif
+
+}  // namespace boost_plugin_loader
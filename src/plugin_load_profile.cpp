@@ -0,0 +1,132 @@
+/**
+ *
+ * @copyright Copyright (c) 2021, Southwest Research Institute
+ *
+ * @par License
+ * Software License Agreement (Apache License)
+ * @par
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * @par
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// STD
+#include <algorithm>
+#include <fstream>
+#include <istream>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Boost Plugin Loader
+#include <boost_plugin_loader/plugin_load_profile.h>
+#include <boost_plugin_loader/utils.h>
+
+namespace boost_plugin_loader
+{
+namespace
+{
+const char* const PROFILE_HEADER = "# boost_plugin_loader profile v1";
+}  // namespace
+
+void PluginLoadProfile::onSymbolResolved(const PluginLoaderEvent& event)
+{
+  if (event.library_name.empty() || event.plugin.empty())
+    return;
+
+  const std::scoped_lock lock(mutex_);
+  addLocked(event.library_name, event.plugin);
+}
+
+std::vector<std::string> PluginLoadProfile::getLibraries() const
+{
+  std::vector<std::string> libraries;
+  const std::scoped_lock lock(mutex_);
+  for (const Entry& entry : entries_)
+  {
+    if (std::find(libraries.begin(), libraries.end(), entry.library) == libraries.end())
+      libraries.push_back(entry.library);
+  }
+
+  return libraries;
+}
+
+std::vector<PluginLoadProfile::Entry> PluginLoadProfile::getEntries() const
+{
+  const std::scoped_lock lock(mutex_);
+  return entries_;
+}
+
+void PluginLoadProfile::write(std::ostream& os) const
+{
+  const std::scoped_lock lock(mutex_);
+  os << PROFILE_HEADER << '\n';
+  for (const Entry& entry : entries_)
+    os << entry.library << '\t' << entry.plugin << '\n';
+}
+
+void PluginLoadProfile::save(const std::string& file_path) const
+{
+  std::ofstream file(file_path);
+  if (!file)
+    throw PluginLoaderException("Failed to open profile file for writing: " + file_path);
+
+  write(file);
+}
+
+void PluginLoadProfile::read(std::istream& is)
+{
+  const std::scoped_lock lock(mutex_);
+  std::string line;
+  while (std::getline(is, line))
+  {
+    // Skip comments and malformed lines, so that a stale or damaged profile only costs the preloading
+    const std::size_t tab = line.find('\t');
+    if (line.empty() || line.front() == '#' || tab == std::string::npos || tab == 0 || tab + 1 == line.size())
+      continue;
+
+    addLocked(line.substr(0, tab), line.substr(tab + 1));
+  }
+}
+
+bool PluginLoadProfile::load(const std::string& file_path)
+{
+  std::ifstream file(file_path);
+  if (!file)
+    return false;
+
+  read(file);
+  return true;
+}
+
+bool PluginLoadProfile::empty() const
+{
+  const std::scoped_lock lock(mutex_);
+  return entries_.empty();
+}
+
+void PluginLoadProfile::clear()
+{
+  const std::scoped_lock lock(mutex_);
+  entries_.clear();
+}
+
+void PluginLoadProfile::addLocked(std::string library, std::string plugin)
+{
+  const auto it = std::find_if(entries_.begin(), entries_.end(), [&library, &plugin](const Entry& entry) {
+    return entry.library == library && entry.plugin == plugin;
+  });
+  if (it == entries_.end())
+    entries_.push_back({ std::move(library), std::move(plugin) });
+}
+
+}  // namespace boost_plugin_loader
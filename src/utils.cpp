@@ -25,35 +25,130 @@
 #include <boost/algorithm/string/constants.hpp>
 #include <boost/algorithm/string/split.hpp>
 #include <boost/algorithm/string/classification.hpp>
+#include <boost/algorithm/string/trim.hpp>
 #include <boost/filesystem/path.hpp>
 #include <boost/filesystem/operations.hpp>
+#include <boost/filesystem/directory.hpp>
 #include <boost/system/error_code.hpp>
 
 // STD
 #include <vector>
 #include <string>
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
 #include <optional>
 #include <cstring>
+#include <ctime>
 #include <cstdlib>
+#include <deque>
+#include <iterator>
+#include <exception>
+#include <memory>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <unordered_map>
+
+#ifndef _WIN32
+#include <dlfcn.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+#include <link.h>
+#include <sys/mman.h>
+#endif
 
 // Boost Plugin Loader
 #include <boost_plugin_loader/utils.h>
 
 namespace boost_plugin_loader
 {
-std::optional<boost::dll::shared_library> loadLibrary(const boost::filesystem::path& library_path)
+namespace
 {
-  boost::dll::load_mode::type mode{ boost::dll::load_mode::type::default_mode };
+/** @brief The generation of the library caches, starting at 1 so that empty per-thread cache entries never match */
+std::atomic<std::uint64_t> library_cache_generation{ 1 };  // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
 
-  if (!library_path.has_parent_path())
+/**
+ * @brief Get the modification time of a directory which is read before listing it, or -1 if the listing may miss
+ * changes that leave the time unchanged because the directory was modified within the resolution of its timestamps
+ */
+std::int64_t getTrustedModificationTime(std::int64_t modified)
+{
+  const std::int64_t now =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+  return (modified > now - std::int64_t{ 1000000000 }) ? -1 : modified;
+}
+}  // namespace
+
+const char* toString(PluginLoaderErrorCode error)
+{
+  switch (error)
   {
-    mode = boost::dll::load_mode::append_decorations | boost::dll::load_mode::search_system_folders;
+    case PluginLoaderErrorCode::SUCCESS:
+      return "Success";
+    case PluginLoaderErrorCode::NO_LIBRARIES:
+      return "No plugin libraries were provided!";
+    case PluginLoaderErrorCode::PLUGIN_NOT_FOUND:
+      return "Plugin not found";
   }
-  else
+  return "Unknown error";
+}
+
+PluginNotFoundException::PluginNotFoundException(std::string plugin_name, std::function<std::string()> formatter)
+  : PluginLoaderException("Failed to create plugin instance '" + plugin_name + "'")
+  , plugin_name_(std::move(plugin_name))
+  , message_(std::make_shared<Message>())
+{
+  message_->formatter = std::move(formatter);
+}
+
+const char* PluginNotFoundException::what() const noexcept
+{
+  try
   {
-    mode = boost::dll::load_mode::append_decorations;
+    std::call_once(message_->flag, [this]() {
+      message_->text = message_->formatter();
+      message_->formatter = nullptr;
+    });
   }
+  catch (...)
+  {
+    // Fall back to the short message
+  }
+
+  return message_->text.empty() ? PluginLoaderException::what() : message_->text.c_str();
+}
+
+const std::string& PluginNotFoundException::getPluginName() const
+{
+  return plugin_name_;
+}
+
+namespace load_mode
+{
+#if defined(RTLD_NODELETE)
+const boost::dll::load_mode::type rtld_nodelete = static_cast<boost::dll::load_mode::type>(RTLD_NODELETE);
+#else
+const boost::dll::load_mode::type rtld_nodelete = boost::dll::load_mode::default_mode;
+#endif
+}  // namespace load_mode
+
+std::optional<boost::dll::shared_library> loadLibrary(const boost::filesystem::path& library_path,
+                                                      boost::dll::load_mode::type mode)
+{
+  mode |= boost::dll::load_mode::append_decorations;
+
+  if (!library_path.has_parent_path())
+    mode |= boost::dll::load_mode::search_system_folders;
 
   boost::system::error_code ec;
   boost::dll::shared_library lib = boost::dll::shared_library(library_path, ec, mode);
@@ -72,6 +167,15 @@ std::vector<std::string> getAllAvailableSymbols(const boost::dll::shared_library
   return inf.symbols(section);
 }
 
+namespace
+{
+/** @brief Check if a section is hidden, i.e. starts with "." or "__" */
+bool isHiddenSection(const std::string& section)
+{
+  return (section.substr(0, 1) == ".") || (section.substr(0, 2) == "__");
+}
+}  // namespace
+
 std::vector<std::string> getAllAvailableSections(const boost::dll::shared_library& library, bool include_hidden)
 {
   // Class `library_info` can extract information from a library
@@ -87,13 +191,371 @@ std::vector<std::string> getAllAvailableSections(const boost::dll::shared_librar
     if (include_hidden)
       return false;
 
-    return (section.substr(0, 1) == ".") || (section.substr(0, 2) == "__");
+    return isHiddenSection(section);
   };
 
   sections.erase(std::remove_if(sections.begin(), sections.end(), search_fn), sections.end());
   return sections;
 }
 
+LibraryIndex indexLibrary(const boost::dll::shared_library& library)
+{
+  // Reuse a single `library_info` so the library file is only opened once
+  boost::dll::library_info inf(library.location());
+
+  LibraryIndex index;
+  index.all_sections = inf.sections();
+  index.all_sections.erase(std::remove(index.all_sections.begin(), index.all_sections.end(), std::string()),
+                           index.all_sections.end());
+
+  for (const std::string& section : index.all_sections)
+  {
+    if (isHiddenSection(section))
+      continue;
+
+    index.sections.push_back(section);
+    index.symbols[section] = inf.symbols(section);
+  }
+
+  return index;
+}
+
+namespace
+{
+/** @brief The largest section header table or section read from an ELF file, which guards against malformed files */
+constexpr std::uint64_t MAX_ELF_READ_SIZE{ 64ULL * 1024 * 1024 };
+
+/** @brief The section type of sections which occupy no space in the file (SHT_NOBITS) */
+constexpr std::uint32_t ELF_SECTION_NOBITS{ 8 };
+
+/** @brief The section type of the dynamic symbol table (SHT_DYNSYM) */
+constexpr std::uint32_t ELF_SECTION_DYNSYM{ 11 };
+
+/** @brief A section header of an ELF file */
+struct ElfSection
+{
+  std::string name;
+  std::uint32_t type{ 0 };
+  std::uint64_t offset{ 0 };
+  std::uint64_t size{ 0 };
+};
+
+/** @brief The section headers of an ELF file */
+struct ElfFile
+{
+  /** @brief Indicate if the file is a 64-bit ELF file, which determines the layout of its symbols */
+  bool is_64{ false };
+
+  /** @brief The sections in the order of the section header table */
+  std::vector<ElfSection> sections;
+};
+
+/** @brief Read a value in the byte order of this platform from a buffer, failing instead of reading past its end */
+template <typename T>
+bool readValue(const std::string& data, std::uint64_t offset, T& value)
+{
+  if (offset > data.size() || data.size() - offset < sizeof(T))
+    return false;
+
+  std::memcpy(&value, data.data() + offset, sizeof(T));  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+  return true;
+}
+
+/** @brief Read a range of a file into a buffer */
+bool readFileRange(std::ifstream& stream, std::uint64_t offset, std::uint64_t size, std::string& data)
+{
+  if (size > MAX_ELF_READ_SIZE)
+    return false;
+
+  data.resize(static_cast<std::size_t>(size));
+  stream.clear();
+  stream.seekg(static_cast<std::streamoff>(offset));
+  return static_cast<bool>(stream.read(data.data(), static_cast<std::streamsize>(size)));
+}
+
+/**
+ * @brief Read the section headers of an ELF file
+ * @return The section headers, or nothing if the file is not an ELF file in the byte order of this platform
+ */
+std::optional<ElfFile> readElfSections(std::ifstream& stream)
+{
+  std::string header;
+  if (!readFileRange(stream, 0, 64, header) || header.compare(0, 4, "\x7F" "ELF") != 0)
+    return std::nullopt;
+
+  // Only files in the byte order of this platform are supported, since their records are read in place
+  const std::uint16_t byte_order_probe{ 1 };
+  const bool little_endian = *reinterpret_cast<const std::uint8_t*>(&byte_order_probe) == 1;  // NOLINT
+  const bool is_64 = (header[4] == 2);
+  if ((header[4] != 1 && !is_64) || header[5] != (little_endian ? 1 : 2))
+    return std::nullopt;
+
+  std::uint64_t table_offset{ 0 };
+  std::uint16_t entry_size{ 0 };
+  std::uint16_t count{ 0 };
+  std::uint16_t names_index{ 0 };
+  if (is_64)
+  {
+    if (!readValue(header, 0x28, table_offset) || !readValue(header, 0x3A, entry_size) ||
+        !readValue(header, 0x3C, count) || !readValue(header, 0x3E, names_index))
+      return std::nullopt;
+  }
+  else
+  {
+    std::uint32_t table_offset_32{ 0 };
+    if (!readValue(header, 0x20, table_offset_32) || !readValue(header, 0x2E, entry_size) ||
+        !readValue(header, 0x30, count) || !readValue(header, 0x32, names_index))
+      return std::nullopt;
+    table_offset = table_offset_32;
+  }
+
+  // Files with more sections than fit in the header (count zero) are rare and left to Boost.DLL
+  std::string table;
+  if (count == 0 || names_index >= count || entry_size < (is_64 ? 64 : 40) ||
+      !readFileRange(stream, table_offset, std::uint64_t{ count } * entry_size, table))
+    return std::nullopt;
+
+  ElfFile file;
+  file.is_64 = is_64;
+  std::vector<ElfSection>& sections = file.sections;
+  sections.resize(count);
+  std::vector<std::uint32_t> name_offsets(count);
+  for (std::size_t i = 0; i < count; ++i)
+  {
+    const std::uint64_t entry = std::uint64_t{ entry_size } * i;
+    bool valid = readValue(table, entry, name_offsets[i]) && readValue(table, entry + 4, sections[i].type);
+    if (is_64)
+    {
+      valid = valid && readValue(table, entry + 0x18, sections[i].offset) &&
+              readValue(table, entry + 0x20, sections[i].size);
+    }
+    else
+    {
+      std::uint32_t offset{ 0 };
+      std::uint32_t size{ 0 };
+      valid = valid && readValue(table, entry + 0x10, offset) && readValue(table, entry + 0x14, size);
+      sections[i].offset = offset;
+      sections[i].size = size;
+    }
+
+    if (!valid)
+      return std::nullopt;
+  }
+
+  std::string names;
+  if (!readFileRange(stream, sections[names_index].offset, sections[names_index].size, names))
+    return std::nullopt;
+
+  for (std::size_t i = 0; i < count; ++i)
+  {
+    if (name_offsets[i] < names.size())
+      sections[i].name = names.c_str() + name_offsets[i];  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+  }
+
+  return file;
+}
+
+/**
+ * @brief Count the exported symbols under each section of an ELF file from its dynamic symbol table
+ * @details Symbols are counted as Boost.DLL lists them: symbols which are not local, have default visibility and a
+ * size.
+ * @return The number of symbols under each section by section name, or nothing if the dynamic symbol table cannot be
+ * read
+ */
+std::optional<std::unordered_map<std::string, std::size_t>> countElfSectionSymbols(std::ifstream& stream,
+                                                                                   const ElfFile& file)
+{
+  const auto it = std::find_if(file.sections.begin(), file.sections.end(),
+                               [](const ElfSection& section) { return section.type == ELF_SECTION_DYNSYM; });
+
+  std::string data;
+  if (it == file.sections.end() || !readFileRange(stream, it->offset, it->size, data))
+    return std::nullopt;
+
+  // Elf64_Sym and Elf32_Sym order their fields differently
+  const std::uint64_t symbol_size = file.is_64 ? 24 : 16;
+  std::unordered_map<std::string, std::size_t> counts;
+  for (std::uint64_t offset = 0; offset + symbol_size <= data.size(); offset += symbol_size)
+  {
+    std::uint8_t info{ 0 };
+    std::uint8_t other{ 0 };
+    std::uint16_t section_index{ 0 };
+    std::uint64_t size{ 0 };
+    if (file.is_64)
+    {
+      readValue(data, offset + 4, info);
+      readValue(data, offset + 5, other);
+      readValue(data, offset + 6, section_index);
+      readValue(data, offset + 16, size);
+    }
+    else
+    {
+      std::uint32_t size_32{ 0 };
+      readValue(data, offset + 8, size_32);
+      readValue(data, offset + 12, info);
+      readValue(data, offset + 13, other);
+      readValue(data, offset + 14, section_index);
+      size = size_32;
+    }
+
+    // Skip local symbols (STB_LOCAL), symbols without default visibility (STV_DEFAULT) and undefined symbols
+    if ((info >> 4U) == 0 || (other & 0x03U) != 0 || size == 0 || section_index == 0 ||
+        section_index >= file.sections.size())
+      continue;
+
+    ++counts[file.sections[section_index].name];
+  }
+
+  return counts;
+}
+
+/**
+ * @brief Read the plugin records of an ELF file
+ * @details The records are aligned to at least alignof(PluginRecord), and compilers may pad them further, so the
+ * section is scanned for the magic number of each record.
+ * @return The records, or nothing if the file has no plugin records
+ */
+std::optional<std::vector<PluginRecord>> readPluginRecords(std::ifstream& stream,
+                                                           const std::vector<ElfSection>& sections)
+{
+  const auto it = std::find_if(sections.begin(), sections.end(), [](const ElfSection& section) {
+    return section.name == PLUGIN_RECORD_SECTION && section.type != ELF_SECTION_NOBITS;
+  });
+
+  std::string data;
+  if (it == sections.end() || !readFileRange(stream, it->offset, it->size, data))
+    return std::nullopt;
+
+  std::vector<PluginRecord> records;
+  for (std::uint64_t offset = 0; offset + sizeof(PluginRecord) <= data.size();)
+  {
+    std::uint32_t magic{ 0 };
+    readValue(data, offset, magic);
+    if (magic != PLUGIN_RECORD_MAGIC)
+    {
+      offset += alignof(PluginRecord);
+      continue;
+    }
+
+    PluginRecord& record = records.emplace_back();
+    readValue(data, offset, record);
+    offset += sizeof(PluginRecord);
+  }
+
+  if (records.empty())
+    return std::nullopt;
+
+  return records;
+}
+
+/** @brief Get a string of a plugin record, which is null-terminated unless it fills the whole array */
+template <std::size_t N>
+std::string getRecordString(const char (&value)[N])  // NOLINT(modernize-avoid-c-arrays)
+{
+  return { value, strnlen(value, N) };  // NOLINT(cppcoreguidelines-pro-bounds-array-to-pointer-decay)
+}
+}  // namespace
+
+std::optional<std::vector<PluginRecord>> readPluginRecords(const std::string& file)
+{
+  std::ifstream stream(file, std::ios::binary);
+  if (!stream)
+    return std::nullopt;
+
+  const std::optional<ElfFile> elf_file = readElfSections(stream);
+  if (!elf_file.has_value())
+    return std::nullopt;
+
+  return readPluginRecords(stream, elf_file->sections);
+}
+
+std::optional<std::uint64_t> findRecordedBaseType(const std::string& file, const std::string& section,
+                                                  const std::string& name)
+{
+  if (isHiddenSection(section))
+    return std::nullopt;
+
+  const std::optional<std::vector<PluginRecord>> records = readPluginRecords(file);
+  if (!records.has_value())
+    return std::nullopt;
+
+  for (const PluginRecord& record : records.value())
+  {
+    if (record.abi_version == PLUGIN_RECORD_ABI_VERSION && getRecordString(record.section) == section &&
+        getRecordString(record.alias) == name)
+      return record.base_type;
+  }
+
+  return std::nullopt;
+}
+
+std::optional<LibraryIndex> indexPluginRecords(const std::string& file)
+{
+  std::ifstream stream(file, std::ios::binary);
+  if (!stream)
+    return std::nullopt;
+
+  const std::optional<ElfFile> elf_file = readElfSections(stream);
+  if (!elf_file.has_value())
+    return std::nullopt;
+
+  const std::optional<std::vector<PluginRecord>> records = readPluginRecords(stream, elf_file->sections);
+  if (!records.has_value())
+    return std::nullopt;
+
+  LibraryIndex index;
+  for (const ElfSection& section : elf_file->sections)
+  {
+    if (section.name.empty())
+      continue;
+
+    index.all_sections.push_back(section.name);
+    if (!isHiddenSection(section.name))
+      index.sections.push_back(section.name);
+  }
+
+  for (const PluginRecord& record : records.value())
+  {
+    if (record.abi_version != PLUGIN_RECORD_ABI_VERSION)
+      return std::nullopt;
+
+    // Plugins under hidden sections are not indexed, as in indexLibrary
+    const std::string section = getRecordString(record.section);
+    if (isHiddenSection(section))
+      continue;
+
+    // A plugin defined in several translation units has a record for each of them
+    const std::string alias = getRecordString(record.alias);
+    std::vector<std::string>& symbols = index.symbols[section];
+    if (std::find(symbols.begin(), symbols.end(), alias) != symbols.end())
+      continue;
+
+    symbols.push_back(alias);
+    if (record.base_type != 0)
+      index.base_types[section][alias] = record.base_type;
+  }
+
+  // Sections without records hold symbols which were not exported with the export macros, which only the symbol table
+  // lists. Each record must also be under a section of the file.
+  if (index.symbols.size() != index.sections.size() ||
+      std::any_of(index.sections.begin(), index.sections.end(),
+                  [&index](const std::string& section) { return index.findSymbols(section) == nullptr; }))
+    return std::nullopt;
+
+  // Symbols exported without the export macros may share a section with plugins exported with them, so each section
+  // must have as many exported symbols as records
+  const std::optional<std::unordered_map<std::string, std::size_t>> symbol_counts =
+      countElfSectionSymbols(stream, elf_file.value());
+  if (!symbol_counts.has_value() ||
+      std::any_of(index.symbols.begin(), index.symbols.end(), [&symbol_counts](const auto& section) {
+        const auto it = symbol_counts->find(section.first);
+        return it == symbol_counts->end() || it->second != section.second.size();
+      }))
+    return std::nullopt;
+
+  return index;
+}
+
 std::string decorate(const std::string& library_name, const std::string& library_directory)
 {
   boost::filesystem::path lib_path;
@@ -194,4 +656,468 @@ void addSymbolLibraryToSearchLibrariesEnv(const void* symbol_ptr, const std::str
 #endif
 }
 
+std::vector<std::string> readLibraryDependencies(const std::string& library_file)
+{
+  std::ifstream manifest(library_file + ".deps");
+  std::vector<std::string> dependencies;
+  std::string line;
+  while (std::getline(manifest, line))
+  {
+    boost::trim(line);
+    if (!line.empty() && line.front() != '#')
+      dependencies.push_back(line);
+  }
+
+  return dependencies;
+}
+
+std::vector<std::vector<std::size_t>> getDependencyWaves(const std::vector<std::string>& names,
+                                                         const std::vector<std::vector<std::size_t>>& dependencies)
+{
+  // Kahn's algorithm, taking all nodes whose dependencies are satisfied at once
+  std::vector<std::size_t> pending(dependencies.size());
+  std::vector<std::vector<std::size_t>> dependents(dependencies.size());
+  for (std::size_t i = 0; i < dependencies.size(); ++i)
+  {
+    for (const std::size_t dependency : dependencies[i])
+    {
+      if (dependency == i || std::find(dependents[dependency].begin(), dependents[dependency].end(), i) !=
+                                 dependents[dependency].end())
+      {
+        pending[i] += (dependency == i) ? 1 : 0;
+        continue;
+      }
+
+      dependents[dependency].push_back(i);
+      ++pending[i];
+    }
+  }
+
+  std::vector<std::vector<std::size_t>> waves;
+  std::vector<std::size_t> wave;
+  for (std::size_t i = 0; i < pending.size(); ++i)
+  {
+    if (pending[i] == 0)
+      wave.push_back(i);
+  }
+
+  std::size_t visited{ 0 };
+  while (!wave.empty())
+  {
+    std::vector<std::size_t> next;
+    for (const std::size_t node : wave)
+    {
+      for (const std::size_t dependent : dependents[node])
+      {
+        if (--pending[dependent] == 0)
+          next.push_back(dependent);
+      }
+    }
+
+    std::sort(next.begin(), next.end());
+    visited += wave.size();
+    waves.push_back(std::move(wave));
+    wave = std::move(next);
+  }
+
+  if (visited == dependencies.size())
+    return waves;
+
+  // Follow unsatisfied dependencies from a node in a cycle until a node repeats
+  std::vector<std::size_t> path;
+  const auto first = std::find_if(pending.begin(), pending.end(), [](std::size_t count) { return count > 0; });
+  auto node = static_cast<std::size_t>(std::distance(pending.begin(), first));
+  while (std::find(path.begin(), path.end(), node) == path.end())
+  {
+    path.push_back(node);
+    node = *std::find_if(dependencies[node].begin(), dependencies[node].end(),
+                         [&pending](std::size_t dependency) { return pending[dependency] > 0; });
+  }
+
+  std::string cycle;
+  for (auto it = std::find(path.begin(), path.end(), node); it != path.end(); ++it)
+    cycle += names[*it] + " -> ";
+
+  throw PluginLoaderException("Cyclic dependency between plugin libraries: " + cycle + names[node]);
+}
+
+namespace
+{
+/** @brief A call of parallelFor, whose indexes are handed out to the calling thread and the workers which join it */
+struct ParallelJob
+{
+  ParallelJob(std::size_t count, const std::function<void(std::size_t)>& task) : count(count), task(task) {}
+
+  const std::size_t count;
+  const std::function<void(std::size_t)>& task;
+  std::atomic<std::size_t> next{ 0 };
+
+  std::mutex mutex;
+  std::condition_variable finished;
+  /** @brief The number of workers processing indexes of the job */
+  std::size_t active{ 0 };
+  /** @brief The first exception thrown by the task */
+  std::exception_ptr error;
+
+  /** @brief Process indexes until all of them were handed out */
+  void work()
+  {
+    for (std::size_t i = next++; i < count; i = next++)
+    {
+      try
+      {
+        task(i);
+      }
+      catch (...)
+      {
+        const std::scoped_lock lock(mutex);
+        if (error == nullptr)
+          error = std::current_exception();
+      }
+    }
+  }
+};
+
+/**
+ * @brief The worker threads shared by all calls of parallelFor
+ * @details The threads are started on first use and live for the rest of the process, so each call only pays for
+ * waking them rather than for creating and joining threads.
+ */
+class WorkerPool
+{
+public:
+  /** @brief Get the pool, which is never destroyed so that its threads can outlive static destruction */
+  static WorkerPool& instance()
+  {
+    static auto* pool = new WorkerPool();  // NOLINT(cppcoreguidelines-owning-memory)
+    return *pool;
+  }
+
+  /** @brief The number of worker threads, besides the threads calling parallelFor */
+  std::size_t size() const { return size_; }
+
+  /** @brief Hand a job to up to a number of idle workers */
+  void post(const std::shared_ptr<ParallelJob>& job, std::size_t workers)
+  {
+    {
+      const std::scoped_lock lock(mutex_);
+      start();
+      queue_.insert(queue_.end(), workers, job);
+    }
+    if (workers == 1)
+      wake_.notify_one();
+    else
+      wake_.notify_all();
+  }
+
+  /** @brief Withdraw the requests for a job which no worker picked up */
+  void withdraw(const std::shared_ptr<ParallelJob>& job)
+  {
+    const std::scoped_lock lock(mutex_);
+    queue_.erase(std::remove(queue_.begin(), queue_.end(), job), queue_.end());
+  }
+
+private:
+  WorkerPool() : size_(std::max<std::size_t>(1, std::thread::hardware_concurrency()) - 1) {}
+
+  const std::size_t size_;
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  std::deque<std::shared_ptr<ParallelJob>> queue_;
+  bool started_{ false };
+
+  /** @brief Start the threads, with the mutex held */
+  void start()
+  {
+    if (started_)
+      return;
+
+    started_ = true;
+    for (std::size_t i = 0; i < size_; ++i)
+      std::thread([this]() { run(); }).detach();
+  }
+
+  void run()
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true)
+    {
+      wake_.wait(lock, [this]() { return !queue_.empty(); });
+      const std::shared_ptr<ParallelJob> job = std::move(queue_.front());
+      queue_.pop_front();
+      lock.unlock();
+
+      // Join the job unless the calling thread already handed out all of its indexes
+      {
+        const std::scoped_lock job_lock(job->mutex);
+        ++job->active;
+      }
+      job->work();
+      {
+        const std::scoped_lock job_lock(job->mutex);
+        --job->active;
+      }
+      job->finished.notify_one();
+
+      lock.lock();
+    }
+  }
+};
+}  // namespace
+
+void parallelFor(std::size_t count, const std::function<void(std::size_t)>& task)
+{
+  auto job = std::make_shared<ParallelJob>(count, task);
+  WorkerPool& pool = WorkerPool::instance();
+  const std::size_t workers = std::min(count > 0 ? count - 1 : 0, pool.size());
+  if (workers > 0)
+    pool.post(job, workers);
+
+  job->work();
+
+  // Wait for the workers still processing indexes. Workers which join later find no indexes left.
+  if (workers > 0)
+  {
+    pool.withdraw(job);
+    std::unique_lock<std::mutex> lock(job->mutex);
+    job->finished.wait(lock, [&job]() { return job->active == 0; });
+  }
+
+  if (job->error != nullptr)
+    std::rethrow_exception(job->error);
+}
+
+std::size_t prefetchFiles(const std::vector<std::string>& file_paths)
+{
+#if defined(POSIX_FADV_WILLNEED)
+  std::atomic<std::size_t> advised{ 0 };
+  parallelFor(file_paths.size(), [&](std::size_t i) {
+    const int fd = ::open(file_paths[i].c_str(), O_RDONLY | O_CLOEXEC);  // NOLINT(cppcoreguidelines-pro-type-vararg)
+    if (fd < 0)
+      return;
+
+    if (::posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED) == 0)
+      ++advised;
+
+    ::close(fd);
+  });
+
+  return advised;
+#else
+  (void)file_paths;
+  return 0;
+#endif
+}
+
+DirectoryListing listDirectory(const std::string& directory)
+{
+  // The modification time is read first, so that a change made while listing makes the listing outdated
+  DirectoryListing listing;
+  listing.modified = getModificationTime(directory);
+
+  boost::system::error_code ec;
+  for (boost::filesystem::directory_iterator it(directory, ec), end; !ec && it != end; it.increment(ec))
+    listing.entries.insert(it->path().filename().string());
+
+  listing.modified = ec ? -1 : getTrustedModificationTime(listing.modified);
+  return listing;
+}
+
+std::int64_t getModificationTime(const std::string& path)
+{
+#ifdef __linux__
+  struct stat status{};
+  if (::stat(path.c_str(), &status) != 0)
+    return -1;
+
+  return (static_cast<std::int64_t>(status.st_mtim.tv_sec) * 1000000000) + status.st_mtim.tv_nsec;
+#else
+  boost::system::error_code ec;
+  const std::time_t time = boost::filesystem::last_write_time(path, ec);
+  return ec ? -1 : static_cast<std::int64_t>(time) * 1000000000;
+#endif
+}
+
+bool matchesGlob(const std::string& name, const std::string& pattern)
+{
+  // Match greedily, backtracking to the last '*' on a mismatch
+  std::size_t n = 0;
+  std::size_t p = 0;
+  std::size_t star = std::string::npos;
+  std::size_t star_n = 0;
+  while (n < name.size())
+  {
+    if (p < pattern.size() && (pattern[p] == '?' || pattern[p] == name[n]))
+    {
+      ++n;
+      ++p;
+    }
+    else if (p < pattern.size() && pattern[p] == '*')
+    {
+      star = p++;
+      star_n = n;
+    }
+    else if (star != std::string::npos)
+    {
+      p = star + 1;
+      n = ++star_n;
+    }
+    else
+    {
+      return false;
+    }
+  }
+
+  while (p < pattern.size() && pattern[p] == '*')
+    ++p;
+
+  return p == pattern.size();
+}
+
+bool hasSharedLibraryHeader(const std::string& file)
+{
+  std::array<unsigned char, 4> header{};
+  std::ifstream stream(file, std::ios::binary);
+  if (!stream.read(reinterpret_cast<char*>(header.data()), header.size()))  // NOLINT
+    return false;
+
+  const std::uint32_t magic = (std::uint32_t{ header[0] } << 24U) | (std::uint32_t{ header[1] } << 16U) |
+                              (std::uint32_t{ header[2] } << 8U) | std::uint32_t{ header[3] };
+  switch (magic)
+  {
+    case 0x7F454C46:  // ELF
+    case 0xFEEDFACE:  // Mach-O, 32 and 64 bit in either byte order
+    case 0xFEEDFACF:
+    case 0xCEFAEDFE:
+    case 0xCFFAEDFE:
+    case 0xCAFEBABE:  // Mach-O universal
+      return true;
+    default:
+      return header[0] == 'M' && header[1] == 'Z';  // PE
+  }
+}
+
+DiscoveredLibraries discoverLibraries(const std::vector<std::string>& directories,
+                                      const std::vector<std::string>& patterns, std::size_t max_depth)
+{
+  DiscoveredLibraries discovered;
+  std::vector<std::string> candidates;
+  std::vector<std::string> level;
+  for (const std::string& directory : directories)
+    level.push_back(boost::filesystem::absolute(directory).string());
+
+  for (std::size_t depth = 0; !level.empty(); ++depth)
+  {
+    std::vector<std::int64_t> modified(level.size(), -1);
+    std::vector<std::vector<std::string>> matches(level.size());
+    std::vector<std::vector<std::string>> subdirectories(level.size());
+    parallelFor(level.size(), [&](std::size_t i) {
+      modified[i] = getModificationTime(level[i]);
+
+      boost::system::error_code ec;
+      for (boost::filesystem::directory_iterator it(level[i], ec), end; !ec && it != end; it.increment(ec))
+      {
+        boost::system::error_code status_ec;
+        const boost::filesystem::file_status status = it->status(status_ec);
+        if (boost::filesystem::is_directory(status))
+        {
+          if (depth < max_depth)
+            subdirectories[i].push_back(it->path().string());
+          continue;
+        }
+
+        const std::string name = it->path().filename().string();
+        if (boost::filesystem::is_regular_file(status) &&
+            std::any_of(patterns.begin(), patterns.end(),
+                        [&name](const std::string& pattern) { return matchesGlob(name, pattern); }))
+          matches[i].push_back(it->path().string());
+      }
+
+      modified[i] = ec ? -1 : getTrustedModificationTime(modified[i]);
+      std::sort(matches[i].begin(), matches[i].end());
+      std::sort(subdirectories[i].begin(), subdirectories[i].end());
+    });
+
+    std::vector<std::string> next_level;
+    for (std::size_t i = 0; i < level.size(); ++i)
+    {
+      discovered.directories.emplace_back(std::move(level[i]), modified[i]);
+      candidates.insert(candidates.end(), matches[i].begin(), matches[i].end());
+      next_level.insert(next_level.end(), subdirectories[i].begin(), subdirectories[i].end());
+    }
+    level = std::move(next_level);
+  }
+
+  // Skip the files which are not shared libraries
+  std::vector<char> is_library(candidates.size(), 0);
+  parallelFor(candidates.size(), [&candidates, &is_library](std::size_t i) {
+    is_library[i] = hasSharedLibraryHeader(candidates[i]) ? 1 : 0;
+  });
+  for (std::size_t i = 0; i < candidates.size(); ++i)
+  {
+    if (is_library[i] != 0)
+      discovered.files.push_back(std::move(candidates[i]));
+  }
+
+  return discovered;
+}
+
+bool prefaultLibrary(const boost::dll::shared_library& library)
+{
+#ifdef __linux__
+  if (!library.is_loaded())
+    return false;
+
+  // Find the load address of the library from its handle
+  link_map* lm{ nullptr };
+  if (::dlinfo(library.native(), RTLD_DI_LINKMAP, static_cast<void*>(&lm)) != 0 || lm == nullptr)
+    return false;
+
+  struct Context
+  {
+    ElfW(Addr) address;
+    bool advised;
+  } context{ lm->l_addr, false };
+
+  ::dl_iterate_phdr(
+      [](dl_phdr_info* info, std::size_t /*size*/, void* data) {
+        auto* ctx = static_cast<Context*>(data);
+        if (info->dlpi_addr != ctx->address)
+          return 0;
+
+        const auto page_size = static_cast<std::uintptr_t>(::sysconf(_SC_PAGESIZE));
+        for (ElfW(Half) i = 0; i < info->dlpi_phnum; ++i)
+        {
+          const ElfW(Phdr)& segment = info->dlpi_phdr[i];
+          if (segment.p_type != PT_LOAD || segment.p_memsz == 0)
+            continue;
+
+          const std::uintptr_t start = info->dlpi_addr + segment.p_vaddr;
+          const std::uintptr_t aligned_start = start & ~(page_size - 1);
+          const std::size_t length = segment.p_memsz + (start - aligned_start);
+          // NOLINTNEXTLINE(performance-no-int-to-ptr)
+          if (::madvise(reinterpret_cast<void*>(aligned_start), length, MADV_WILLNEED) == 0)
+            ctx->advised = true;
+        }
+        return 1;
+      },
+      &context);
+
+  return context.advised;
+#else
+  (void)library;
+  return false;
+#endif
+}
+
+std::uint64_t getLibraryCacheGeneration()
+{
+  return library_cache_generation.load(std::memory_order_acquire);
+}
+
+void advanceLibraryCacheGeneration()
+{
+  library_cache_generation.fetch_add(1, std::memory_order_acq_rel);
+}
+
 }  // namespace boost_plugin_loader
@@ -0,0 +1,349 @@
+/**
+ *
+ * @copyright Copyright (c) 2021, Southwest Research Institute
+ *
+ * @par License
+ * Software License Agreement (Apache License)
+ * @par
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * @par
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// The interposed functions are defined with the declarations of the system headers, which fortified builds replace
+#undef _FORTIFY_SOURCE
+
+// STD
+#include <cerrno>
+#include <cstdarg>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+
+// System
+#include <dlfcn.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#include "call_counter.h"
+
+// Sanitizers interpose the same functions and forward to the next definitions, which must then be the C library's
+#if defined(__has_feature)
+#if __has_feature(thread_sanitizer) || __has_feature(address_sanitizer) || __has_feature(memory_sanitizer)
+#define BOOST_PLUGIN_LOADER_SANITIZED
+#endif
+#endif
+#if defined(__SANITIZE_THREAD__) || defined(__SANITIZE_ADDRESS__)
+#define BOOST_PLUGIN_LOADER_SANITIZED
+#endif
+
+#if defined(__GLIBC__) && !defined(BOOST_PLUGIN_LOADER_SANITIZED)
+#define BOOST_PLUGIN_LOADER_INTERPOSE
+#endif
+
+#ifdef BOOST_PLUGIN_LOADER_INTERPOSE
+// NOLINTBEGIN(cert-dcl37-c,cert-dcl51-cpp,bugprone-reserved-identifier,cppcoreguidelines-pro-type-vararg)
+extern "C" void* __libc_malloc(std::size_t size);
+extern "C" void* __libc_calloc(std::size_t count, std::size_t size);
+extern "C" void* __libc_realloc(void* ptr, std::size_t size);
+extern "C" void* __libc_memalign(std::size_t alignment, std::size_t size);
+extern "C" void __libc_free(void* ptr);
+
+namespace
+{
+/**
+ * @brief The calls counted on this thread, which only grow while a CallCounter is alive on it
+ * @details The initial-exec TLS model keeps the allocation functions from allocating on first access in a thread.
+ */
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+__attribute__((tls_model("initial-exec"))) thread_local boost_plugin_loader::CallCounts thread_counts;
+
+/** @brief The number of CallCounters alive on this thread */
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+__attribute__((tls_model("initial-exec"))) thread_local int thread_counters{ 0 };
+
+void count(std::size_t boost_plugin_loader::CallCounts::*counter)
+{
+  if (thread_counters > 0)
+    ++(thread_counts.*counter);
+}
+
+using DlsymFunction = void* (*)(void*, const char*);
+
+/** @brief Get the dlsym of the dynamic loader, which cannot be looked up with dlsym since that is interposed */
+DlsymFunction getRealDlsym()
+{
+  static DlsymFunction real_dlsym = []() -> DlsymFunction {
+    for (const char* version : { "GLIBC_2.34", "GLIBC_2.17", "GLIBC_2.2.5", "GLIBC_2.0" })
+    {
+      void* function = ::dlvsym(RTLD_NEXT, "dlsym", version);
+      if (function != nullptr)
+        return reinterpret_cast<DlsymFunction>(function);  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+    }
+    return nullptr;
+  }();
+  return real_dlsym;
+}
+
+/** @brief Get the next definition of an interposed function */
+template <typename Function>
+Function getNext(const char* name)
+{
+  return reinterpret_cast<Function>(getRealDlsym()(RTLD_NEXT, name));  // NOLINT
+}
+}  // namespace
+
+#define BOOST_PLUGIN_LOADER_NEXT(NAME) static const auto next = getNext<decltype(&NAME)>(#NAME)
+
+extern "C"
+{
+  void* malloc(std::size_t size)
+  {
+    count(&boost_plugin_loader::CallCounts::allocations);
+    return __libc_malloc(size);
+  }
+
+  void* calloc(std::size_t count_, std::size_t size)
+  {
+    count(&boost_plugin_loader::CallCounts::allocations);
+    return __libc_calloc(count_, size);
+  }
+
+  void* realloc(void* ptr, std::size_t size)
+  {
+    count(&boost_plugin_loader::CallCounts::allocations);
+    return __libc_realloc(ptr, size);
+  }
+
+  void* aligned_alloc(std::size_t alignment, std::size_t size)
+  {
+    count(&boost_plugin_loader::CallCounts::allocations);
+    return __libc_memalign(alignment, size);
+  }
+
+  void* memalign(std::size_t alignment, std::size_t size)
+  {
+    count(&boost_plugin_loader::CallCounts::allocations);
+    return __libc_memalign(alignment, size);
+  }
+
+  int posix_memalign(void** ptr, std::size_t alignment, std::size_t size)
+  {
+    count(&boost_plugin_loader::CallCounts::allocations);
+    void* memory = __libc_memalign(alignment, size);
+    if (memory == nullptr)
+      return ENOMEM;
+
+    *ptr = memory;
+    return 0;
+  }
+
+  void free(void* ptr)
+  {
+    __libc_free(ptr);
+  }
+
+  int open(const char* path, int flags, ...)
+  {
+    BOOST_PLUGIN_LOADER_NEXT(open);
+    count(&boost_plugin_loader::CallCounts::file_opens);
+    va_list args;
+    va_start(args, flags);
+    const auto mode = static_cast<mode_t>(va_arg(args, unsigned int));
+    va_end(args);
+    return next(path, flags, mode);
+  }
+
+  int open64(const char* path, int flags, ...)
+  {
+    BOOST_PLUGIN_LOADER_NEXT(open64);
+    count(&boost_plugin_loader::CallCounts::file_opens);
+    va_list args;
+    va_start(args, flags);
+    const auto mode = static_cast<mode_t>(va_arg(args, unsigned int));
+    va_end(args);
+    return next(path, flags, mode);
+  }
+
+  int openat(int dirfd, const char* path, int flags, ...)
+  {
+    BOOST_PLUGIN_LOADER_NEXT(openat);
+    count(&boost_plugin_loader::CallCounts::file_opens);
+    va_list args;
+    va_start(args, flags);
+    const auto mode = static_cast<mode_t>(va_arg(args, unsigned int));
+    va_end(args);
+    return next(dirfd, path, flags, mode);
+  }
+
+  int openat64(int dirfd, const char* path, int flags, ...)
+  {
+    BOOST_PLUGIN_LOADER_NEXT(openat64);
+    count(&boost_plugin_loader::CallCounts::file_opens);
+    va_list args;
+    va_start(args, flags);
+    const auto mode = static_cast<mode_t>(va_arg(args, unsigned int));
+    va_end(args);
+    return next(dirfd, path, flags, mode);
+  }
+
+  FILE* fopen(const char* path, const char* mode)
+  {
+    BOOST_PLUGIN_LOADER_NEXT(fopen);
+    count(&boost_plugin_loader::CallCounts::file_opens);
+    return next(path, mode);
+  }
+
+  FILE* fopen64(const char* path, const char* mode)
+  {
+    BOOST_PLUGIN_LOADER_NEXT(fopen64);
+    count(&boost_plugin_loader::CallCounts::file_opens);
+    return next(path, mode);
+  }
+
+#if __GLIBC_PREREQ(2, 33)
+  int stat(const char* path, struct stat* buf)
+  {
+    BOOST_PLUGIN_LOADER_NEXT(stat);
+    count(&boost_plugin_loader::CallCounts::file_stats);
+    return next(path, buf);
+  }
+
+  int lstat(const char* path, struct stat* buf)
+  {
+    BOOST_PLUGIN_LOADER_NEXT(lstat);
+    count(&boost_plugin_loader::CallCounts::file_stats);
+    return next(path, buf);
+  }
+
+  int stat64(const char* path, struct stat64* buf)
+  {
+    BOOST_PLUGIN_LOADER_NEXT(stat64);
+    count(&boost_plugin_loader::CallCounts::file_stats);
+    return next(path, buf);
+  }
+
+  int lstat64(const char* path, struct stat64* buf)
+  {
+    BOOST_PLUGIN_LOADER_NEXT(lstat64);
+    count(&boost_plugin_loader::CallCounts::file_stats);
+    return next(path, buf);
+  }
+
+  int fstatat(int dirfd, const char* path, struct stat* buf, int flags)
+  {
+    BOOST_PLUGIN_LOADER_NEXT(fstatat);
+    count(&boost_plugin_loader::CallCounts::file_stats);
+    return next(dirfd, path, buf, flags);
+  }
+
+  int fstatat64(int dirfd, const char* path, struct stat64* buf, int flags)
+  {
+    BOOST_PLUGIN_LOADER_NEXT(fstatat64);
+    count(&boost_plugin_loader::CallCounts::file_stats);
+    return next(dirfd, path, buf, flags);
+  }
+#else
+  int __xstat(int version, const char* path, struct stat* buf)
+  {
+    BOOST_PLUGIN_LOADER_NEXT(__xstat);
+    count(&boost_plugin_loader::CallCounts::file_stats);
+    return next(version, path, buf);
+  }
+
+  int __lxstat(int version, const char* path, struct stat* buf)
+  {
+    BOOST_PLUGIN_LOADER_NEXT(__lxstat);
+    count(&boost_plugin_loader::CallCounts::file_stats);
+    return next(version, path, buf);
+  }
+#endif
+
+#if __GLIBC_PREREQ(2, 28)
+  int statx(int dirfd, const char* path, int flags, unsigned int mask, struct statx* buf)
+  {
+    BOOST_PLUGIN_LOADER_NEXT(statx);
+    count(&boost_plugin_loader::CallCounts::file_stats);
+    return next(dirfd, path, flags, mask, buf);
+  }
+#endif
+
+  void* dlopen(const char* file, int mode)
+  {
+    BOOST_PLUGIN_LOADER_NEXT(dlopen);
+    count(&boost_plugin_loader::CallCounts::dlopens);
+    return next(file, mode);
+  }
+
+  void* dlsym(void* handle, const char* name)
+  {
+    count(&boost_plugin_loader::CallCounts::dlsyms);
+    return getRealDlsym()(handle, name);
+  }
+}
+// NOLINTEND(cert-dcl37-c,cert-dcl51-cpp,bugprone-reserved-identifier,cppcoreguidelines-pro-type-vararg)
+#endif
+
+namespace boost_plugin_loader
+{
+#ifdef BOOST_PLUGIN_LOADER_INTERPOSE
+CallCounter::CallCounter() : start_(thread_counts)
+{
+  ++thread_counters;
+}
+
+CallCounter::~CallCounter()
+{
+  --thread_counters;
+}
+
+CallCounts CallCounter::counts() const
+{
+  CallCounts counts;
+  counts.file_opens = thread_counts.file_opens - start_.file_opens;
+  counts.file_stats = thread_counts.file_stats - start_.file_stats;
+  counts.dlopens = thread_counts.dlopens - start_.dlopens;
+  counts.dlsyms = thread_counts.dlsyms - start_.dlsyms;
+  counts.allocations = thread_counts.allocations - start_.allocations;
+  return counts;
+}
+
+bool CallCounter::isSupported()
+{
+  static const bool supported = []() {
+    const CallCounter counter;
+    void* volatile memory = std::malloc(16);  // NOLINT(cppcoreguidelines-no-malloc)
+    std::free(memory);                        // NOLINT(cppcoreguidelines-no-malloc)
+    void* const handle = ::dlopen(nullptr, RTLD_NOW);
+    if (handle != nullptr)
+      ::dlclose(handle);
+
+    const CallCounts counts = counter.counts();
+    return counts.allocations > 0 && counts.dlopens > 0;
+  }();
+  return supported;
+}
+#else
+CallCounter::CallCounter() = default;
+
+CallCounter::~CallCounter() = default;
+
+CallCounts CallCounter::counts() const
+{
+  return {};
+}
+
+bool CallCounter::isSupported()
+{
+  return false;
+}
+#endif
+
+}  // namespace boost_plugin_loader
@@ -0,0 +1,132 @@
+/**
+ *
+ * @copyright Copyright (c) 2021, Southwest Research Institute
+ *
+ * @par License
+ * Software License Agreement (Apache License)
+ * @par
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * @par
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef BOOST_PLUGIN_LOADER_CALL_COUNTER_H
+#define BOOST_PLUGIN_LOADER_CALL_COUNTER_H
+
+// GTest
+#include <gtest/gtest.h>
+
+// STD
+#include <cstddef>
+#include <ostream>
+
+namespace boost_plugin_loader
+{
+/** @brief The number of calls to the functions interposed by the call counter library */
+struct CallCounts
+{
+  /** @brief open, open64, openat, openat64, fopen and fopen64 */
+  std::size_t file_opens{ 0 };
+
+  /** @brief The stat family, including statx */
+  std::size_t file_stats{ 0 };
+
+  /** @brief dlopen */
+  std::size_t dlopens{ 0 };
+
+  /** @brief dlsym */
+  std::size_t dlsyms{ 0 };
+
+  /** @brief malloc, calloc, realloc and the aligned allocation functions (operator new allocates through malloc) */
+  std::size_t allocations{ 0 };
+};
+
+/**
+ * @brief Counts the calls the current thread makes to the file, dynamic loader and heap functions while it is alive
+ * @details The functions are interposed by the call counter library (boost_plugin_loader_call_counter), which must be
+ * linked to the test executable. Calls made by other threads are not counted. Interposition requires glibc and does not
+ * take effect in builds with sanitizers, which interpose the same functions; check isSupported() first.
+ * Since dlopen is called from the call counter library, library names without a directory are searched for with its
+ * run path rather than the caller's.
+ */
+class CallCounter
+{
+public:
+  CallCounter();
+  ~CallCounter();
+  CallCounter(const CallCounter&) = delete;
+  CallCounter& operator=(const CallCounter&) = delete;
+  CallCounter(CallCounter&&) = delete;
+  CallCounter& operator=(CallCounter&&) = delete;
+
+  /** @brief The calls made by the current thread since this counter was created */
+  CallCounts counts() const;
+
+  /** @brief Check if the functions are interposed, so that calls are counted */
+  static bool isSupported();
+
+private:
+  CallCounts start_;
+};
+
+inline std::ostream& operator<<(std::ostream& os, const CallCounts& counts)
+{
+  return os << "file opens: " << counts.file_opens << ", file stats: " << counts.file_stats
+            << ", dlopens: " << counts.dlopens << ", dlsyms: " << counts.dlsyms
+            << ", allocations: " << counts.allocations;
+}
+
+/**
+ * @brief Check that counted calls are within limits
+ * @param counts The counted calls
+ * @param limits The maximum number of calls of each kind
+ * @return Success, or a failure listing the calls which exceed their limit along with all counts
+ */
+inline ::testing::AssertionResult callsWithin(const CallCounts& counts, const CallCounts& limits)
+{
+  ::testing::AssertionResult result = ::testing::AssertionSuccess();
+  auto check = [&result](const char* name, std::size_t count, std::size_t limit) {
+    if (count <= limit)
+      return;
+
+    if (result)
+      result = ::testing::AssertionFailure();
+    result << name << " " << count << " > " << limit << "; ";
+  };
+
+  check("file opens", counts.file_opens, limits.file_opens);
+  check("file stats", counts.file_stats, limits.file_stats);
+  check("dlopens", counts.dlopens, limits.dlopens);
+  check("dlsyms", counts.dlsyms, limits.dlsyms);
+  check("allocations", counts.allocations, limits.allocations);
+  if (!result)
+    result << "(" << counts << ")";
+
+  return result;
+}
+
+}  // namespace boost_plugin_loader
+
+/**
+ * @brief Expect a statement to make at most the given calls on the current thread
+ * @details Skips the check if calls cannot be counted (see CallCounter::isSupported).
+ */
+#define EXPECT_CALLS_WITHIN(statement, limits)                                                                         \
+  do                                                                                                                   \
+  {                                                                                                                    \
+    const boost_plugin_loader::CallCounter call_counter;                                                               \
+    statement;                                                                                                         \
+    const boost_plugin_loader::CallCounts call_counts = call_counter.counts();                                         \
+    if (boost_plugin_loader::CallCounter::isSupported())                                                               \
+    {                                                                                                                  \
+      EXPECT_TRUE(boost_plugin_loader::callsWithin(call_counts, limits)) << "Statement: " #statement;                  \
+    }                                                                                                                  \
+  } while (false)
+
+#endif  // BOOST_PLUGIN_LOADER_CALL_COUNTER_H
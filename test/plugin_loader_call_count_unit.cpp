@@ -0,0 +1,136 @@
+/**
+ *
+ * @copyright Copyright (c) 2021, Southwest Research Institute
+ *
+ * @par License
+ * Software License Agreement (Apache License)
+ * @par
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * @par
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// GTest
+#include <gtest/gtest.h>
+
+// STD
+#include <cstdlib>
+#include <memory>
+#include <string>
+
+// Boost Plugin Loader
+#include <boost_plugin_loader/plugin_loader.h>
+#include <boost_plugin_loader/plugin_loader.hpp>  // NOLINT(misc-include-cleaner)
+#include "call_counter.h"
+#include "test_plugin.h"
+
+namespace
+{
+boost_plugin_loader::PluginLoader createPluginLoader()
+{
+  boost_plugin_loader::PluginLoader plugin_loader;
+  plugin_loader.search_system_folders = false;
+  plugin_loader.search_paths.emplace_back(PLUGIN_DIR);
+  plugin_loader.search_libraries = { PLUGINS_MULTIPLY, PLUGINS_ADD };
+  return plugin_loader;
+}
+}  // namespace
+
+TEST(BoostPluginLoaderCallCountUnit, CallCounter)  // NOLINT
+{
+  using boost_plugin_loader::CallCounter;
+  using boost_plugin_loader::CallCounts;
+
+  if (!CallCounter::isSupported())
+    GTEST_SKIP() << "Calls cannot be counted in this build";
+
+  CallCounts counts;
+  {
+    const CallCounter counter;
+    // The pointer is volatile so that the allocation is not elided
+    int* volatile memory = new int(1);  // NOLINT(cppcoreguidelines-owning-memory)
+    counts = counter.counts();
+    delete memory;  // NOLINT(cppcoreguidelines-owning-memory)
+  }
+  EXPECT_EQ(counts.allocations, 1);
+  EXPECT_EQ(counts.dlopens, 0);
+
+  CallCounts limits;
+  EXPECT_FALSE(boost_plugin_loader::callsWithin(counts, limits));
+  limits.allocations = 1;
+  EXPECT_TRUE(boost_plugin_loader::callsWithin(counts, limits));
+}
+
+TEST(BoostPluginLoaderCallCountUnit, ColdLookup)  // NOLINT
+{
+  using boost_plugin_loader::CallCounter;
+  using boost_plugin_loader::TestPluginMultiply;
+
+  if (!CallCounter::isSupported())
+    GTEST_SKIP() << "Calls cannot be counted in this build";
+
+  // Only the library which has the plugin is loaded
+  const boost_plugin_loader::PluginLoader plugin_loader = createPluginLoader();
+  const CallCounter counter;
+  EXPECT_NE(plugin_loader.createInstance<TestPluginMultiply>(getSymbolName()), nullptr);
+  EXPECT_EQ(counter.counts().dlopens, 1);
+}
+
+TEST(BoostPluginLoaderCallCountUnit, WarmLookup)  // NOLINT
+{
+  using boost_plugin_loader::CallCounts;
+  using boost_plugin_loader::TestPluginAdd;
+  using boost_plugin_loader::TestPluginMultiply;
+
+  boost_plugin_loader::PluginLoader plugin_loader = createPluginLoader();
+  EXPECT_NE(plugin_loader.createInstance<TestPluginAdd>(getSymbolName()), nullptr);
+  std::shared_ptr<TestPluginMultiply> plugin;
+
+  // Warm lookups do not touch the file system or load libraries, and allocate a bounded amount
+  CallCounts limits;
+  limits.dlsyms = 2;
+  limits.allocations = 12;
+  EXPECT_CALLS_WITHIN(plugin = plugin_loader.createInstance<TestPluginMultiply>(getSymbolName()), limits);
+  EXPECT_CALLS_WITHIN(plugin = plugin_loader.createInstance<TestPluginMultiply>(getSymbolName()), limits);
+  EXPECT_CALLS_WITHIN(EXPECT_TRUE(plugin_loader.isPluginAvailable(getSymbolName())), limits);
+
+  // Lookups served from the per-thread cache do not look up the symbol again
+  plugin_loader.thread_local_cache = true;
+  plugin = plugin_loader.createInstance<TestPluginMultiply>(getSymbolName());
+  limits.dlsyms = 0;
+  limits.allocations = 1;
+  EXPECT_CALLS_WITHIN(plugin = plugin_loader.createInstance<TestPluginMultiply>(getSymbolName()), limits);
+}
+
+TEST(BoostPluginLoaderCallCountUnit, FrozenLookup)  // NOLINT
+{
+  using boost_plugin_loader::CallCounts;
+  using boost_plugin_loader::TestPluginAdd;
+  using boost_plugin_loader::TestPluginMultiply;
+
+  boost_plugin_loader::PluginLoader plugin_loader = createPluginLoader();
+  plugin_loader.freeze();
+  std::shared_ptr<TestPluginMultiply> plugin = plugin_loader.createInstance<TestPluginMultiply>(getSymbolName());
+  EXPECT_NE(plugin, nullptr);
+
+  // Frozen lookups do not touch the file system, look up symbols or allocate
+  const CallCounts limits;
+  EXPECT_CALLS_WITHIN(plugin = plugin_loader.createInstance<TestPluginMultiply>(getSymbolName()), limits);
+  EXPECT_CALLS_WITHIN(plugin_loader.tryCreateInstance<TestPluginAdd>(getSymbolName()), limits);
+  EXPECT_CALLS_WITHIN(EXPECT_TRUE(plugin_loader.isPluginAvailable(getSymbolName())), limits);
+  EXPECT_CALLS_WITHIN(EXPECT_FALSE(plugin_loader.isPluginAvailable("does_not_exist")), limits);
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+
+  return RUN_ALL_TESTS();
+}
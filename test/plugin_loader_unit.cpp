@@ -21,7 +21,9 @@
 #include <gtest/gtest.h>
 
 // STD
+#include <algorithm>
 #include <string>
+#include <string_view>
 #include <set>
 #include <vector>
 #include <optional>
@@ -29,17 +31,32 @@
 #include <cstdlib>  // NOLINT(misc-include-cleaner)
 #include <thread>
 #include <chrono>
+#include <mutex>
+#include <sstream>
+#include <fstream>
+#include <cstdint>
+#include <typeinfo>
 using namespace std::chrono_literals;
 
 // Boost
 #include <boost/version.hpp>
 #include <boost/dll/shared_library.hpp>
+#include <boost/filesystem/operations.hpp>
 #include <boost/filesystem/path.hpp>
+#include <boost/preprocessor/stringize.hpp>
 
 // Boost Plugin Loader
 #include <boost_plugin_loader/utils.h>
 #include <boost_plugin_loader/plugin_loader.h>
 #include <boost_plugin_loader/plugin_loader.hpp>
+#include <boost_plugin_loader/plugin_loader_listener.h>
+#include <boost_plugin_loader/chrome_trace_listener.h>
+#include <boost_plugin_loader/frozen_plugin_table.h>
+#include <boost_plugin_loader/library_manifest.h>
+#include <boost_plugin_loader/library_registry.h>
+#include <boost_plugin_loader/library_watcher.h>
+#include <boost_plugin_loader/plugin_load_profile.h>
+#include <boost_plugin_loader/plugin_record.h>
 #include "test_plugin.h"
 
 TEST(BoostPluginLoaderUnit, Utils)  // NOLINT
@@ -160,6 +177,18 @@ TEST(BoostPluginLoaderUnit, Utils)  // NOLINT
     EXPECT_FALSE(lib.has("does_not_exist"));
   }
 
+  {
+    EXPECT_TRUE(matchesGlob("libpack_plugins.so", "lib*_plugins.so"));
+    EXPECT_TRUE(matchesGlob("lib_plugins.so", "lib*_plugins.so"));
+    EXPECT_TRUE(matchesGlob("libab.so", "lib??.so"));
+    EXPECT_FALSE(matchesGlob("libpack_plugins.so.1", "lib*_plugins.so"));
+    EXPECT_FALSE(matchesGlob("libpack.so", "lib*_plugins.so"));
+    const std::string lib_file =
+        boost::dll::shared_library::decorate(boost::filesystem::path(lib_dir) / lib_name).string();
+    EXPECT_TRUE(hasSharedLibraryHeader(lib_file));
+    EXPECT_FALSE(hasSharedLibraryHeader(lib_file + ".does_not_exist"));
+  }
+
   // Load the plugin
   // NOLINTNEXTLINE(cppcoreguidelines-avoid-goto)
   EXPECT_NO_THROW(createSharedInstance<TestPluginMultiply>(lib, getSymbolName()));
@@ -409,6 +438,1582 @@ TEST(BoostPluginLoaderUnit, LoadTestPluginsSameSymbolDifferentSections)  // NOLI
   }
 }
 
+/** @brief Listener which records the type of every event it receives */
+class RecordingListener : public boost_plugin_loader::PluginLoaderListener
+{
+public:
+  void onLibraryLoadStart(const boost_plugin_loader::PluginLoaderEvent& event) override
+  {
+    record(event);
+  }
+  void onLibraryLoadEnd(const boost_plugin_loader::PluginLoaderEvent& event) override
+  {
+    record(event);
+  }
+  void onSymbolResolved(const boost_plugin_loader::PluginLoaderEvent& event) override
+  {
+    record(event);
+  }
+  void onInstanceCreated(const boost_plugin_loader::PluginLoaderEvent& event) override
+  {
+    record(event);
+  }
+  void onFailure(const boost_plugin_loader::PluginLoaderEvent& event) override
+  {
+    record(event);
+  }
+  void onLibraryEvicted(const boost_plugin_loader::PluginLoaderEvent& event) override
+  {
+    record(event);
+  }
+  void onLoadWave(const boost_plugin_loader::PluginLoaderEvent& event) override
+  {
+    record(event);
+  }
+
+  std::size_t count(boost_plugin_loader::PluginLoaderEventType type) const
+  {
+    const std::scoped_lock lock(mutex_);
+    return static_cast<std::size_t>(
+        std::count_if(events_.begin(), events_.end(), [type](const auto& event) { return event.type == type; }));
+  }
+
+  std::vector<boost_plugin_loader::PluginLoaderEvent> events() const
+  {
+    const std::scoped_lock lock(mutex_);
+    return events_;
+  }
+
+private:
+  mutable std::mutex mutex_;
+  std::vector<boost_plugin_loader::PluginLoaderEvent> events_;
+
+  void record(const boost_plugin_loader::PluginLoaderEvent& event)
+  {
+    const std::scoped_lock lock(mutex_);
+    events_.push_back(event);
+  }
+};
+
+TEST(BoostPluginLoaderUnit, Listeners)  // NOLINT
+{
+  using boost_plugin_loader::ChromeTraceListener;
+  using boost_plugin_loader::PluginLoader;
+  using boost_plugin_loader::PluginLoaderEventType;
+  using boost_plugin_loader::TestPluginMultiply;
+
+  auto recorder = std::make_shared<RecordingListener>();
+  auto trace = std::make_shared<ChromeTraceListener>();
+
+  PluginLoader plugin_loader;
+  plugin_loader.search_system_folders = false;
+  plugin_loader.search_paths.emplace_back(PLUGIN_DIR);
+  plugin_loader.search_libraries.emplace_back(PLUGINS_MULTIPLY);
+  plugin_loader.listeners = { recorder, trace };
+
+  auto plugin = plugin_loader.createInstance<TestPluginMultiply>(getSymbolName());
+  EXPECT_TRUE(plugin != nullptr);
+  EXPECT_EQ(recorder->count(PluginLoaderEventType::LIBRARY_LOAD_START), 1);
+  EXPECT_EQ(recorder->count(PluginLoaderEventType::LIBRARY_LOAD_END), 1);
+  EXPECT_EQ(recorder->count(PluginLoaderEventType::SYMBOL_RESOLVED), 1);
+  EXPECT_EQ(recorder->count(PluginLoaderEventType::INSTANCE_CREATED), 1);
+  EXPECT_EQ(recorder->count(PluginLoaderEventType::FAILURE), 0);
+
+  // The library is cached, so a second instance should not trigger another load
+  plugin = plugin_loader.createInstance<TestPluginMultiply>(getSymbolName());
+  EXPECT_EQ(recorder->count(PluginLoaderEventType::LIBRARY_LOAD_START), 1);
+  EXPECT_EQ(recorder->count(PluginLoaderEventType::INSTANCE_CREATED), 2);
+
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-goto)
+  EXPECT_ANY_THROW(plugin_loader.createInstance<TestPluginMultiply>("does_not_exist"));
+  EXPECT_EQ(recorder->count(PluginLoaderEventType::FAILURE), 1);
+
+  for (const auto& event : recorder->events())
+  {
+    EXPECT_EQ(event.thread_id, std::this_thread::get_id());
+    if (event.type == PluginLoaderEventType::LIBRARY_LOAD_END)
+    {
+      EXPECT_TRUE(event.success);
+    }
+    if (event.type == PluginLoaderEventType::INSTANCE_CREATED)
+    {
+      EXPECT_EQ(event.plugin, getSymbolName());
+    }
+    if (event.type == PluginLoaderEventType::FAILURE)
+    {
+      // The failure carries a short description, and the detailed message is formatted from the exception on demand
+      EXPECT_EQ(event.message, toString(boost_plugin_loader::PluginLoaderErrorCode::PLUGIN_NOT_FOUND));
+      ASSERT_TRUE(event.exception != nullptr);
+      try
+      {
+        std::rethrow_exception(event.exception);
+      }
+      catch (const boost_plugin_loader::PluginNotFoundException& e)
+      {
+        EXPECT_EQ(e.getPluginName(), "does_not_exist");
+        EXPECT_NE(std::string(e.what()).find("Search Libraries"), std::string::npos);
+      }
+    }
+  }
+
+  // One begin/end pair for the load, two resolutions, two instances and one failure
+  EXPECT_EQ(trace->size(), 7);
+  std::stringstream json;
+  trace->write(json);
+  EXPECT_EQ(json.str().rfind("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", 0), 0);
+  EXPECT_NE(json.str().find("\"ph\":\"B\""), std::string::npos);
+  EXPECT_NE(json.str().find("\"ph\":\"E\""), std::string::npos);
+  EXPECT_NE(json.str().find("\"ph\":\"X\""), std::string::npos);
+
+  trace->clear();
+  EXPECT_EQ(trace->size(), 0);
+}
+
+TEST(BoostPluginLoaderUnit, LoadModes)  // NOLINT
+{
+  using boost_plugin_loader::PluginLoader;
+  using boost_plugin_loader::TestPluginAdd;
+  using boost_plugin_loader::TestPluginMultiply;
+
+  {
+    const std::optional<boost::dll::shared_library> lib =
+        boost_plugin_loader::loadLibrary(boost::filesystem::path(PLUGIN_DIR) / PLUGINS_MULTIPLY,
+                                         boost::dll::load_mode::rtld_now | boost::dll::load_mode::rtld_global);
+    EXPECT_TRUE(lib.has_value());
+  }
+
+  PluginLoader plugin_loader;
+  plugin_loader.search_system_folders = false;
+  plugin_loader.search_paths.emplace_back(PLUGIN_DIR);
+  plugin_loader.search_libraries.emplace_back(PLUGINS_MULTIPLY);
+  plugin_loader.search_libraries.emplace_back(PLUGINS_ADD);
+  plugin_loader.load_mode = boost::dll::load_mode::rtld_now;
+  plugin_loader.library_load_modes[PLUGINS_ADD] = boost::dll::load_mode::rtld_lazy | boost::dll::load_mode::rtld_local;
+
+  auto multiply = plugin_loader.createInstance<TestPluginMultiply>(getSymbolName());
+  EXPECT_NEAR(multiply->multiply(5, 5), 25, 1e-8);
+  auto add = plugin_loader.createInstance<TestPluginAdd>(getSymbolName());
+  EXPECT_NEAR(add->add(5, 5), 10, 1e-8);
+
+  // The load modes are part of the configuration which is copied
+  const PluginLoader copy(plugin_loader);  // NOLINT(performance-unnecessary-copy-initialization)
+  EXPECT_EQ(copy.load_mode, boost::dll::load_mode::rtld_now);
+  EXPECT_EQ(copy.library_load_modes.size(), 1);
+}
+
+TEST(BoostPluginLoaderUnit, LibraryEviction)  // NOLINT
+{
+  using boost_plugin_loader::LibraryEvictionReport;
+  using boost_plugin_loader::PluginLoader;
+  using boost_plugin_loader::TestPluginAdd;
+  using boost_plugin_loader::TestPluginMultiply;
+
+  const std::string multiply_key = (boost::filesystem::path(PLUGIN_DIR) / PLUGINS_MULTIPLY).string();
+  const std::string add_key = (boost::filesystem::path(PLUGIN_DIR) / PLUGINS_ADD).string();
+
+  {  // Explicit eviction only unloads idle libraries
+    PluginLoader plugin_loader;
+    plugin_loader.search_system_folders = false;
+    plugin_loader.search_paths.emplace_back(PLUGIN_DIR);
+    plugin_loader.search_libraries.emplace_back(PLUGINS_MULTIPLY);
+    plugin_loader.search_libraries.emplace_back(PLUGINS_ADD);
+    EXPECT_EQ(plugin_loader.getAvailableSections().size(), 2);
+
+    auto plugin = plugin_loader.createInstance<TestPluginMultiply>(getSymbolName());
+    auto plugin_copy = plugin;
+    auto counts = plugin_loader.getLiveInstanceCounts();
+    EXPECT_EQ(counts.size(), 2);
+    EXPECT_EQ(counts.at(multiply_key), 1);
+    EXPECT_EQ(counts.at(add_key), 0);
+
+    auto other_plugin = plugin_loader.createInstance<TestPluginMultiply>(getSymbolName());
+    EXPECT_EQ(plugin_loader.getLiveInstanceCounts().at(multiply_key), 2);
+
+    LibraryEvictionReport report = plugin_loader.evictIdleLibraries();
+    EXPECT_EQ(report.unloaded, std::vector<std::string>{ add_key });
+    EXPECT_EQ(report.retained, std::vector<std::string>{ multiply_key });
+
+    // The instances remain usable, and the library is unloaded once they are gone
+    EXPECT_NEAR(plugin->multiply(5, 5), 25, 1e-8);
+    plugin.reset();
+    plugin_copy.reset();
+    other_plugin.reset();
+    EXPECT_EQ(plugin_loader.getLiveInstanceCounts().at(multiply_key), 0);
+
+    report = plugin_loader.evictIdleLibraries();
+    EXPECT_EQ(report.unloaded, std::vector<std::string>{ multiply_key });
+    EXPECT_TRUE(report.retained.empty());
+  }
+
+  {  // A library count budget evicts the least recently used idle libraries
+    PluginLoader plugin_loader;
+    plugin_loader.search_system_folders = false;
+    plugin_loader.search_paths.emplace_back(PLUGIN_DIR);
+    plugin_loader.max_cached_libraries = 1;
+
+    // Libraries used by the current call are never evicted
+    plugin_loader.search_libraries = { PLUGINS_MULTIPLY, PLUGINS_ADD };
+    EXPECT_EQ(plugin_loader.getAvailableSections().size(), 2);
+    EXPECT_EQ(plugin_loader.getLiveInstanceCounts().size(), 2);
+
+    plugin_loader.search_libraries = { PLUGINS_ADD };
+    auto plugin = plugin_loader.createInstance<TestPluginAdd>(getSymbolName());
+    auto counts = plugin_loader.getLiveInstanceCounts();
+    EXPECT_EQ(counts.size(), 1);
+    EXPECT_EQ(counts.at(add_key), 1);
+
+    // The add library has a live instance, so it is retained
+    plugin_loader.search_libraries = { PLUGINS_MULTIPLY };
+    EXPECT_TRUE(plugin_loader.isPluginAvailable(getSymbolName()));
+    EXPECT_EQ(plugin_loader.getLiveInstanceCounts().size(), 2);
+
+    plugin.reset();
+    EXPECT_TRUE(plugin_loader.isPluginAvailable(getSymbolName()));
+    counts = plugin_loader.getLiveInstanceCounts();
+    EXPECT_EQ(counts.size(), 1);
+    EXPECT_EQ(counts.count(multiply_key), 1);
+  }
+
+  {  // A byte budget smaller than any library keeps only the libraries in use
+    PluginLoader plugin_loader;
+    plugin_loader.search_system_folders = false;
+    plugin_loader.search_paths.emplace_back(PLUGIN_DIR);
+    plugin_loader.max_cached_library_bytes = 1;
+
+    plugin_loader.search_libraries = { PLUGINS_MULTIPLY };
+    EXPECT_TRUE(plugin_loader.isPluginAvailable(getSymbolName()));
+    plugin_loader.search_libraries = { PLUGINS_ADD };
+    EXPECT_TRUE(plugin_loader.isPluginAvailable(getSymbolName()));
+
+    const auto counts = plugin_loader.getLiveInstanceCounts();
+    EXPECT_EQ(counts.size(), 1);
+    EXPECT_EQ(counts.count(add_key), 1);
+  }
+
+  {  // Each plugin loader tracks the recency of the libraries it shares with others through the registry
+    auto make_loader = []() {
+      PluginLoader plugin_loader;
+      plugin_loader.search_system_folders = false;
+      plugin_loader.search_paths.emplace_back(PLUGIN_DIR);
+      plugin_loader.search_libraries.emplace_back(PLUGINS_MULTIPLY);
+      plugin_loader.use_shared_registry = true;
+      plugin_loader.max_cached_libraries = 1;
+      return plugin_loader;
+    };
+
+    PluginLoader first = make_loader();
+    PluginLoader second = make_loader();
+    EXPECT_TRUE(first.isPluginAvailable(getSymbolName()));
+    for (int i = 0; i < 3; ++i)
+      EXPECT_TRUE(second.isPluginAvailable(getSymbolName()));
+
+    // The multiply library was used more recently by the second plugin loader, but not by the first one
+    first.search_libraries = { PLUGINS_ADD };
+    EXPECT_TRUE(first.isPluginAvailable(getSymbolName()));
+    const auto counts = first.getLiveInstanceCounts();
+    EXPECT_EQ(counts.size(), 1);
+    EXPECT_EQ(counts.count(add_key), 1);
+    EXPECT_EQ(second.getLiveInstanceCounts().size(), 1);
+  }
+}
+
+TEST(BoostPluginLoaderUnit, PageCacheWarming)  // NOLINT
+{
+  using boost_plugin_loader::PluginLoader;
+  using boost_plugin_loader::TestPluginMultiply;
+
+  const std::string library_file =
+      boost::dll::shared_library::decorate(boost::filesystem::path(PLUGIN_DIR) / PLUGINS_MULTIPLY).string();
+  const std::size_t advised = boost_plugin_loader::prefetchFiles({ library_file, "does_not_exist" });
+  EXPECT_LE(advised, 1);
+#ifdef __linux__
+  EXPECT_EQ(advised, 1);
+#endif
+
+  const std::optional<boost::dll::shared_library> lib =
+      boost_plugin_loader::loadLibrary(boost::filesystem::path(PLUGIN_DIR) / PLUGINS_MULTIPLY);
+  ASSERT_TRUE(lib.has_value());
+#ifdef __linux__
+  EXPECT_TRUE(boost_plugin_loader::prefaultLibrary(lib.value()));
+#endif
+  EXPECT_FALSE(boost_plugin_loader::prefaultLibrary(boost::dll::shared_library()));
+
+  PluginLoader plugin_loader;
+  plugin_loader.search_system_folders = false;
+  plugin_loader.search_paths.emplace_back("does_not_exist");
+  plugin_loader.search_paths.emplace_back(PLUGIN_DIR);
+  plugin_loader.search_libraries.emplace_back(PLUGINS_MULTIPLY);
+  plugin_loader.search_libraries.emplace_back(PLUGINS_ADD);
+  plugin_loader.warm_page_cache = true;
+  plugin_loader.hot_libraries.emplace_back(PLUGINS_MULTIPLY);
+
+  auto plugin = plugin_loader.createInstance<TestPluginMultiply>(getSymbolName());
+  EXPECT_NEAR(plugin->multiply(5, 5), 25, 1e-8);
+  EXPECT_EQ(plugin_loader.getAvailableSections().size(), 2);
+}
+
+TEST(BoostPluginLoaderUnit, HotReload)  // NOLINT
+{
+  using boost_plugin_loader::LibraryWatcher;
+  using boost_plugin_loader::PluginLoader;
+  using boost_plugin_loader::TestPluginAdd;
+  using boost_plugin_loader::TestPluginMultiply;
+
+  if (!LibraryWatcher::isSupported())
+    GTEST_SKIP() << "Watching libraries is not supported on this platform";
+
+  // Stage a library which initially contains the multiply plugin
+  const boost::filesystem::path directory =
+      boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("hot_reload_%%%%%%%%");
+  boost::filesystem::create_directories(directory);
+  const std::string library_name = "hot_reload_plugin";
+  const boost::filesystem::path library_file = boost::dll::shared_library::decorate(directory / library_name);
+  boost::filesystem::copy_file(
+      boost::dll::shared_library::decorate(boost::filesystem::path(PLUGIN_DIR) / PLUGINS_MULTIPLY), library_file);
+
+  auto listener = std::make_shared<RecordingListener>();
+  PluginLoader plugin_loader;
+  plugin_loader.search_system_folders = false;
+  plugin_loader.search_paths.push_back(directory.string());
+  plugin_loader.search_libraries.push_back(library_name);
+  plugin_loader.listeners.push_back(listener);
+  plugin_loader.watch_libraries = true;
+
+  auto multiply = plugin_loader.createInstance<TestPluginMultiply>(getSymbolName());
+  EXPECT_NEAR(multiply->multiply(5, 5), 25, 1e-8);
+  EXPECT_EQ(plugin_loader.getAvailableSections(), std::vector<std::string>{ "mult" });
+  EXPECT_EQ(listener->count(boost_plugin_loader::PluginLoaderEventType::LIBRARY_EVICTED), 0);
+
+  // Replace the library atomically with one containing the add plugin
+  const boost::filesystem::path staged_file = directory / "staged";
+  boost::filesystem::copy_file(
+      boost::dll::shared_library::decorate(boost::filesystem::path(PLUGIN_DIR) / PLUGINS_ADD), staged_file);
+  boost::filesystem::rename(staged_file, library_file);
+
+  // Only the changed library is reloaded, and the existing instance keeps the old version mapped
+  EXPECT_EQ(plugin_loader.getAvailableSections(), std::vector<std::string>{ "add" });
+  EXPECT_EQ(listener->count(boost_plugin_loader::PluginLoaderEventType::LIBRARY_EVICTED), 1);
+  auto add = plugin_loader.createInstance<TestPluginAdd>(getSymbolName());
+  EXPECT_NEAR(add->add(5, 5), 10, 1e-8);
+  EXPECT_NEAR(multiply->multiply(5, 5), 25, 1e-8);
+  EXPECT_ANY_THROW(plugin_loader.createInstance<TestPluginMultiply>(getSymbolName()));  // NOLINT
+
+  // Without changes nothing is reloaded
+  EXPECT_EQ(plugin_loader.getAvailableSections(), std::vector<std::string>{ "add" });
+  EXPECT_EQ(listener->count(boost_plugin_loader::PluginLoaderEventType::LIBRARY_EVICTED), 1);
+
+  multiply.reset();
+  add.reset();
+  plugin_loader.clear();
+  boost::filesystem::remove_all(directory);
+}
+
+TEST(BoostPluginLoaderUnit, LibraryWatcher)  // NOLINT
+{
+  using boost_plugin_loader::LibraryChanges;
+  using boost_plugin_loader::LibraryWatcher;
+
+  if (!LibraryWatcher::isSupported())
+    GTEST_SKIP() << "Watching libraries is not supported on this platform";
+
+  const boost::filesystem::path root =
+      boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("library_watcher_%%%%%%%%");
+  const boost::filesystem::path directory = root / "plugins";
+  boost::filesystem::create_directories(directory);
+  const std::string canonical_directory = boost::filesystem::canonical(directory).string();
+  const std::string file = canonical_directory + "/libplugin.so";
+
+  LibraryWatcher watcher;
+  ASSERT_TRUE(watcher.watchDirectory(directory.string()));
+  EXPECT_TRUE(watcher.poll().empty());
+
+  std::ofstream(file) << "v1";
+  LibraryChanges changes = watcher.poll();
+  EXPECT_EQ(changes.files, std::vector<std::string>{ file });
+  EXPECT_TRUE(changes.isChanged(file));
+  EXPECT_FALSE(changes.isChanged(canonical_directory + "/libother.so"));
+
+  // A directory which is removed and recreated is reported as a whole, and watched again once it is passed again
+  boost::filesystem::remove_all(directory);
+  boost::filesystem::create_directories(directory);
+  changes = watcher.poll();
+  EXPECT_EQ(changes.directories, std::vector<std::string>{ canonical_directory });
+  EXPECT_TRUE(changes.isChanged(canonical_directory + "/libother.so"));
+  ASSERT_TRUE(watcher.watchDirectory(directory.string()));
+  std::ofstream(file) << "v2";
+  EXPECT_EQ(watcher.poll().files, std::vector<std::string>{ file });
+
+  // When the event queue overflows, every file is considered changed
+  std::ifstream max_events_file("/proc/sys/fs/inotify/max_queued_events");
+  std::size_t max_events{ 0 };
+  if (max_events_file >> max_events && max_events <= 65536)
+  {
+    for (std::size_t i = 0; i <= max_events; ++i)
+      std::ofstream(canonical_directory + "/file_" + std::to_string(i));
+
+    changes = watcher.poll();
+    EXPECT_TRUE(changes.overflow);
+    EXPECT_TRUE(changes.isChanged("/does_not_exist/libplugin.so"));
+  }
+
+  boost::filesystem::remove_all(root);
+}
+
+TEST(BoostPluginLoaderUnit, IncrementalResolution)  // NOLINT
+{
+  using boost_plugin_loader::PluginLoader;
+  using boost_plugin_loader::PluginLoaderEventType;
+
+  auto listener = std::make_shared<RecordingListener>();
+  PluginLoader plugin_loader;
+  plugin_loader.search_system_folders = false;
+  plugin_loader.search_paths.emplace_back("does_not_exist");
+  plugin_loader.search_paths.emplace_back(PLUGIN_DIR);
+  plugin_loader.search_libraries.emplace_back(PLUGINS_MULTIPLY);
+  plugin_loader.listeners.push_back(listener);
+
+  // The library is searched for in each search path until it is found
+  EXPECT_EQ(plugin_loader.getAvailableSections().size(), 1);
+  EXPECT_EQ(listener->count(PluginLoaderEventType::LIBRARY_LOAD_START), 2);
+
+  // Resolved libraries are not searched for again
+  EXPECT_EQ(plugin_loader.getAvailableSections().size(), 1);
+  EXPECT_EQ(listener->count(PluginLoaderEventType::LIBRARY_LOAD_START), 2);
+
+  // Only added libraries are searched for
+  plugin_loader.search_libraries.emplace_back(PLUGINS_ADD);
+  EXPECT_EQ(plugin_loader.getAvailableSections().size(), 2);
+  EXPECT_EQ(listener->count(PluginLoaderEventType::LIBRARY_LOAD_START), 4);
+
+  // Appending a search path does not affect resolved libraries
+  plugin_loader.search_paths.emplace_back("also_does_not_exist");
+  EXPECT_EQ(plugin_loader.getAvailableSections().size(), 2);
+  EXPECT_EQ(listener->count(PluginLoaderEventType::LIBRARY_LOAD_START), 4);
+
+  // Prepending a search path may shadow resolved libraries, so they are searched for again (and found in the cache)
+  plugin_loader.search_paths.insert(plugin_loader.search_paths.begin(), "also_does_not_exist");
+  EXPECT_EQ(plugin_loader.getAvailableSections().size(), 2);
+  EXPECT_EQ(listener->count(PluginLoaderEventType::LIBRARY_LOAD_START), 8);
+
+  // Removed libraries are dropped
+  plugin_loader.search_libraries.pop_back();
+  EXPECT_EQ(plugin_loader.getAvailableSections(), std::vector<std::string>{ "mult" });
+  EXPECT_EQ(listener->count(PluginLoaderEventType::LIBRARY_LOAD_START), 8);
+
+  // Libraries are searched for again after the cache is cleared
+  plugin_loader.clear();
+  EXPECT_EQ(plugin_loader.getAvailableSections().size(), 1);
+  EXPECT_EQ(listener->count(PluginLoaderEventType::LIBRARY_LOAD_START), 11);
+}
+
+TEST(BoostPluginLoaderUnit, SharedCache)  // NOLINT
+{
+  using boost_plugin_loader::PluginLoader;
+  using boost_plugin_loader::PluginLoaderEventType;
+  using boost_plugin_loader::TestPluginMultiply;
+
+  auto listener = std::make_shared<RecordingListener>();
+  PluginLoader plugin_loader;
+  plugin_loader.search_system_folders = false;
+  plugin_loader.search_paths.emplace_back(PLUGIN_DIR);
+  plugin_loader.search_libraries.emplace_back(PLUGINS_MULTIPLY);
+  plugin_loader.listeners.push_back(listener);
+  EXPECT_EQ(plugin_loader.getAvailableSections().size(), 1);
+  EXPECT_EQ(listener->count(PluginLoaderEventType::LIBRARY_LOAD_START), 1);
+
+  // Copies share the loaded libraries
+  PluginLoader copy(plugin_loader);
+  EXPECT_EQ(copy.getAvailableSections().size(), 1);
+  EXPECT_EQ(listener->count(PluginLoaderEventType::LIBRARY_LOAD_START), 1);
+  auto plugin = copy.createInstance<TestPluginMultiply>(getSymbolName());
+  EXPECT_EQ(plugin_loader.getLiveInstanceCounts().begin()->second, 1);
+
+  // Clearing a copy does not affect the original
+  copy.clear();
+  EXPECT_TRUE(copy.getLiveInstanceCounts().empty());
+  EXPECT_EQ(plugin_loader.getLiveInstanceCounts().size(), 1);
+  EXPECT_EQ(plugin_loader.getAvailableSections().size(), 1);
+  EXPECT_EQ(listener->count(PluginLoaderEventType::LIBRARY_LOAD_START), 1);
+
+  // A copy whose search configuration diverges keeps the libraries loaded so far
+  PluginLoader diverged = plugin_loader;
+  diverged.search_paths.insert(diverged.search_paths.begin(), "does_not_exist");
+  EXPECT_EQ(diverged.getAvailableSections().size(), 1);
+  EXPECT_EQ(listener->count(PluginLoaderEventType::LIBRARY_LOAD_START), 2);
+  EXPECT_EQ(plugin_loader.getAvailableSections().size(), 1);
+  EXPECT_EQ(listener->count(PluginLoaderEventType::LIBRARY_LOAD_START), 2);
+
+  // A moved from plugin loader remains usable
+  PluginLoader moved = std::move(diverged);
+  EXPECT_EQ(moved.getLiveInstanceCounts().size(), 1);
+  EXPECT_TRUE(diverged.getLiveInstanceCounts().empty());  // NOLINT(bugprone-use-after-move)
+
+  // Evicting from a copy does not unload the libraries of the original
+  plugin.reset();
+  PluginLoader evicting = plugin_loader;
+  EXPECT_EQ(evicting.evictIdleLibraries().unloaded.size(), 1);
+  EXPECT_TRUE(evicting.getLiveInstanceCounts().empty());
+  EXPECT_EQ(plugin_loader.getLiveInstanceCounts().size(), 1);
+
+  // Nor does a copy enforcing its budget, although the library it loaded is shared before it evicts
+  const std::string add_key = (boost::filesystem::path(PLUGIN_DIR) / PLUGINS_ADD).string();
+  PluginLoader budgeted = plugin_loader;
+  budgeted.max_cached_libraries = 1;
+  budgeted.search_libraries = { PLUGINS_ADD };
+  EXPECT_EQ(budgeted.getAvailableSections().size(), 1);
+  EXPECT_EQ(budgeted.getLiveInstanceCounts().size(), 1);
+  EXPECT_EQ(budgeted.getLiveInstanceCounts().count(add_key), 1);
+  EXPECT_EQ(plugin_loader.getLiveInstanceCounts().size(), 2);
+}
+
+TEST(BoostPluginLoaderUnit, SharedRegistry)  // NOLINT
+{
+  using boost_plugin_loader::LibraryRegistry;
+  using boost_plugin_loader::PluginLoader;
+  using boost_plugin_loader::PluginLoaderEventType;
+  using boost_plugin_loader::TestPluginMultiply;
+
+  const std::size_t registered = LibraryRegistry::instance().size();
+
+  auto listener = std::make_shared<RecordingListener>();
+  auto make_loader = [&listener](bool use_shared_registry) {
+    PluginLoader plugin_loader;
+    plugin_loader.search_system_folders = false;
+    plugin_loader.search_paths.emplace_back(PLUGIN_DIR);
+    plugin_loader.search_libraries.emplace_back(PLUGINS_MULTIPLY);
+    plugin_loader.listeners.push_back(listener);
+    plugin_loader.use_shared_registry = use_shared_registry;
+    return plugin_loader;
+  };
+
+  {
+    PluginLoader first = make_loader(true);
+    auto plugin = first.createInstance<TestPluginMultiply>(getSymbolName());
+    EXPECT_EQ(listener->count(PluginLoaderEventType::LIBRARY_LOAD_START), 1);
+    EXPECT_EQ(LibraryRegistry::instance().size(), registered + 1);
+
+    // Plugin loaders which opt in share the library, so the instance created by the first one is counted by the second
+    PluginLoader second = make_loader(true);
+    EXPECT_EQ(second.getAvailablePlugins<TestPluginMultiply>(), std::vector<std::string>{ getSymbolName() });
+    EXPECT_EQ(listener->count(PluginLoaderEventType::LIBRARY_LOAD_START), 1);
+    EXPECT_EQ(second.getLiveInstanceCounts().begin()->second, 1);
+
+    // Other plugin loaders load the library themselves
+    PluginLoader third = make_loader(false);
+    EXPECT_EQ(third.getAvailablePlugins<TestPluginMultiply>(), std::vector<std::string>{ getSymbolName() });
+    EXPECT_EQ(listener->count(PluginLoaderEventType::LIBRARY_LOAD_START), 2);
+    EXPECT_EQ(third.getLiveInstanceCounts().begin()->second, 0);
+  }
+
+  // The registry does not keep libraries alive
+  EXPECT_EQ(LibraryRegistry::instance().size(), registered);
+}
+
+TEST(BoostPluginLoaderUnit, TryCreateInstance)  // NOLINT
+{
+  using boost_plugin_loader::PluginLoader;
+  using boost_plugin_loader::PluginLoaderErrorCode;
+  using boost_plugin_loader::PluginNotFoundException;
+  using boost_plugin_loader::TestPluginAdd;
+  using boost_plugin_loader::TestPluginMultiply;
+
+  PluginLoader plugin_loader;
+  plugin_loader.search_system_folders = false;
+  plugin_loader.search_paths.emplace_back(PLUGIN_DIR);
+
+  PluginLoaderErrorCode error{ PluginLoaderErrorCode::SUCCESS };
+  EXPECT_EQ(plugin_loader.tryCreateInstance<TestPluginMultiply>(getSymbolName(), &error), nullptr);
+  EXPECT_EQ(error, PluginLoaderErrorCode::NO_LIBRARIES);
+
+  plugin_loader.search_libraries.emplace_back(PLUGINS_MULTIPLY);
+  auto plugin = plugin_loader.tryCreateInstance<TestPluginMultiply>(getSymbolName(), &error);
+  ASSERT_NE(plugin, nullptr);
+  EXPECT_EQ(error, PluginLoaderErrorCode::SUCCESS);
+  EXPECT_NEAR(plugin->multiply(5, 5), 25, 1e-8);
+
+  EXPECT_EQ(plugin_loader.tryCreateInstance<TestPluginMultiply>("does_not_exist", &error), nullptr);
+  EXPECT_EQ(error, PluginLoaderErrorCode::PLUGIN_NOT_FOUND);
+  EXPECT_EQ(plugin_loader.tryCreateInstance<TestPluginAdd>(getSymbolName()), nullptr);
+
+  // The detailed message is formatted on demand
+  try
+  {
+    plugin_loader.createInstance<TestPluginMultiply>("does_not_exist");
+    FAIL() << "Expected PluginNotFoundException";
+  }
+  catch (const PluginNotFoundException& e)
+  {
+    EXPECT_EQ(e.getPluginName(), "does_not_exist");
+    const PluginNotFoundException copy(e);  // NOLINT(performance-unnecessary-copy-initialization)
+    const std::string what = copy.what();
+    EXPECT_NE(what.find("Failed to create plugin instance 'does_not_exist'"), std::string::npos);
+    EXPECT_NE(what.find("Available plugins of type"), std::string::npos);
+    EXPECT_NE(what.find(getSymbolName()), std::string::npos);
+    EXPECT_EQ(std::string(e.what()), what);
+  }
+}
+
+TEST(BoostPluginLoaderUnit, Visitors)  // NOLINT
+{
+  using boost_plugin_loader::LoadedLibrary;
+  using boost_plugin_loader::PluginLoader;
+  using boost_plugin_loader::TestPluginAdd;
+  using boost_plugin_loader::TestPluginMultiply;
+
+  PluginLoader plugin_loader;
+  plugin_loader.search_system_folders = false;
+  plugin_loader.search_paths.emplace_back(PLUGIN_DIR);
+  plugin_loader.search_libraries.emplace_back(PLUGINS_MULTIPLY);
+  plugin_loader.search_libraries.emplace_back(PLUGINS_ADD);
+
+  std::vector<std::string_view> sections;
+  std::vector<LoadedLibrary::Ptr> libraries;
+  plugin_loader.forEachSection([&](std::string_view section, const LoadedLibrary::Ptr& lib) {
+    sections.push_back(section);
+    libraries.push_back(lib);
+  });
+  EXPECT_EQ(sections, (std::vector<std::string_view>{ "mult", "add" }));
+  EXPECT_EQ(sections, (std::vector<std::string_view>{ plugin_loader.getAvailableSections().at(0),
+                                                      plugin_loader.getAvailableSections().at(1) }));
+
+  std::size_t hidden_count{ 0 };
+  plugin_loader.forEachSection([&hidden_count](std::string_view /*section*/,
+                                               const LoadedLibrary::Ptr& /*lib*/) { ++hidden_count; },
+                               true);
+  EXPECT_EQ(hidden_count, plugin_loader.getAvailableSections(true).size());
+
+  // The names refer to the storage of the library, which remains valid while the library is referenced
+  std::vector<std::string_view> plugins;
+  plugin_loader.forEachPlugin(TestPluginAdd::getSection(), [&](std::string_view plugin, const LoadedLibrary::Ptr& lib) {
+    plugins.push_back(plugin);
+    EXPECT_EQ(lib, libraries.at(1));
+  });
+  plugin_loader.clear();
+  EXPECT_EQ(plugins, std::vector<std::string_view>{ getSymbolName() });
+
+  std::vector<std::string> hidden_plugins;
+  plugin_loader.forEachPlugin(".text", [&hidden_plugins](std::string_view plugin, const LoadedLibrary::Ptr& /*lib*/) {
+    hidden_plugins.emplace_back(plugin);
+  });
+  EXPECT_EQ(hidden_plugins, plugin_loader.getAvailablePlugins(".text"));
+  EXPECT_FALSE(hidden_plugins.empty());
+  EXPECT_EQ(plugin_loader.getAvailablePlugins<TestPluginMultiply>(), std::vector<std::string>{ getSymbolName() });
+}
+
+TEST(BoostPluginLoaderUnit, PreloadProfile)  // NOLINT
+{
+  using boost_plugin_loader::PluginLoader;
+  using boost_plugin_loader::PluginLoaderEventType;
+  using boost_plugin_loader::PluginLoadProfile;
+  using boost_plugin_loader::TestPluginMultiply;
+
+  auto make_loader = []() {
+    PluginLoader plugin_loader;
+    plugin_loader.search_system_folders = false;
+    plugin_loader.search_paths.emplace_back(PLUGIN_DIR);
+    plugin_loader.search_libraries.emplace_back(PLUGINS_MULTIPLY);
+    plugin_loader.search_libraries.emplace_back(PLUGINS_ADD);
+    return plugin_loader;
+  };
+
+  const boost::filesystem::path profile_file =
+      boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("plugin_load_profile_%%%%%%%%.txt");
+
+  // Record the plugins used by a run
+  {
+    auto profile = std::make_shared<PluginLoadProfile>();
+    EXPECT_FALSE(profile->load(profile_file.string()));
+    EXPECT_TRUE(profile->empty());
+
+    PluginLoader plugin_loader = make_loader();
+    plugin_loader.listeners.push_back(profile);
+    plugin_loader.createInstance<TestPluginMultiply>(getSymbolName());
+    plugin_loader.createInstance<TestPluginMultiply>(getSymbolName());
+    EXPECT_EQ(profile->getLibraries(), std::vector<std::string>{ PLUGINS_MULTIPLY });
+    EXPECT_EQ(profile->getEntries().size(), 1);
+    profile->save(profile_file.string());
+  }
+
+  // Preload the recorded libraries on the next run, ignoring libraries which are no longer configured
+  PluginLoadProfile profile;
+  std::istringstream stale("# comment\nmissing_library\tplugin\nmalformed\n");
+  profile.read(stale);
+  EXPECT_TRUE(profile.load(profile_file.string()));
+  boost::filesystem::remove(profile_file);
+  EXPECT_EQ(profile.getLibraries(), (std::vector<std::string>{ "missing_library", PLUGINS_MULTIPLY }));
+
+  auto listener = std::make_shared<RecordingListener>();
+  PluginLoader plugin_loader = make_loader();
+  plugin_loader.listeners.push_back(listener);
+  EXPECT_EQ(plugin_loader.preload(profile), 1);
+  EXPECT_EQ(listener->count(PluginLoaderEventType::LIBRARY_LOAD_START), 1);
+
+  // The preloaded library serves the first request and the other libraries remain lazy
+  auto plugin = plugin_loader.createInstance<TestPluginMultiply>(getSymbolName());
+  EXPECT_NEAR(plugin->multiply(5, 5), 25, 1e-8);
+  EXPECT_EQ(listener->count(PluginLoaderEventType::LIBRARY_LOAD_START), 1);
+  EXPECT_EQ(plugin_loader.getAvailableSections().size(), 2);
+  EXPECT_EQ(listener->count(PluginLoaderEventType::LIBRARY_LOAD_START), 2);
+
+  EXPECT_EQ(PluginLoader().preload(profile), 0);
+
+  // With discovery_patterns, only the recorded libraries are loaded and the other resolutions are kept
+  const boost::filesystem::path directory =
+      boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("preload_%%%%%%%%");
+  boost::filesystem::create_directories(directory);
+  boost::filesystem::copy_file(boost::dll::shared_library::decorate(boost::filesystem::path(PLUGIN_DIR) / PLUGINS_ADD),
+                               boost::dll::shared_library::decorate(directory / "add_plugins"));
+
+  auto discovery_listener = std::make_shared<RecordingListener>();
+  auto loaded = [&discovery_listener]() {
+    const auto events = discovery_listener->events();
+    return std::count_if(events.begin(), events.end(), [](const auto& event) {
+      return event.type == PluginLoaderEventType::LIBRARY_LOAD_END && event.success;
+    });
+  };
+
+  PluginLoader discovering = make_loader();
+  discovering.search_paths.insert(discovering.search_paths.begin(), directory.string());
+  discovering.discovery_patterns.push_back(boost::dll::shared_library::decorate("*_plugins").string());
+  discovering.listeners.push_back(discovery_listener);
+  EXPECT_EQ(discovering.preload(profile), 1);
+  EXPECT_EQ(loaded(), 1);
+
+  // Resolving the add library tries the discovery directory first, which is not repeated while its resolution is kept
+  EXPECT_EQ(discovering.getAvailableSections().size(), 3);
+  EXPECT_EQ(loaded(), 3);
+  const std::size_t load_attempts = discovery_listener->count(PluginLoaderEventType::LIBRARY_LOAD_START);
+  EXPECT_EQ(discovering.preload(profile), 1);
+  EXPECT_EQ(discovering.getAvailableSections().size(), 3);
+  EXPECT_EQ(discovery_listener->count(PluginLoaderEventType::LIBRARY_LOAD_START), load_attempts);
+
+  boost::filesystem::remove_all(directory);
+}
+
+TEST(BoostPluginLoaderUnit, ParallelLoad)  // NOLINT
+{
+  using boost_plugin_loader::getDependencyWaves;
+  using boost_plugin_loader::PluginLoader;
+  using boost_plugin_loader::PluginLoaderEventType;
+  using boost_plugin_loader::PluginLoaderException;
+  using boost_plugin_loader::TestPluginAdd;
+  using boost_plugin_loader::TestPluginMultiply;
+
+  // Tasks run once per index on the calling thread and reused workers, and may run nested calls
+  for (int round = 0; round < 3; ++round)
+  {
+    std::vector<std::atomic<int>> runs(64);
+    boost_plugin_loader::parallelFor(runs.size(), [&runs](std::size_t i) {
+      boost_plugin_loader::parallelFor(2, [&runs, i](std::size_t j) { runs[i] += static_cast<int>(j) + 1; });
+    });
+    EXPECT_TRUE(std::all_of(runs.begin(), runs.end(), [](const std::atomic<int>& count) { return count == 3; }));
+  }
+  EXPECT_THROW(boost_plugin_loader::parallelFor(  // NOLINT
+                   8,
+                   [](std::size_t i) {
+                     if (i == 5)
+                       throw PluginLoaderException("task failed");
+                   }),
+               PluginLoaderException);
+
+  const std::vector<std::string> names{ "a", "b", "c", "d" };
+  EXPECT_EQ(getDependencyWaves(names, { {}, { 0 }, {}, { 1, 2, 1 } }),
+            (std::vector<std::vector<std::size_t>>{ { 0, 2 }, { 1 }, { 3 } }));
+  EXPECT_THROW(getDependencyWaves(names, { {}, { 3 }, { 2 }, {} }), PluginLoaderException);  // NOLINT
+  EXPECT_THROW(getDependencyWaves(names, { { 1 }, { 3 }, {}, { 1 } }), PluginLoaderException);  // NOLINT
+
+  // Stage two libraries, where the add library declares a dependency on the multiply library
+  const boost::filesystem::path directory =
+      boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("parallel_load_%%%%%%%%");
+  boost::filesystem::create_directories(directory);
+  const boost::filesystem::path multiply_file = boost::dll::shared_library::decorate(directory / "wave_multiply");
+  const boost::filesystem::path add_file = boost::dll::shared_library::decorate(directory / "wave_add");
+  boost::filesystem::copy_file(
+      boost::dll::shared_library::decorate(boost::filesystem::path(PLUGIN_DIR) / PLUGINS_MULTIPLY), multiply_file);
+  boost::filesystem::copy_file(
+      boost::dll::shared_library::decorate(boost::filesystem::path(PLUGIN_DIR) / PLUGINS_ADD), add_file);
+  std::ofstream(add_file.string() + ".deps") << "# Dependencies\nwave_multiply\n";
+
+  auto listener = std::make_shared<RecordingListener>();
+  auto make_loader = [&]() {
+    PluginLoader plugin_loader;
+    plugin_loader.search_system_folders = false;
+    plugin_loader.search_paths.push_back(directory.string());
+    plugin_loader.search_libraries = { "wave_add", "wave_multiply", "does_not_exist" };
+    plugin_loader.listeners.push_back(listener);
+    plugin_loader.parallel_load = true;
+    return plugin_loader;
+  };
+
+  {
+    PluginLoader plugin_loader = make_loader();
+    auto add = plugin_loader.createInstance<TestPluginAdd>(getSymbolName());
+    EXPECT_NEAR(add->add(5, 5), 10, 1e-8);
+    EXPECT_EQ(listener->count(PluginLoaderEventType::LIBRARY_LOAD_START), 3);
+    EXPECT_EQ(plugin_loader.getAvailableSections(), (std::vector<std::string>{ "add", "mult" }));
+
+    // The libraries loaded in a wave are reported before the wave, and are not reported again when they are cached
+    std::vector<std::string> waves;
+    std::vector<std::string> loaded_libraries;
+    for (const auto& event : listener->events())
+    {
+      if (event.type == PluginLoaderEventType::LOAD_WAVE)
+      {
+        waves.push_back(event.library);
+        EXPECT_EQ(loaded_libraries.size(), waves.size());
+      }
+      else if (event.type == PluginLoaderEventType::LIBRARY_LOAD_END && event.success)
+      {
+        loaded_libraries.push_back(event.library);
+      }
+    }
+    EXPECT_EQ(waves, (std::vector<std::string>{ "wave_multiply", "wave_add" }));
+    EXPECT_EQ(loaded_libraries,
+              (std::vector<std::string>{ (directory / "wave_multiply").string(), (directory / "wave_add").string() }));
+  }
+
+  // Cyclic dependencies are reported
+  std::ofstream(multiply_file.string() + ".deps") << "wave_add\n";
+  try
+  {
+    make_loader().createInstance<TestPluginMultiply>(getSymbolName());
+    FAIL() << "Expected PluginLoaderException";
+  }
+  catch (const PluginLoaderException& e)
+  {
+    EXPECT_NE(std::string(e.what()).find("wave_add -> wave_multiply -> wave_add"), std::string::npos) << e.what();
+  }
+
+  boost::filesystem::remove_all(directory);
+}
+
+TEST(BoostPluginLoaderUnit, CreateAllInstances)  // NOLINT
+{
+  using boost_plugin_loader::PluginLoader;
+  using boost_plugin_loader::PluginLoaderEventType;
+  using boost_plugin_loader::PluginLoaderException;
+  using boost_plugin_loader::TestPluginAdd;
+  using boost_plugin_loader::TestPluginMultiply;
+
+  auto listener = std::make_shared<RecordingListener>();
+  PluginLoader plugin_loader;
+  plugin_loader.search_system_folders = false;
+  plugin_loader.search_paths.emplace_back(PLUGIN_DIR);
+  plugin_loader.listeners.push_back(listener);
+  EXPECT_THROW(plugin_loader.createAllInstances<TestPluginMultiply>(), PluginLoaderException);  // NOLINT
+
+  plugin_loader.search_libraries.emplace_back(PLUGINS_MULTIPLY);
+  plugin_loader.search_libraries.emplace_back(PLUGINS_ADD);
+  const auto multiply_plugins = plugin_loader.createAllInstances<TestPluginMultiply>();
+  ASSERT_EQ(multiply_plugins.size(), 1);
+  EXPECT_EQ(multiply_plugins.begin()->first, getSymbolName());
+  EXPECT_NEAR(multiply_plugins.begin()->second->multiply(5, 5), 25, 1e-8);
+
+  const auto add_plugins = plugin_loader.createAllInstances<TestPluginAdd>();
+  ASSERT_EQ(add_plugins.size(), 1);
+  EXPECT_NEAR(add_plugins.at(getSymbolName())->add(5, 5), 10, 1e-8);
+
+  // The libraries are loaded once, and each instance is reported
+  EXPECT_EQ(listener->count(PluginLoaderEventType::LIBRARY_LOAD_START), 2);
+  EXPECT_EQ(listener->count(PluginLoaderEventType::INSTANCE_CREATED), 2);
+  EXPECT_EQ(plugin_loader.getLiveInstanceCounts().size(), 2);
+  for (const auto& entry : plugin_loader.getLiveInstanceCounts())
+    EXPECT_EQ(entry.second, 1);
+
+  // Plugins shadowed by a library earlier in the search order are neither resolved nor created
+  const boost::filesystem::path directory =
+      boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("create_all_%%%%%%%%");
+  boost::filesystem::create_directories(directory);
+  boost::filesystem::copy_file(
+      boost::dll::shared_library::decorate(boost::filesystem::path(PLUGIN_DIR) / PLUGINS_MULTIPLY),
+      boost::dll::shared_library::decorate(directory / "shadow_multiply"));
+  plugin_loader.search_paths.push_back(directory.string());
+  plugin_loader.search_libraries.emplace_back("shadow_multiply");
+  const auto shadowed_plugins = plugin_loader.createAllInstances<TestPluginMultiply>();
+  ASSERT_EQ(shadowed_plugins.size(), 1);
+  EXPECT_EQ(listener->count(PluginLoaderEventType::SYMBOL_RESOLVED), 3);
+  EXPECT_EQ(listener->count(PluginLoaderEventType::INSTANCE_CREATED), 3);
+  EXPECT_EQ(listener->events().back().library_name, PLUGINS_MULTIPLY);
+
+  boost::filesystem::remove_all(directory);
+}
+
+TEST(BoostPluginLoaderUnit, ShortCircuitLoading)  // NOLINT
+{
+  using boost_plugin_loader::PluginLoader;
+  using boost_plugin_loader::PluginLoaderEventType;
+  using boost_plugin_loader::TestPluginAdd;
+  using boost_plugin_loader::TestPluginMultiply;
+
+  auto listener = std::make_shared<RecordingListener>();
+  PluginLoader plugin_loader;
+  plugin_loader.search_system_folders = false;
+  plugin_loader.search_paths.emplace_back(PLUGIN_DIR);
+  plugin_loader.search_libraries.emplace_back(PLUGINS_MULTIPLY);
+  plugin_loader.search_libraries.emplace_back(PLUGINS_ADD);
+  plugin_loader.listeners.push_back(listener);
+
+  // Libraries after the one which has the plugin are not loaded
+  EXPECT_NE(plugin_loader.createInstance<TestPluginMultiply>(getSymbolName()), nullptr);
+  EXPECT_EQ(listener->count(PluginLoaderEventType::LIBRARY_LOAD_START), 1);
+  EXPECT_TRUE(plugin_loader.isPluginAvailable(getSymbolName()));
+  EXPECT_EQ(listener->count(PluginLoaderEventType::LIBRARY_LOAD_START), 1);
+  EXPECT_NE(plugin_loader.createInstance<TestPluginAdd>(getSymbolName()), nullptr);
+  EXPECT_EQ(listener->count(PluginLoaderEventType::LIBRARY_LOAD_START), 2);
+
+  // Libraries named by absolute paths are searched first
+  PluginLoader absolute_loader;
+  absolute_loader.search_system_folders = false;
+  absolute_loader.search_paths.emplace_back(PLUGIN_DIR);
+  absolute_loader.search_libraries.emplace_back(PLUGINS_MULTIPLY);
+  absolute_loader.search_libraries.emplace_back(
+      boost::dll::shared_library::decorate(boost::filesystem::path(PLUGIN_DIR) / PLUGINS_ADD).string());
+  absolute_loader.listeners.push_back(listener);
+  EXPECT_NE(absolute_loader.createInstance<TestPluginAdd>(getSymbolName()), nullptr);
+  EXPECT_EQ(listener->count(PluginLoaderEventType::LIBRARY_LOAD_START), 3);
+  EXPECT_EQ(absolute_loader.getAvailableSections(), (std::vector<std::string>{ "add", "mult" }));
+  EXPECT_EQ(listener->count(PluginLoaderEventType::LIBRARY_LOAD_START), 4);
+}
+
+TEST(BoostPluginLoaderUnit, AdaptiveSearchOrder)  // NOLINT
+{
+  using boost_plugin_loader::LoadedLibrary;
+  using boost_plugin_loader::PluginLoader;
+  using boost_plugin_loader::TestPluginAdd;
+  using boost_plugin_loader::TestPluginMultiply;
+
+  // Expose the search order of the libraries
+  struct AdaptivePluginLoader : public PluginLoader
+  {
+    using PluginLoader::getAdaptiveSearchOrder;
+    using PluginLoader::loadLibraries;
+  };
+
+  // Stage a second library providing the multiply plugin
+  const boost::filesystem::path directory =
+      boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("adaptive_%%%%%%%%");
+  boost::filesystem::create_directories(directory);
+  boost::filesystem::copy_file(
+      boost::dll::shared_library::decorate(boost::filesystem::path(PLUGIN_DIR) / PLUGINS_MULTIPLY),
+      boost::dll::shared_library::decorate(directory / "adaptive_multiply"));
+
+  {
+    AdaptivePluginLoader plugin_loader;
+    plugin_loader.search_system_folders = false;
+    plugin_loader.search_paths = { PLUGIN_DIR, directory.string() };
+    plugin_loader.search_libraries = { PLUGINS_MULTIPLY, PLUGINS_ADD, "adaptive_multiply" };
+    plugin_loader.adaptive_search_order = true;
+
+    for (int i = 0; i < 10; ++i)
+      EXPECT_NEAR(plugin_loader.createInstance<TestPluginAdd>(getSymbolName())->add(5, 5), 10, 1e-8);
+
+    // The ambiguous multiply plugin still comes from the first library which provides it
+    for (int i = 0; i < 5; ++i)
+      EXPECT_NEAR(plugin_loader.createInstance<TestPluginMultiply>(getSymbolName())->multiply(5, 5), 25, 1e-8);
+
+    const std::vector<LoadedLibrary::Ptr> libraries =
+        plugin_loader.loadLibraries(plugin_loader.search_libraries, plugin_loader.search_paths);
+    ASSERT_EQ(libraries.size(), 3);
+    EXPECT_EQ(libraries[0]->hits, 5);
+    EXPECT_EQ(libraries[1]->hits, 10);
+    EXPECT_EQ(libraries[2]->hits, 0);
+
+    const auto search_order = plugin_loader.getAdaptiveSearchOrder(libraries);
+    EXPECT_TRUE(search_order->isAmbiguous(TestPluginMultiply::getSection(), getSymbolName()));
+    EXPECT_FALSE(search_order->isAmbiguous(TestPluginAdd::getSection(), getSymbolName()));
+    EXPECT_EQ(search_order->order.front(), 1);
+  }
+
+  boost::filesystem::remove_all(directory);
+}
+
+TEST(BoostPluginLoaderUnit, ThreadLocalCache)  // NOLINT
+{
+  using boost_plugin_loader::getLibraryCacheGeneration;
+  using boost_plugin_loader::PluginLoader;
+  using boost_plugin_loader::PluginLoaderException;
+  using boost_plugin_loader::TestPluginAdd;
+  using boost_plugin_loader::TestPluginMultiply;
+  using boost_plugin_loader::ThreadCacheEntry;
+  using boost_plugin_loader::ThreadCacheSet;
+
+  // Expose the per-thread cache entries
+  struct CachingPluginLoader : public PluginLoader
+  {
+    using PluginLoader::getThreadCacheSet;
+  };
+
+  CachingPluginLoader plugin_loader;
+  plugin_loader.search_system_folders = false;
+  plugin_loader.search_paths.emplace_back(PLUGIN_DIR);
+  plugin_loader.search_libraries = { PLUGINS_MULTIPLY, PLUGINS_ADD };
+  plugin_loader.thread_local_cache = true;
+
+  // The first lookup loads a library, so its resolution is only current from the second lookup on
+  for (int i = 0; i < 3; ++i)
+  {
+    EXPECT_NEAR(plugin_loader.createInstance<TestPluginMultiply>(getSymbolName())->multiply(5, 5), 25, 1e-8);
+    EXPECT_NEAR(plugin_loader.createInstance<TestPluginAdd>(getSymbolName())->add(5, 5), 10, 1e-8);
+  }
+
+  const ThreadCacheSet& set = plugin_loader.getThreadCacheSet(typeid(TestPluginAdd), getSymbolName());
+  const auto entry = std::find_if(set.begin(), set.end(), [&plugin_loader](const ThreadCacheEntry& entry) {
+    return entry.matches(&plugin_loader, typeid(TestPluginAdd), getSymbolName());
+  });
+  ASSERT_NE(entry, set.end());
+  EXPECT_EQ(entry->generation, getLibraryCacheGeneration());
+  EXPECT_FALSE(entry->library.expired());
+
+  // Hits see changes to the search configuration once the plugin loader searches its libraries again
+  const std::size_t configuration = entry->configuration;
+  plugin_loader.library_load_modes[PLUGINS_ADD] = boost::dll::load_mode::rtld_lazy;
+  EXPECT_EQ(plugin_loader.getAvailableSections().size(), 2);
+  EXPECT_NE(plugin_loader.createInstance<TestPluginAdd>(getSymbolName()), nullptr);
+  ASSERT_TRUE(set.front().matches(&plugin_loader, typeid(TestPluginAdd), getSymbolName()));
+  EXPECT_NE(set.front().configuration, configuration);
+
+  plugin_loader.search_libraries = { PLUGINS_ADD };
+  EXPECT_TRUE(plugin_loader.isPluginAvailable(getSymbolName()));
+  EXPECT_THROW(plugin_loader.createInstance<TestPluginMultiply>(getSymbolName()), PluginLoaderException);  // NOLINT
+  plugin_loader.library_load_modes.clear();
+  plugin_loader.clear();
+
+  // Another thread has its own cache
+  plugin_loader.search_libraries = { PLUGINS_MULTIPLY };
+  EXPECT_NE(plugin_loader.createInstance<TestPluginMultiply>(getSymbolName()), nullptr);
+  EXPECT_NE(plugin_loader.createInstance<TestPluginMultiply>(getSymbolName()), nullptr);
+  std::thread([&plugin_loader]() {
+    for (const ThreadCacheEntry& entry : plugin_loader.getThreadCacheSet(typeid(TestPluginMultiply), getSymbolName()))
+      EXPECT_EQ(entry.generation, 0);
+    EXPECT_NE(plugin_loader.createInstance<TestPluginMultiply>(getSymbolName()), nullptr);
+  }).join();
+
+  // Unloading libraries invalidates the cache
+  const std::uint64_t generation = getLibraryCacheGeneration();
+  EXPECT_EQ(plugin_loader.evictIdleLibraries().unloaded.size(), 1);
+  EXPECT_GT(getLibraryCacheGeneration(), generation);
+}
+
+TEST(BoostPluginLoaderUnit, ConcurrentUse)  // NOLINT
+{
+  using boost_plugin_loader::PluginLoader;
+  using boost_plugin_loader::TestPluginAdd;
+  using boost_plugin_loader::TestPluginMultiply;
+
+  PluginLoader plugin_loader;
+  plugin_loader.search_system_folders = false;
+  plugin_loader.search_paths.emplace_back(PLUGIN_DIR);
+  plugin_loader.search_libraries = { PLUGINS_MULTIPLY, PLUGINS_ADD };
+  EXPECT_EQ(plugin_loader.getLockWaitStatistics().contended_acquisitions, 0);
+
+  // Start with a cold cache, so that the first calls load the libraries while the others wait
+  std::vector<std::future<void>> futures;
+  for (int t = 0; t < 8; ++t)
+  {
+    futures.push_back(std::async(std::launch::async, [&plugin_loader, t]() {
+      for (int i = 0; i < 50; ++i)
+      {
+        switch ((t + i) % 4)
+        {
+          case 0:
+            EXPECT_EQ(plugin_loader.getAvailablePlugins<TestPluginAdd>(), std::vector<std::string>{ getSymbolName() });
+            break;
+          case 1:
+            EXPECT_TRUE(plugin_loader.isPluginAvailable(getSymbolName()));
+            break;
+          case 2:
+            EXPECT_NEAR(plugin_loader.createInstance<TestPluginAdd>(getSymbolName())->add(5, 5), 10, 1e-8);
+            break;
+          default:
+            EXPECT_NEAR(plugin_loader.createInstance<TestPluginMultiply>(getSymbolName())->multiply(5, 5), 25, 1e-8);
+            break;
+        }
+      }
+    }));
+  }
+
+  for (auto& future : futures)
+    future.get();
+
+  // Waits are only recorded for contended acquisitions
+  const boost_plugin_loader::LockWaitStatistics lock_wait = plugin_loader.getLockWaitStatistics();
+  EXPECT_TRUE(lock_wait.contended_acquisitions > 0 || lock_wait.wait_time.count() == 0);
+}
+
+TEST(BoostPluginLoaderUnit, LibraryFileIdentity)  // NOLINT
+{
+  using boost_plugin_loader::PluginLoader;
+  using boost_plugin_loader::PluginLoaderEventType;
+  using boost_plugin_loader::TestPluginMultiply;
+
+  // Reach the multiply library through a search path, a symbolic link and an absolute path which is not canonical
+  const boost::filesystem::path plugin_dir(PLUGIN_DIR);
+  const boost::filesystem::path directory =
+      boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("file_identity_%%%%%%%%");
+  boost::filesystem::create_directories(directory);
+  boost::system::error_code ec;
+  boost::filesystem::create_symlink(boost::dll::shared_library::decorate(plugin_dir / PLUGINS_MULTIPLY),
+                                    boost::dll::shared_library::decorate(directory / "linked_multiply"), ec);
+  if (ec)
+  {
+    boost::filesystem::remove_all(directory);
+    GTEST_SKIP() << "Symbolic links cannot be created: " << ec.message();
+  }
+
+  auto listener = std::make_shared<RecordingListener>();
+  PluginLoader plugin_loader;
+  plugin_loader.search_system_folders = false;
+  plugin_loader.search_paths = { PLUGIN_DIR, directory.string() };
+  plugin_loader.search_libraries = {
+    PLUGINS_MULTIPLY, "linked_multiply",
+    boost::dll::shared_library::decorate(plugin_dir / ".." / plugin_dir.filename() / PLUGINS_MULTIPLY).string()
+  };
+  plugin_loader.listeners.push_back(listener);
+
+  // The library is loaded, indexed and listed once (the link is first searched for in the plugin directory)
+  EXPECT_EQ(plugin_loader.getAvailableSections(), std::vector<std::string>{ "mult" });
+  EXPECT_EQ(plugin_loader.getAvailablePlugins<TestPluginMultiply>(), std::vector<std::string>{ getSymbolName() });
+  EXPECT_EQ(listener->count(PluginLoaderEventType::LIBRARY_LOAD_START), 2);
+  EXPECT_EQ(plugin_loader.getLiveInstanceCounts().size(), 1);
+
+  // The library is still found through the other paths after the path through which it was loaded is dropped
+  plugin_loader.search_libraries.erase(plugin_loader.search_libraries.begin());
+  EXPECT_NE(plugin_loader.createInstance<TestPluginMultiply>(getSymbolName()), nullptr);
+  EXPECT_EQ(listener->count(PluginLoaderEventType::LIBRARY_LOAD_START), 2);
+
+  boost::filesystem::remove_all(directory);
+}
+
+TEST(BoostPluginLoaderUnit, DirectoryListings)  // NOLINT
+{
+  using boost_plugin_loader::PluginLoader;
+  using boost_plugin_loader::PluginLoaderEventType;
+
+  const boost::filesystem::path directory =
+      boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("directory_listings_%%%%%%%%");
+  boost::filesystem::create_directories(directory / "a");
+  boost::filesystem::create_directories(directory / "b");
+
+  auto listener = std::make_shared<RecordingListener>();
+  PluginLoader plugin_loader;
+  plugin_loader.search_system_folders = false;
+  plugin_loader.search_paths = { (directory / "a").string(), (directory / "b").string(), PLUGIN_DIR };
+  plugin_loader.search_libraries = { PLUGINS_MULTIPLY, "late_add" };
+  plugin_loader.cache_directory_listings = true;
+  plugin_loader.listeners.push_back(listener);
+
+  // Libraries are only loaded from the search paths which have their files
+  EXPECT_EQ(plugin_loader.getAvailableSections(), std::vector<std::string>{ "mult" });
+  EXPECT_EQ(listener->count(PluginLoaderEventType::LIBRARY_LOAD_START), 1);
+
+  // Files added to a search path are found once its directory changed
+  boost::filesystem::copy_file(
+      boost::dll::shared_library::decorate(boost::filesystem::path(PLUGIN_DIR) / PLUGINS_ADD),
+      boost::dll::shared_library::decorate(directory / "b" / "late_add"));
+  EXPECT_EQ(plugin_loader.getAvailableSections().size(), 2);
+  EXPECT_EQ(listener->count(PluginLoaderEventType::LIBRARY_LOAD_START), 2);
+
+  boost::filesystem::remove_all(directory);
+}
+
+TEST(BoostPluginLoaderUnit, LibraryDiscovery)  // NOLINT
+{
+  using boost_plugin_loader::PluginLoader;
+  using boost_plugin_loader::TestPluginMultiply;
+
+  // A plugin pack with a library, a file which is not a library and a library in a subdirectory
+  const boost::filesystem::path plugin_dir(PLUGIN_DIR);
+  const boost::filesystem::path directory =
+      boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("discovery_%%%%%%%%");
+  boost::filesystem::create_directories(directory / "sub");
+  boost::filesystem::copy_file(boost::dll::shared_library::decorate(plugin_dir / PLUGINS_MULTIPLY),
+                               boost::dll::shared_library::decorate(directory / "multiply_plugins"));
+  boost::filesystem::copy_file(boost::dll::shared_library::decorate(plugin_dir / PLUGINS_ADD),
+                               boost::dll::shared_library::decorate(directory / "sub" / "add_plugins"));
+  std::ofstream(boost::dll::shared_library::decorate(directory / "fake_plugins").string()) << "not a library";
+
+  PluginLoader plugin_loader;
+  plugin_loader.search_system_folders = false;
+  plugin_loader.search_paths.push_back(directory.string());
+  plugin_loader.discovery_patterns.push_back(boost::dll::shared_library::decorate("*_plugins").string());
+
+  // Only libraries are discovered, and only in the search paths themselves by default
+  EXPECT_EQ(plugin_loader.getDiscoveredLibraries(),
+            std::vector<std::string>{ boost::dll::shared_library::decorate(directory / "multiply_plugins").string() });
+  EXPECT_EQ(plugin_loader.count(), 1);
+  EXPECT_EQ(plugin_loader.getAvailableSections(), std::vector<std::string>{ "mult" });
+  EXPECT_NE(plugin_loader.createInstance<TestPluginMultiply>(getSymbolName()), nullptr);
+
+  plugin_loader.discovery_depth = 1;
+  EXPECT_EQ(plugin_loader.getAvailableSections().size(), 2);
+
+  // Libraries added to a scanned directory are discovered
+  boost::filesystem::copy_file(boost::dll::shared_library::decorate(plugin_dir / PLUGINS_MULTIPLY),
+                               boost::dll::shared_library::decorate(directory / "sub" / "more_plugins"));
+  EXPECT_EQ(plugin_loader.getDiscoveredLibraries().size(), 3);
+
+  boost::filesystem::remove_all(directory);
+}
+
+TEST(BoostPluginLoaderUnit, LibraryManifest)  // NOLINT
+{
+  using boost_plugin_loader::LibraryManifest;
+  using boost_plugin_loader::LoadedLibrary;
+  using boost_plugin_loader::PluginLoader;
+  using boost_plugin_loader::PluginLoaderEventType;
+  using boost_plugin_loader::TestPluginMultiply;
+
+  const boost::filesystem::path directory =
+      boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("manifest_%%%%%%%%");
+  boost::filesystem::create_directories(directory);
+  const std::string manifest_file = (directory / "plugins.manifest").string();
+
+  auto create_plugin_loader = []() {
+    PluginLoader plugin_loader;
+    plugin_loader.search_system_folders = false;
+    plugin_loader.search_paths.emplace_back(PLUGIN_DIR);
+    plugin_loader.search_libraries = { PLUGINS_MULTIPLY, PLUGINS_ADD };
+    return plugin_loader;
+  };
+
+  // The first plugin loader builds and publishes the manifest
+  const PluginLoader builder = create_plugin_loader();
+  const LibraryManifest::ConstPtr manifest = builder.loadManifest(manifest_file);
+  ASSERT_NE(manifest, nullptr);
+  EXPECT_EQ(manifest->size(), 2);
+  EXPECT_TRUE(manifest->isCurrent());
+
+  // Other plugin loaders with the same configuration map it without loading the libraries
+  auto listener = std::make_shared<RecordingListener>();
+  PluginLoader plugin_loader = create_plugin_loader();
+  plugin_loader.listeners.push_back(listener);
+  EXPECT_EQ(plugin_loader.loadManifest(manifest_file)->size(), 2);
+  EXPECT_EQ(listener->count(PluginLoaderEventType::LIBRARY_LOAD_START), 0);
+
+  // The libraries are listed from the manifest in search order, and only creating an instance loads a library
+  const std::vector<LibraryManifest::Entry> entries = manifest->getEntries();
+  ASSERT_EQ(entries.size(), 2);
+  EXPECT_EQ(entries.at(0).name, PLUGINS_MULTIPLY);
+  EXPECT_EQ(entries.at(1).name, PLUGINS_ADD);
+  EXPECT_EQ(plugin_loader.getAvailableSections(), (std::vector<std::string>{ "mult", "add" }));
+  EXPECT_EQ(plugin_loader.getAvailablePlugins<TestPluginMultiply>(), std::vector<std::string>{ getSymbolName() });
+  EXPECT_TRUE(plugin_loader.isPluginAvailable(getSymbolName()));
+  EXPECT_FALSE(plugin_loader.isPluginAvailable("does_not_exist"));
+  plugin_loader.forEachPlugin(TestPluginMultiply::getSection(),
+                              [](std::string_view /*plugin*/, const LoadedLibrary::Ptr& lib) {
+                                EXPECT_EQ(lib->library, nullptr);
+                                EXPECT_EQ(lib->name, PLUGINS_MULTIPLY);
+                              });
+  EXPECT_EQ(listener->count(PluginLoaderEventType::LIBRARY_LOAD_START), 0);
+  EXPECT_NE(plugin_loader.createInstance<TestPluginMultiply>(getSymbolName()), nullptr);
+  EXPECT_EQ(listener->count(PluginLoaderEventType::LIBRARY_LOAD_START), 1);
+
+  // The libraries are loaded again once the configuration differs from the one the manifest was built for
+  const PluginLoader add_loader = [&]() {
+    PluginLoader loader = create_plugin_loader();
+    loader.listeners.push_back(listener);
+    loader.loadManifest(manifest_file);
+    loader.search_libraries = { PLUGINS_ADD };
+    return loader;
+  }();
+  EXPECT_EQ(add_loader.getAvailableSections(), std::vector<std::string>{ "add" });
+  EXPECT_EQ(listener->count(PluginLoaderEventType::LIBRARY_LOAD_START), 2);
+
+  // The manifest is checked again once the value of an environment variable of the configuration changes
+  {
+    auto env_listener = std::make_shared<RecordingListener>();
+    PluginLoader env_loader = create_plugin_loader();
+    env_loader.listeners.push_back(env_listener);
+    env_loader.search_libraries_env = "MANIFESTTESTENV";
+    env_loader.loadManifest(manifest_file);
+    EXPECT_EQ(env_loader.getAvailableSections(), (std::vector<std::string>{ "mult", "add" }));
+    EXPECT_EQ(env_listener->count(PluginLoaderEventType::LIBRARY_LOAD_START), 0);
+
+    static std::string env_var = std::string("MANIFESTTESTENV=") + PLUGINS_ADD;
+    putenv(env_var.data());  // NOLINT(misc-include-cleaner)
+    EXPECT_EQ(env_loader.getAvailableSections(), (std::vector<std::string>{ "add", "mult" }));
+    EXPECT_GT(env_listener->count(PluginLoaderEventType::LIBRARY_LOAD_START), 0);
+    static std::string cleared_env_var = "MANIFESTTESTENV=";
+    putenv(cleared_env_var.data());  // NOLINT(misc-include-cleaner)
+  }
+
+  // The index of a library is only read from the manifest while the library file is unchanged
+  const std::string multiply_file =
+      boost::filesystem::canonical(
+          boost::dll::shared_library::decorate(boost::filesystem::path(PLUGIN_DIR) / PLUGINS_MULTIPLY))
+          .string();
+  const std::uintmax_t size = boost::filesystem::file_size(multiply_file);
+  const std::int64_t modified = boost_plugin_loader::getModificationTime(multiply_file);
+  ASSERT_TRUE(manifest->findIndex(multiply_file, size, modified).has_value());
+  EXPECT_EQ(manifest->findIndex(multiply_file, size, modified)->sections, std::vector<std::string>{ "mult" });
+  EXPECT_FALSE(manifest->findIndex(multiply_file, size + 1, modified).has_value());
+
+  // Manifests built for another configuration, or which are truncated, are ignored
+  EXPECT_EQ(LibraryManifest::map(manifest_file, 0), nullptr);
+
+  LibraryManifest::Entry entry;
+  entry.file = "/plugins/libfake.so";
+  entry.size = 1;
+  entry.modified = 2;
+  entry.index.all_sections = { ".hidden", "fake" };
+  entry.index.sections = { "fake" };
+  entry.index.symbols["fake"] = { "plugin" };
+  entry.index.base_types["fake"]["plugin"] = 42;
+  const std::string other_file = (directory / "other.manifest").string();
+  LibraryManifest::publish(other_file, 42, { entry });
+  const LibraryManifest::ConstPtr other = LibraryManifest::map(other_file, 42);
+  ASSERT_NE(other, nullptr);
+  const std::optional<boost_plugin_loader::LibraryIndex> index = other->findIndex(entry.file, 1, 2);
+  ASSERT_TRUE(index.has_value());
+  EXPECT_EQ(index->all_sections, entry.index.all_sections);
+  EXPECT_EQ(index->symbols, entry.index.symbols);
+  EXPECT_EQ(index->findBaseType("fake", "plugin"), 42);
+  EXPECT_FALSE(other->isCurrent());
+
+  boost::filesystem::resize_file(other_file, boost::filesystem::file_size(other_file) - 1);
+  EXPECT_EQ(LibraryManifest::map(other_file, 42), nullptr);
+
+  boost::filesystem::remove_all(directory);
+}
+
+TEST(BoostPluginLoaderUnit, FrozenPluginTable)  // NOLINT
+{
+  using boost_plugin_loader::FrozenPluginTable;
+
+  // Plugins of three libraries, the last of which provides plugins of the first two again
+  std::vector<FrozenPluginTable::Entry> entries;
+  for (std::size_t library = 0; library < 3; ++library)
+  {
+    for (int i = 0; i < 500; ++i)
+    {
+      FrozenPluginTable::Entry entry;
+      entry.section = "section_" + std::to_string(i % 7);
+      entry.name = "plugin_" + std::to_string(library % 2) + "_" + std::to_string(i);
+      entry.library = library;
+      entries.push_back(entry);
+    }
+  }
+
+  const FrozenPluginTable table(entries);
+  EXPECT_EQ(table.entries().size(), entries.size());
+  for (const FrozenPluginTable::Entry& entry : entries)
+  {
+    const FrozenPluginTable::Entry* found = table.find(entry.section, entry.name);
+    ASSERT_NE(found, nullptr);
+    EXPECT_EQ(found->section, entry.section);
+    EXPECT_EQ(found->name, entry.name);
+    EXPECT_EQ(found->library, entry.library % 2);
+
+    const FrozenPluginTable::Entry* found_by_name = table.find({}, entry.name);
+    ASSERT_NE(found_by_name, nullptr);
+    EXPECT_EQ(found_by_name->name, entry.name);
+  }
+
+  EXPECT_EQ(table.find("section_1", "plugin_0_0"), nullptr);
+  EXPECT_EQ(table.find("section_0", "plugin_2_0"), nullptr);
+  EXPECT_EQ(table.find("section_7", "plugin_0_7"), nullptr);
+  EXPECT_EQ(table.find({}, "plugin"), nullptr);
+
+  // Sections list their plugins in search order, including those provided by several libraries
+  std::vector<std::size_t> libraries;
+  for (const FrozenPluginTable::Entry& entry : table.findSection("section_3"))
+    libraries.push_back(entry.library);
+  EXPECT_EQ(libraries.size(), 3 * 71);
+  EXPECT_TRUE(std::is_sorted(libraries.begin(), libraries.end()));
+  EXPECT_TRUE(table.findSection("section_7").empty());
+
+  EXPECT_EQ(FrozenPluginTable().find("section_0", "plugin_0_0"), nullptr);
+  EXPECT_TRUE(FrozenPluginTable().findSection("section_0").empty());
+}
+
+TEST(BoostPluginLoaderUnit, Freeze)  // NOLINT
+{
+  using boost_plugin_loader::PluginLoader;
+  using boost_plugin_loader::PluginLoaderErrorCode;
+  using boost_plugin_loader::PluginLoaderException;
+  using boost_plugin_loader::PluginLoadProfile;
+  using boost_plugin_loader::TestPluginAdd;
+  using boost_plugin_loader::TestPluginMultiply;
+
+  PluginLoader plugin_loader;
+  plugin_loader.search_system_folders = false;
+  plugin_loader.search_paths.emplace_back(PLUGIN_DIR);
+  plugin_loader.search_libraries = { PLUGINS_MULTIPLY, PLUGINS_ADD };
+  const std::vector<std::string> sections = plugin_loader.getAvailableSections(true);
+
+  EXPECT_FALSE(plugin_loader.isFrozen());
+  plugin_loader.freeze();
+  EXPECT_TRUE(plugin_loader.isFrozen());
+  plugin_loader.freeze();
+
+  // Queries give the same results as before
+  EXPECT_NEAR(plugin_loader.createInstance<TestPluginMultiply>(getSymbolName())->multiply(5, 5), 25, 1e-8);
+  EXPECT_NEAR(plugin_loader.createInstance<TestPluginAdd>(getSymbolName())->add(5, 5), 10, 1e-8);
+  EXPECT_TRUE(plugin_loader.isPluginAvailable(getSymbolName()));
+  EXPECT_FALSE(plugin_loader.isPluginAvailable("does_not_exist"));
+  EXPECT_EQ(plugin_loader.getAvailablePlugins<TestPluginMultiply>(), std::vector<std::string>{ getSymbolName() });
+  EXPECT_EQ(plugin_loader.getAvailableSections(true), sections);
+  EXPECT_EQ(plugin_loader.createAllInstances<TestPluginAdd>().size(), 1);
+  EXPECT_EQ(plugin_loader.count(), 2);
+
+  PluginLoaderErrorCode error{ PluginLoaderErrorCode::SUCCESS };
+  EXPECT_EQ(plugin_loader.tryCreateInstance<TestPluginMultiply>("does_not_exist", &error), nullptr);
+  EXPECT_EQ(error, PluginLoaderErrorCode::PLUGIN_NOT_FOUND);
+  try
+  {
+    plugin_loader.createInstance<TestPluginMultiply>("does_not_exist");
+    FAIL() << "The plugin should not be found";
+  }
+  catch (const boost_plugin_loader::PluginNotFoundException& e)
+  {
+    EXPECT_NE(std::string(e.what()).find(PLUGINS_MULTIPLY), std::string::npos);
+  }
+
+  // Instances share ownership of their library
+  const std::shared_ptr<TestPluginMultiply> plugin = plugin_loader.createInstance<TestPluginMultiply>(getSymbolName());
+  std::size_t live_instances{ 0 };
+  for (const auto& count : plugin_loader.getLiveInstanceCounts())
+    live_instances += count.second;
+  EXPECT_EQ(live_instances, 1);
+
+  // Changes to the configuration have no effect, and calls which change the cache throw
+  plugin_loader.search_libraries.clear();
+  EXPECT_NE(plugin_loader.createInstance<TestPluginAdd>(getSymbolName()), nullptr);
+  EXPECT_THROW(plugin_loader.clear(), PluginLoaderException);                           // NOLINT
+  EXPECT_THROW(plugin_loader.evictIdleLibraries(), PluginLoaderException);              // NOLINT
+  EXPECT_THROW(plugin_loader.preload(PluginLoadProfile()), PluginLoaderException);      // NOLINT
+  EXPECT_THROW(plugin_loader.loadManifest("plugins.manifest"), PluginLoaderException);  // NOLINT
+
+  // Copies are frozen as well
+  const PluginLoader copy = plugin_loader;  // NOLINT(performance-unnecessary-copy-initialization)
+  EXPECT_TRUE(copy.isFrozen());
+  EXPECT_NE(copy.createInstance<TestPluginAdd>(getSymbolName()), nullptr);
+
+  PluginLoader empty_plugin_loader;
+  EXPECT_THROW(empty_plugin_loader.freeze(), PluginLoaderException);  // NOLINT
+  EXPECT_FALSE(empty_plugin_loader.isFrozen());
+}
+
+/** @brief A plugin interface which uses the section of TestPluginMultiply, but is not its base class */
+class WrongTestPluginMultiply
+{
+public:
+  virtual ~WrongTestPluginMultiply() = default;
+  virtual double multiply(double x, double y) = 0;
+  static std::string getSection()
+  {
+    return STRINGIFY(SECTION_MULTIPLY);
+  }
+};
+
+/** @brief A plugin exported under two sections and names which only differ in where they are split */
+struct RecordNamePlugin
+{
+};
+
+EXPORT_CLASS_SECTIONED(RecordNamePlugin, name_record_plugin, rec)
+EXPORT_CLASS_SECTIONED(RecordNamePlugin, record_plugin, rec_name)
+
+TEST(BoostPluginLoaderUnit, PluginRecords)  // NOLINT
+{
+  using boost_plugin_loader::getTypeHash;
+  using boost_plugin_loader::getTypeName;
+  using boost_plugin_loader::LibraryIndex;
+  using boost_plugin_loader::PluginLoader;
+  using boost_plugin_loader::PluginLoaderException;
+  using boost_plugin_loader::PluginRecord;
+  using boost_plugin_loader::TestPluginAdd;
+  using boost_plugin_loader::TestPluginMultiply;
+
+  EXPECT_NE(getTypeName<TestPluginMultiply>().find("boost_plugin_loader::TestPluginMultiply"), std::string_view::npos);
+  EXPECT_NE(getTypeHash<TestPluginMultiply>(), getTypeHash<TestPluginAdd>());
+  EXPECT_NE(getTypeHash<TestPluginMultiply>(), getTypeHash<WrongTestPluginMultiply>());
+
+  // The records of plugins whose section and name join to the same string have different names
+  EXPECT_EQ(std::string(BOOST_PLUGIN_LOADER_RECORD_NAME(name_record_plugin, rec).section), "rec");
+  EXPECT_EQ(std::string(BOOST_PLUGIN_LOADER_RECORD_NAME(record_plugin, rec_name).section), "rec_name");
+
+  // The names of the records are not reserved identifiers
+  EXPECT_EQ(std::string(BOOST_PP_STRINGIZE(BOOST_PLUGIN_LOADER_RECORD_NAME(record_plugin, rec_name))).find("__"),
+            std::string::npos);
+
+#ifdef __linux__
+  // The export macros emit a record for each plugin, which is read without loading the library
+  const std::string multiply_file =
+      boost::dll::shared_library::decorate(boost::filesystem::path(PLUGIN_DIR) / PLUGINS_MULTIPLY).string();
+  const std::optional<std::vector<PluginRecord>> records = boost_plugin_loader::readPluginRecords(multiply_file);
+  ASSERT_TRUE(records.has_value());
+  ASSERT_EQ(records->size(), 1);
+  EXPECT_EQ(records->front().abi_version, boost_plugin_loader::PLUGIN_RECORD_ABI_VERSION);
+  EXPECT_EQ(records->front().base_type, getTypeHash<TestPluginMultiply>());
+  EXPECT_EQ(std::string(records->front().section), TestPluginMultiply::getSection());
+  EXPECT_EQ(std::string(records->front().alias), getSymbolName());
+  EXPECT_FALSE(boost_plugin_loader::readPluginRecords(multiply_file + ".does_not_exist").has_value());
+  EXPECT_FALSE(boost_plugin_loader::readPluginRecords(__FILE__).has_value());
+
+  // The index built from the records is the same as the one built from the symbol table
+  const std::optional<LibraryIndex> index = boost_plugin_loader::indexPluginRecords(multiply_file);
+  ASSERT_TRUE(index.has_value());
+  const std::optional<boost::dll::shared_library> lib = boost_plugin_loader::loadLibrary(multiply_file);
+  ASSERT_TRUE(lib.has_value());
+  const LibraryIndex symbol_index = boost_plugin_loader::indexLibrary(lib.value());
+  EXPECT_NE(std::find(index->all_sections.begin(), index->all_sections.end(), "__bplrec"), index->all_sections.end());
+  EXPECT_EQ(index->sections, symbol_index.sections);
+  EXPECT_EQ(index->symbols, symbol_index.symbols);
+  EXPECT_EQ(index->findBaseType(TestPluginMultiply::getSection(), getSymbolName()), getTypeHash<TestPluginMultiply>());
+
+  // Plugins exported without the export macros under a section with plugin records are indexed from the symbol table
+  const std::string mixed_file =
+      boost::dll::shared_library::decorate(boost::filesystem::path(PLUGIN_DIR) / PLUGINS_MIXED).string();
+  ASSERT_TRUE(boost_plugin_loader::readPluginRecords(mixed_file).has_value());
+  EXPECT_EQ(boost_plugin_loader::readPluginRecords(mixed_file)->size(), 1);
+  EXPECT_FALSE(boost_plugin_loader::indexPluginRecords(mixed_file).has_value());
+
+  PluginLoader mixed_plugin_loader;
+  mixed_plugin_loader.search_system_folders = false;
+  mixed_plugin_loader.search_paths.emplace_back(PLUGIN_DIR);
+  mixed_plugin_loader.search_libraries = { PLUGINS_MIXED };
+  const std::vector<std::string> mixed_plugins = mixed_plugin_loader.getAvailablePlugins<TestPluginMultiply>();
+  EXPECT_EQ(std::set<std::string>(mixed_plugins.begin(), mixed_plugins.end()),
+            (std::set<std::string>{ getSymbolName(), "raw_plugin" }));
+  EXPECT_NEAR(mixed_plugin_loader.createInstance<TestPluginMultiply>("raw_plugin")->multiply(5, 5), 25, 1e-8);
+
+  // Plugins are not created as a base class they were not exported for
+  PluginLoader plugin_loader;
+  plugin_loader.search_system_folders = false;
+  plugin_loader.search_paths.emplace_back(PLUGIN_DIR);
+  plugin_loader.search_libraries = { PLUGINS_MULTIPLY, PLUGINS_ADD };
+  auto create_wrong = [&plugin_loader]() {
+    return plugin_loader.createInstance<WrongTestPluginMultiply>(getSymbolName());
+  };
+  EXPECT_NE(plugin_loader.createInstance<TestPluginMultiply>(getSymbolName()), nullptr);
+  EXPECT_THROW(create_wrong(), PluginLoaderException);                                              // NOLINT
+  EXPECT_THROW(plugin_loader.createAllInstances<WrongTestPluginMultiply>(), PluginLoaderException);  // NOLINT
+
+  // The base class is checked against the plugin records of a library file before the library is loaded
+  using boost_plugin_loader::findRecordedBaseType;
+  EXPECT_EQ(findRecordedBaseType(multiply_file, TestPluginMultiply::getSection(), getSymbolName()),
+            getTypeHash<TestPluginMultiply>());
+  EXPECT_FALSE(findRecordedBaseType(multiply_file, TestPluginMultiply::getSection(), "missing").has_value());
+
+  auto listener = std::make_shared<RecordingListener>();
+  PluginLoader unloaded_plugin_loader;
+  unloaded_plugin_loader.search_system_folders = false;
+  unloaded_plugin_loader.search_paths.emplace_back(PLUGIN_DIR);
+  unloaded_plugin_loader.search_libraries = { PLUGINS_MULTIPLY };
+  unloaded_plugin_loader.listeners.push_back(listener);
+  EXPECT_THROW(unloaded_plugin_loader.createInstance<WrongTestPluginMultiply>(getSymbolName()),  // NOLINT
+               PluginLoaderException);
+  EXPECT_EQ(listener->count(boost_plugin_loader::PluginLoaderEventType::LIBRARY_LOAD_START), 0);
+  EXPECT_NE(unloaded_plugin_loader.createInstance<TestPluginMultiply>(getSymbolName()), nullptr);
+  EXPECT_EQ(listener->count(boost_plugin_loader::PluginLoaderEventType::LIBRARY_LOAD_START), 1);
+
+  plugin_loader.freeze();
+  EXPECT_NE(plugin_loader.createInstance<TestPluginMultiply>(getSymbolName()), nullptr);
+  EXPECT_THROW(create_wrong(), PluginLoaderException);  // NOLINT
+#endif
+}
+
 int main(int argc, char** argv)
 {
   testing::InitGoogleTest(&argc, argv);
@@ -73,7 +73,9 @@ static inline std::string getSymbolName()
 
 // Create macros to export both plugins with a given alias and with section names defined as target compile definitions
 #include <boost_plugin_loader/macros.h>
-#define EXPORT_TEST_PLUGIN_MULTIPLY(DERIVED_CLASS, ALIAS) EXPORT_CLASS_SECTIONED(DERIVED_CLASS, ALIAS, SECTION_MULTIPLY)
-#define EXPORT_TEST_PLUGIN_ADD(DERIVED_CLASS, ALIAS) EXPORT_CLASS_SECTIONED(DERIVED_CLASS, ALIAS, SECTION_ADD)
+#define EXPORT_TEST_PLUGIN_MULTIPLY(DERIVED_CLASS, ALIAS)                                                              \
+  EXPORT_CLASS_SECTIONED_WITH_BASE(DERIVED_CLASS, boost_plugin_loader::TestPluginMultiply, ALIAS, SECTION_MULTIPLY)
+#define EXPORT_TEST_PLUGIN_ADD(DERIVED_CLASS, ALIAS)                                                                   \
+  EXPORT_CLASS_SECTIONED_WITH_BASE(DERIVED_CLASS, boost_plugin_loader::TestPluginAdd, ALIAS, SECTION_ADD)
 
 #endif  // BOOST_PLUGIN_LOADER_TEST_PLUGIN_H
@@ -0,0 +1,48 @@
+/**
+ *
+ * @copyright Copyright (c) 2021, Southwest Research Institute
+ *
+ * @par License
+ * Software License Agreement (Apache License)
+ * @par
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * @par
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "test_plugin.h"
+
+// Boost
+#include <boost/dll/alias.hpp>
+
+// Boost Plugin Loader
+#include <boost_plugin_loader/macros.h>
+
+namespace boost_plugin_loader
+{
+class TestPluginMixedImpl : public TestPluginMultiply
+{
+public:
+  double multiply(double x, double y) override { return x * y; }
+};
+
+}  // namespace boost_plugin_loader
+
+// Export one plugin with the export macros, which emit its plugin record
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+EXPORT_TEST_PLUGIN_MULTIPLY(boost_plugin_loader::TestPluginMixedImpl, SYMBOL_NAME)
+
+// Export another plugin under the same section with Boost.DLL directly, which emits no plugin record. The macro expands
+// the section name before Boost.DLL uses it.
+#define EXPORT_WITHOUT_RECORD(DERIVED_CLASS, ALIAS, SECTION)                                                           \
+  extern "C" BOOST_SYMBOL_EXPORT DERIVED_CLASS ALIAS;                                                                  \
+  BOOST_DLL_SECTION(SECTION, read) BOOST_DLL_SELECTANY DERIVED_CLASS ALIAS;
+
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+EXPORT_WITHOUT_RECORD(boost_plugin_loader::TestPluginMixedImpl, raw_plugin, SECTION_MULTIPLY)